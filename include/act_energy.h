@@ -0,0 +1,53 @@
+/* act_energy.h - actuator on-time and energy accounting
+ *
+ * Actuator run time dominates the energy budget. Every start is counted
+ * per actuator and per dive state, together with direction reversals, and
+ * every run is charged to the state it ran in. A run that spans a state
+ * change is split at the transition. Energy is estimated from a per-actuator
+ * current table in app_params.
+ *
+ * The tables have no Zephyr dependencies (act_energy.c) and are shared
+ * with tools/replay; actuator_acct.c feeds them from the drivers.
+ */
+#ifndef ACT_ENERGY_H
+#define ACT_ENERGY_H
+
+#include <stdint.h>
+
+#include "app_params.h"
+#include "dive_ctrl.h"
+#include "dive_stats.h"
+
+struct act_usage {
+    uint32_t on_ms;
+    uint32_t starts;
+    uint32_t reversals;           /* starts opposite to the previous one */
+};
+
+struct act_energy {
+    struct act_usage use[DIVE_ST__COUNT][DIVE_ACT__COUNT];
+    int8_t last_dir[DIVE_ACT__COUNT];  /* survives act_energy_reset() */
+};
+
+/* Clear the counters for a new cycle */
+void act_energy_reset(struct act_energy *e);
+/* Count a start in direction dir while in state st */
+void act_energy_start(struct act_energy *e, enum dive_state st,
+                      enum dive_actuator act, int dir);
+/* Charge run time to a state */
+void act_energy_charge(struct act_energy *e, enum dive_state st,
+                       enum dive_actuator act, uint32_t ms);
+
+/* Sum over all states */
+void act_energy_total(const struct act_energy *e, enum dive_actuator act,
+                      struct act_usage *out);
+/* Estimated energy in mWh; act = DIVE_ACT__COUNT for all actuators,
+ * st = DIVE_ST__COUNT for all states */
+float act_energy_mwh(const struct act_energy *e, enum dive_state st,
+                     enum dive_actuator act, const struct app_params *p);
+
+/* Fill the actuator fields of a cycle summary */
+void act_energy_summarize(const struct act_energy *e, const struct app_params *p,
+                          struct dive_summary *out);
+
+#endif /* ACT_ENERGY_H */
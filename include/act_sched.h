@@ -0,0 +1,62 @@
+/* act_sched.h - coordinated actuator moves under a current budget
+ *
+ * Callers submit timed moves instead of driving the motors and pump
+ * directly. A move starts at once if the actuators already running plus
+ * this one stay within current_budget_ma (or nothing else is running);
+ * otherwise it waits, highest priority first, until enough of them stop.
+ * A new move for an actuator replaces its waiting or running one, which
+ * completes with -ECANCELED.
+ *
+ * Completion is reported through an optional callback and an optional
+ * k_poll signal, both with the result and the total move time from
+ * submission to stop. Both run after the scheduler lock is released, in
+ * the thread that finished the move (the system work queue, or the caller
+ * of act_sched_submit()/act_sched_cancel()), so a callback may submit.
+ */
+#ifndef ACT_SCHED_H
+#define ACT_SCHED_H
+
+#include <zephyr/kernel.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dive_ctrl.h"
+
+enum act_prio {
+    ACT_PRIO_LOW,                  /* heading corrections */
+    ACT_PRIO_NORMAL,               /* buoyancy */
+    ACT_PRIO_HIGH,                 /* attitude, emergency ascent */
+};
+
+/* result: 0 done, -ECANCELED replaced or cancelled, -EIO refused by the
+ * driver or cut short by a limit switch */
+typedef void (*act_move_cb)(enum dive_actuator act, int result, uint32_t total_ms, void *user);
+
+struct act_move {
+    enum dive_actuator act;
+    int dir;                       /* +1 / -1 */
+    uint32_t duration_ms;          /* full-speed ms, > 0 */
+    enum act_prio prio;
+    act_move_cb cb;                /* optional */
+    void *user;
+    struct k_poll_signal *signal;  /* optional; raised with the result */
+};
+
+#define ACT_MASK(act) BIT(act)
+#define ACT_MASK_ALL  (BIT(DIVE_ACT__COUNT) - 1)
+
+int act_sched_init(void);
+
+/* 0, or -EINVAL for a bad request */
+int act_sched_submit(const struct act_move *mv);
+
+/* Stop the scheduled moves of the actuators in mask */
+void act_sched_cancel(uint32_t act_mask);
+
+/* No scheduled move waiting or running on any actuator in mask */
+bool act_sched_idle(uint32_t act_mask);
+
+/* Moves, run and waiting time per actuator since boot */
+void act_sched_print_stats(void);
+
+#endif /* ACT_SCHED_H */
@@ -0,0 +1,24 @@
+#ifndef ACTUATOR_ACCT_H
+#define ACTUATOR_ACCT_H
+
+#include <stdbool.h>
+
+#include "act_energy.h"
+
+/* Driver hooks: call when an H-bridge is energised and when it is cut.
+ * A second _on() while running closes the previous run first. Safe from
+ * work queue and thread context. */
+void actuator_acct_on(enum dive_actuator act, int dir);
+void actuator_acct_off(enum dive_actuator act);
+
+/* Deploy hooks: runs in progress are split at every state change */
+void actuator_acct_set_state(enum dive_state st);
+void actuator_acct_begin_cycle(void);
+
+/* Copy of the current cycle, with runs in progress charged up to now */
+void actuator_acct_snapshot(struct act_energy *out);
+
+/* Per-actuator totals and per-state energy of the current cycle */
+void actuator_acct_print(const struct app_params *p);
+
+#endif /* ACTUATOR_ACCT_H */
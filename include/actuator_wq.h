@@ -0,0 +1,41 @@
+/* actuator_wq.h - dedicated work queue for actuator stops
+ *
+ * Motor and pump stop timers run on their own cooperative, high-priority
+ * work queue instead of the system work queue, so a stop is never queued
+ * behind unrelated work. The stop handlers only drive the GPIOs low and
+ * settle the position; their log line is queued and printed later from
+ * the system work queue, where app_printk() may block on the net console.
+ *
+ * Each timed stop also records the requested against the actual on-time
+ * (uptime ticks at start and stop), so stop lateness is measured on
+ * the target itself: HARDWARE TEST 8.
+ */
+#ifndef ACTUATOR_WQ_H
+#define ACTUATOR_WQ_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+#include "dive_ctrl.h"
+
+/* Start the queue; call before the actuator drivers are initialised */
+int actuator_wq_init(void);
+
+struct k_work_q *actuator_wq(void);
+
+/* From a stop handler: account the run and queue its log line.
+ * requested_ms is 0 for runs stopped by command rather than by timer. */
+void actuator_wq_stopped(enum dive_actuator act, uint32_t requested_ms, uint32_t actual_us);
+
+/* From the drivers after a commanded (untimed) stop; no log, no timing */
+void actuator_wq_notify_stop(enum dive_actuator act);
+
+/* Called after every stop, from any context including ISRs (act_sched) */
+typedef void (*actuator_stop_hook_t)(enum dive_actuator act);
+void actuator_wq_set_stop_hook(actuator_stop_hook_t hook);
+
+/* Requested vs actual on-time of timed stops, per actuator */
+void actuator_wq_print_timing(void);
+void actuator_wq_reset_timing(void);
+
+#endif /* ACTUATOR_WQ_H */
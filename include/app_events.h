@@ -19,6 +19,7 @@ typedef enum {
     ST_SIMULATE,
     ST_COMPASS_MENU,
     ST_OTA_MENU,
+    ST_MISSION_MENU,
     ST__COUNT
 } state_id_t;
 
@@ -0,0 +1,49 @@
+/* app_logd.h - deferred logging of the hot-path messages
+ *
+ * APP_LOGD(SENS, ...) stands for app_logk(level, LOGD_FMT_SENS, ...) with
+ * the format and level from the logd.h table. With log_deferred set the
+ * call only packs its arguments into a record and copies it into a ring;
+ * a low-priority thread formats it for the sinks. log_deferred=2 sends
+ * UART0 the raw record instead, for tools/logd_decode on the host, so the
+ * glider never formats those lines for the OpenLog at all. Other console
+ * output queues through the same ring meanwhile, so order is kept.
+ */
+#ifndef APP_LOGD_H
+#define APP_LOGD_H
+
+#include <stdint.h>
+#include <zephyr/sys/util_macro.h>
+
+#include "app_print.h"
+#include "logd.h"
+
+enum app_logd_mode {
+    APP_LOGD_SKIP = 0,             /* no sink prints this level */
+    APP_LOGD_NOW,                  /* log_deferred=0: format in the caller */
+    APP_LOGD_DEFER,
+};
+
+enum app_logd_mode app_logd_mode(enum logd_id id);
+/* Queue a packed record; never waits, drops it when the ring is full */
+void app_logd_submit(const uint8_t *rec, const struct logd_pack *pk);
+/* Queue formatted text behind the records (app_print_write()); waits up
+ * to a second for room outside an ISR. Returns false with log_deferred=0,
+ * when the caller writes the sinks itself. */
+bool app_logd_text(enum app_log_level lvl, unsigned int mask, const char *buf, size_t len);
+void app_logd_print_stats(void);
+
+#define APP_LOGD(name, ...) do {                                                \
+    enum app_logd_mode _m = app_logd_mode(LOGD_##name);                         \
+    if (_m == APP_LOGD_NOW) {                                                   \
+        app_logk((enum app_log_level)logd_dict[LOGD_##name].level,              \
+                 LOGD_FMT_##name, __VA_ARGS__);                                 \
+    } else if (_m == APP_LOGD_DEFER) {                                          \
+        uint8_t _rec[LOGD_REC_MAX];                                             \
+        struct logd_pack _pk;                                                   \
+        logd_pack_begin(&_pk, _rec, sizeof(_rec), LOGD_##name);                 \
+        FOR_EACH_FIXED_ARG(LOGD_ARG, (;), &_pk, __VA_ARGS__);                   \
+        app_logd_submit(_rec, &_pk);                                            \
+    }                                                                           \
+} while (0)
+
+#endif /* APP_LOGD_H */
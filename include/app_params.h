@@ -1,6 +1,7 @@
 #ifndef APP_PARAMS_H
 #define APP_PARAMS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /* Application parameters stored in non-volatile memory. */
@@ -22,12 +23,103 @@ struct app_params {
     uint16_t roll_time_s;          /* seconds */
 
     int16_t  desired_heading_deg;  /* degrees 0-359 */
+
+    /* Heading PI controller (roll target relative to start_roll_s) */
+    float    heading_kp;           /* roll seconds per degree of heading error */
+    float    heading_ki;           /* roll seconds per degree-second of error */
+    uint16_t heading_period_s;     /* seconds between heading updates */
+    uint16_t roll_deadband_ms;     /* skip roll corrections shorter than this */
+
+    /* Predictive inflection: initial lead before any cycle has been
+     * measured; 0 disables prediction (climb at dive_depth_m) */
+    uint16_t inflect_lead_ms;
+
+    /* Yo-yo: dives per surfacing, turning back down at yoyo_min_depth_m
+     * instead of surfacing between them; 1 = surface after every dive */
+    uint16_t yoyo_dives;
+    float    yoyo_min_depth_m;     /* meters */
+
+    /* Deploy state time limits (dive_timeout_min covers DESCEND) */
+    uint16_t trim_timeout_s;       /* SURFACE_TRIM / INFLECT: wait for trim moves */
+    uint16_t climb_timeout_min;    /* ASCEND */
+    uint16_t surface_dwell_s;      /* SURFACE: settle before GPS */
+    uint16_t gps_timeout_s;        /* GPS */
+    uint16_t comms_window_s;       /* COMMS: ENTER window on prompting steps */
+
+    /* Actuator current draw for the energy estimate */
+    uint16_t roll_current_ma;
+    uint16_t pitch_current_ma;
+    uint16_t pump_current_ma;
+    uint16_t supply_mv;            /* battery voltage under load */
+
+    /* Emergency ascent on abort */
+    uint16_t abort_pump_s;         /* pump set-point */
+    uint16_t abort_pitch_s;        /* pitch set-point */
+    uint16_t abort_depth_fails;    /* consecutive depth read failures that abort, 0 = never */
+
+    /* Trim learning targets, 0 = do not learn that set-point */
+    uint16_t target_descent_mm_s;  /* dive_pump_s */
+    uint16_t target_ascent_mm_s;   /* climb_pump_s */
+    uint16_t target_dive_pitch_deg;    /* dive_pitch_s, |pitch| */
+    uint16_t target_climb_pitch_deg;   /* climb_pitch_s, |pitch| */
+    float    trim_learn_max_s;     /* largest learned offset from a set-point */
+
+    /* PWM drive (ignored with plain GPIO H-bridge inputs) */
+    uint16_t roll_duty_pct;        /* speed limits */
+    uint16_t pitch_duty_pct;
+    uint16_t pump_duty_pct;
+    uint16_t drive_min_duty_pct;   /* soft-start / soft-stop duty */
+    uint16_t drive_ramp_ms;        /* min -> max duty, 0 = no ramps */
+
+    /* Pitch homing on the limit switches (pitch_home.c) */
+    float    pitch_aft_stop_s;     /* pitch position given to the DOWN (AFT) stop */
+    float    pitch_travel_s;       /* measured DOWN -> UP travel, 0 = never homed */
+    uint16_t pitch_home_timeout_s; /* per leg */
+    uint16_t pitch_home_on_deploy; /* 1 = home before the first dive */
+
+    /* Actuator scheduler (act_sched.c): most current drawn by actuators
+     * running at once, using the *_current_ma figures; 0 = no limit */
+    uint16_t current_budget_ma;
+
+    /* Pump displacement model (pump_model.c): flow = ml_s - loss * bar of
+     * gauge pressure, per direction; 0 flows keep plain pump-seconds */
+    float    pump_out_ml_s;        /* OUT (+1, heavier) at the surface */
+    float    pump_out_loss_ml_s_bar;
+    float    pump_in_ml_s;         /* IN (-1, lighter) at the surface */
+    float    pump_in_loss_ml_s_bar;
+
+    /* Depth-binned profile printed at surfacing (dive_profile.c) */
+    float    profile_bin_m;        /* bin size, 0 = no profile */
+
+    /* Console output (app_print.c): most verbose level per sink,
+     * 1 = errors, 2 = warnings, 3 = info, 4 = per-sample; 0 = everything */
+    uint16_t log_uart0_level;      /* console / OpenLog */
+    uint16_t log_uart1_level;
+    uint16_t log_net_level;        /* telnet console */
+    /* Hot-path messages (logd.h): 0 = format in the caller, 1 = format
+     * on a background thread, 2 = also raw records on UART0 */
+    uint16_t log_deferred;
 };
 
 int app_params_init(void);
 int app_params_save(void);
 void app_params_reset_defaults(void);
 
+/* Fill p with the compiled-in defaults (no NVS access; usable on host). */
+void app_params_defaults(struct app_params *p);
+
+/* Set a parameter by field name from text, e.g. ("dive_depth_m", "12.5");
+ * returns 0, -ENOENT for an unknown name or -EINVAL for a bad value.
+ * (app_params_table.c; usable on host) */
+int app_params_set_named(struct app_params *p, const char *name, size_t name_len,
+                         const char *value);
+/* "name=value" for the i-th parameter; returns -1 past the end */
+int app_params_format_named(const struct app_params *p, unsigned int i, char *buf, size_t len);
+/* Bytes of struct app_params up to the end of its last field (trailing
+ * padding excluded); recorded with the NVS blob. Every field must be in
+ * the name table for this to hold. */
+size_t app_params_data_len(void);
+
 /* Access current parameters; pointer is valid for the lifetime of the app. */
 struct app_params *app_params_get(void);
 
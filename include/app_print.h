@@ -1,21 +1,52 @@
 #pragma once
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Initialize the mirror output (called automatically) */
+/* Message levels; each sink prints up to its log_*_level parameter
+ * (0 = everything) */
+enum app_log_level {
+    APP_LVL_ERR = 1,
+    APP_LVL_WRN,
+    APP_LVL_INF,               /* app_printk() */
+    APP_LVL_DBG,               /* per-sample lines */
+};
+
+/* Sinks, as masks for app_print_write() */
+#define APP_SINK_UART0  0x1u       /* console / OpenLog */
+#define APP_SINK_UART1  0x2u
+#define APP_SINK_NET    0x4u       /* telnet console */
+#define APP_SINK_ALL    0x7u
+
+/* Initialize the sinks (called automatically) */
 int app_print_init(void);
 
-/* App-level printing that goes to console (printk) and mirrors to UART1 */
+/* App-level printing: formatted once, then queued to the console (UART0),
+ * UART1 and the net console */
 void app_vprintk(const char *fmt, va_list ap);
 void app_printk(const char *fmt, ...);
+void app_vlogk(enum app_log_level lvl, const char *fmt, va_list ap);
+void app_logk(enum app_log_level lvl, const char *fmt, ...);
+
+/* Already formatted output: queue buf to the sinks in mask that print lvl.
+ * app_print_wants() tells whether any of them would. With log_deferred
+ * set, app_print_write() queues behind the deferred records (app_logd.h);
+ * app_print_sinks() writes the sink rings directly, for the logd thread. */
+bool app_print_wants(enum app_log_level lvl, unsigned int mask);
+void app_print_write(enum app_log_level lvl, unsigned int mask, const char *buf, size_t len);
+void app_print_sinks(enum app_log_level lvl, unsigned int mask, const char *buf, size_t len);
 
 /* Optional helpers */
 int app_puts(const char *s);
 int app_putchar(int c);
 
+/* Per-sink line, drop and ring figures */
+void app_print_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,72 @@
+/* checkpoint.h - brownout-safe deployment checkpoint
+ *
+ * The deploy worker records where it is at every state change: state,
+ * mission cursor, cycle, actuator positions, surface reference pressure,
+ * learned inflection lead and the last GPS fix. One 52-byte record is kept
+ * in retained RAM (survives resets that keep power) and mirrored to NVS
+ * (survives power loss); on boot the newest valid copy wins. If it says a
+ * deployment was running, the actuator positions are restored and main
+ * goes straight back to DEPLOYED instead of waiting out
+ * STARTUP_TIMEOUT_SEC.
+ *
+ * A move still scheduled when the record is written is stored at its
+ * commanded target, so resuming trims only toward the state's set-points
+ * and does not repeat it. If power fails before that move finishes, the
+ * error is the part of it that did not run.
+ */
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dive_ctrl.h"
+
+#define CHECKPOINT_VERSION  1
+
+#define CKPT_F_ACTIVE   0x01    /* a deployment is running */
+#define CKPT_F_ABORTED  0x02    /* it was in an emergency ascent */
+#define CKPT_F_FIX      0x04    /* lat/lon are valid */
+
+struct checkpoint {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint8_t state;              /* enum dive_state */
+    uint8_t step;               /* mission cursor */
+    uint8_t yo;
+    uint8_t reserved[3];
+    uint32_t cycle;
+    int32_t pos_ms[DIVE_ACT__COUNT];
+    float surface_pa;
+    float inflect_lead_s;
+    int32_t lat_e7;
+    int32_t lon_e7;
+    uint32_t seq;               /* write counter, newest copy wins */
+    uint32_t crc;               /* CRC-32 of everything above */
+};
+
+/* Load both copies and restore actuator positions from an active one.
+ * Call after the settings subsystem and the actuator drivers are up. */
+int checkpoint_init(void);
+
+/* An interrupted deployment is waiting to be resumed */
+bool checkpoint_pending(void);
+
+/* Hand the pending checkpoint to the deploy worker (once) */
+bool checkpoint_take(struct checkpoint *out);
+
+/* Record ck (magic, version, seq and crc are filled in). RAM always; NVS
+ * only when something other than the counter changed. A fix missing from
+ * ck is carried over from the previous record. */
+void checkpoint_save(struct checkpoint *ck);
+
+/* Deployment ended: forget it in both copies */
+void checkpoint_clear(void);
+
+/* State to re-enter: its set-point moves are issued again from the stored
+ * targets, so INFLECT/ASCEND resume in INFLECT and the surface states in
+ * SURFACE */
+enum dive_state checkpoint_resume_state(const struct checkpoint *ck);
+
+#endif /* CHECKPOINT_H */
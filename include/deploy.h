@@ -17,4 +17,12 @@ bool deploy_check_sensor_available(void);
 bool deploy_is_running(void);
 /* Check if simulate is currently running */
 bool simulate_is_running(void);
+/* Abort a running deploy/simulate: emergency ascent within one control
+ * tick, then GPS fix and stop. A second abort stops the worker at once.
+ * Safe from any thread. */
+void deploy_abort(const char *reason);
+/* Queue "name=value" or "mission set <n> <step>" for the running
+ * deployment; applied at the next surfacing. Returns 0, -EINVAL if too
+ * long or -ENOSPC if the queue is full. */
+int deploy_queue_update(const char *line);
 #endif
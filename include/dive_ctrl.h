@@ -0,0 +1,179 @@
+/* dive_ctrl.h - dive/climb decision logic shared by deploy, simulate and host replay
+ *
+ * Everything in here is plain C with no Zephyr dependencies: the caller feeds
+ * in one sensor sample per control tick (with its own timestamp) and gets back
+ * the actuator command to issue, if any. deploy.c executes the commands on the
+ * hardware; tools/replay.c executes them against a dead-reckoned model so a
+ * recorded [SENS] log can be re-run at host speed.
+ */
+#ifndef DIVE_CTRL_H
+#define DIVE_CTRL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_params.h"
+
+/* Physical constants */
+#define SEA_WATER_DENSITY_KG_M3 1025.0
+#define GRAVITY_M_S2 9.80665
+
+/* Depth below which the climb is considered surfaced */
+#define SURFACE_DEPTH_M 1.0
+
+/* One control-loop sensor sample */
+struct dive_sample {
+    int64_t t_ms;          /* uptime when the sample was taken */
+    int32_t internal_pa;   /* BMP180 hull pressure */
+    float   depth_m;       /* depth below the surface reference */
+    float   temp_c;        /* MS5837 water temperature */
+    float   heading_deg;
+    float   pitch_deg;
+    float   roll_deg;
+};
+
+enum dive_actuator {
+    DIVE_ACT_ROLL = 0,
+    DIVE_ACT_PITCH,
+    DIVE_ACT_PUMP,
+    DIVE_ACT__COUNT
+};
+
+/* Deploy cycle states (deploy.c runs them; tools/replay mirrors them) */
+enum dive_state {
+    DIVE_ST_SURFACE_TRIM = 0,  /* move to start trim before a dive */
+    DIVE_ST_DESCEND,           /* dive trim, heading control, wait for inflection */
+    DIVE_ST_INFLECT,           /* climb trim issued, waiting for the moves */
+    DIVE_ST_ASCEND,            /* heading control, wait for surface or yo-yo turn */
+    DIVE_ST_SURFACE,           /* surface trim, roll neutral, settle */
+    DIVE_ST_GPS,               /* position fix */
+    DIVE_ST_COMMS,             /* operator window before the next dive */
+    DIVE_ST_ABORT,             /* emergency ascent, then surface and stop */
+    DIVE_ST__COUNT
+};
+
+/* Why a command was issued (used for logging and replay output) */
+enum dive_cmd_reason {
+    DIVE_CMD_TRIM = 0,       /* move to a surface/dive/climb set-point */
+    DIVE_CMD_HEADING,        /* heading controller roll correction */
+};
+
+struct dive_cmd {
+    enum dive_actuator act;
+    enum dive_cmd_reason reason;
+    int dir;                 /* +1 / -1 */
+    uint32_t duration_ms;
+    float target_s;          /* position the move ends at */
+};
+
+/* Per-phase controller state */
+struct dive_ctrl {
+    bool dive_phase;             /* true while descending */
+    int64_t phase_start_ms;
+
+    /* Heading PI controller */
+    int64_t last_heading_ms;     /* time of the last heading update */
+    float heading_err_deg;       /* error at the last update */
+    float heading_integ;         /* integral of error, degree-seconds */
+    float roll_target_s;         /* last commanded roll set-point */
+};
+
+/* Alpha-beta vertical velocity estimate over the depth stream */
+struct dive_vz {
+    bool valid;
+    int64_t t_ms;
+    float depth_m;               /* filtered depth */
+    float vz_m_s;                /* positive while descending */
+};
+
+/* Predictive inflection: climb is commanded when the depth projected over
+ * the learned lead time reaches the target. The lead is the overshoot per
+ * unit descent rate measured on previous cycles (apex depth minus inflection
+ * depth, over the descent rate at inflection), i.e. the effective latency of
+ * the pump and pitch moves. It persists across cycles. */
+struct dive_inflect {
+    float lead_s;                /* learned lead, seconds */
+    uint32_t cycles_learned;
+
+    /* current cycle */
+    bool active;                 /* inflected, watching for the apex */
+    int64_t inflect_ms;
+    float inflect_depth_m;
+    float inflect_vz_m_s;
+    int64_t apex_ms;
+    float apex_depth_m;
+};
+
+/* Depth in metres for an external pressure reading; 0 if no reference */
+double dive_depth_from_pa(double external_pa, double surface_pa);
+
+/* Shortest angular distance desired - current, in [-180, +180] */
+float dive_heading_delta(float current_deg, float desired_deg);
+
+/* Trim moves shorter than this are skipped (positions are tracked in ms) */
+#define DIVE_TRIM_TOLERANCE_S 0.1f
+
+/* Reset per-phase state at the start of a descent or climb */
+void dive_ctrl_begin_phase(struct dive_ctrl *c, bool dive_phase, int64_t now_ms);
+
+/* Command that moves an actuator from pos_s to target_s.
+ * Returns false when already within DIVE_TRIM_TOLERANCE_S of the target. */
+bool dive_ctrl_move_to(enum dive_actuator act, float target_s, float pos_s,
+                       struct dive_cmd *out);
+
+/* Roll back to start_roll_s (surfacing); honours roll_deadband_ms rather
+ * than the trim tolerance */
+bool dive_ctrl_roll_neutral(float roll_pos_s, const struct app_params *p,
+                            struct dive_cmd *out);
+
+/* Heading PI controller; call once per sample. Every heading_period_s it
+ * computes a continuous roll set-point (clamped to +/-max_roll_s around
+ * start_roll_s, with conditional-integration anti-windup) and returns true
+ * with a millisecond roll move when the set-point is more than
+ * roll_deadband_ms away from roll_pos_s. */
+bool dive_ctrl_heading(struct dive_ctrl *c, const struct dive_sample *s,
+                       float roll_pos_s, const struct app_params *p,
+                       struct dive_cmd *out);
+
+/* Vertical velocity estimator; reset at cycle start, update every sample */
+void dive_vz_reset(struct dive_vz *f);
+void dive_vz_update(struct dive_vz *f, const struct dive_sample *s);
+
+/* Inflection predictor; init once per deployment */
+void dive_inflect_init(struct dive_inflect *in, const struct app_params *p);
+/* True when the climb should start now. predicted_m receives the projected
+ * apex depth. Falls back to the plain target test when inflect_lead_ms is 0
+ * or the velocity estimate is not yet valid. */
+bool dive_inflect_due(const struct dive_inflect *in, const struct dive_vz *vz,
+                      const struct dive_sample *s, const struct app_params *p,
+                      float *predicted_m);
+/* Yo-yo: true when a climb should turn back down at yoyo_min_depth_m.
+ * Projects the rise over the same lead as the bottom inflection. */
+bool dive_inflect_turn_due(const struct dive_inflect *in, const struct dive_vz *vz,
+                           const struct dive_sample *s, const struct app_params *p,
+                           float *predicted_m);
+/* Record the inflection point (call when the climb moves are issued) */
+void dive_inflect_begin(struct dive_inflect *in, const struct dive_vz *vz,
+                        const struct dive_sample *s);
+/* Track the apex; call for every climb sample */
+void dive_inflect_track(struct dive_inflect *in, const struct dive_sample *s);
+/* Fold this cycle's overshoot into the lead; call when the climb ends.
+ * Returns true if the lead was updated. */
+bool dive_inflect_learn(struct dive_inflect *in);
+
+/* Descent end condition */
+bool dive_ctrl_target_reached(const struct dive_sample *s, const struct app_params *p);
+
+/* Per-state time limit from the parameters, 0 = none */
+int64_t dive_state_timeout_ms(enum dive_state st, const struct app_params *p);
+/* True once a state entered at entered_ms has used up its time limit */
+bool dive_state_timed_out(enum dive_state st, int64_t entered_ms, int64_t now_ms,
+                          const struct app_params *p);
+const char *dive_state_name(enum dive_state st);
+
+/* Climb end condition */
+bool dive_ctrl_surface_reached(const struct dive_sample *s);
+
+const char *dive_actuator_name(enum dive_actuator act);
+
+#endif /* DIVE_CTRL_H */
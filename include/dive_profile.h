@@ -0,0 +1,76 @@
+/* dive_profile.h - depth-binned profile of a cycle
+ *
+ * The deploy loop feeds every sample into per-bin streaming means of water
+ * temperature, pitch, roll and heading, descent and ascent kept apart. At
+ * surfacing each occupied bin is reduced to a small fixed-point record and
+ * printed as one [PROFILE] line, which is most of what a dive is used for
+ * at a fraction of the raw sample log.
+ *
+ * Bins are profile_bin_m deep. A dive deeper than DIVE_PROFILE_BINS bins
+ * doubles the bin size, merging neighbours, so the whole water column is
+ * always covered. Yo-yo dives of one surfacing share a profile.
+ *
+ * No Zephyr dependencies (dive_profile.c); shared with tools/replay.
+ */
+#ifndef DIVE_PROFILE_H
+#define DIVE_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dive_ctrl.h"
+
+#define DIVE_PROFILE_BINS 48       /* per direction */
+
+enum dive_profile_dir {
+    DIVE_PROF_DOWN = 0,            /* DESCEND, INFLECT */
+    DIVE_PROF_UP,                  /* ASCEND, ABORT */
+    DIVE_PROF__COUNT
+};
+
+/* Streaming means of one bin; heading as a unit vector */
+struct dive_profile_acc {
+    uint32_t n;
+    float temp_c;
+    float pitch_deg;
+    float roll_deg;
+    float hdg_x;
+    float hdg_y;
+};
+
+struct dive_profile {
+    uint32_t cycle;
+    float bin_m;                   /* current bin size, 0 = off */
+    struct dive_profile_acc acc[DIVE_PROF__COUNT][DIVE_PROFILE_BINS];
+};
+
+/* One occupied bin, fixed point */
+struct dive_profile_bin {
+    uint16_t depth_dm;             /* bin centre, 0.1 m */
+    uint16_t n;                    /* samples */
+    int16_t  temp_cc;              /* mean, 0.01 C */
+    int16_t  pitch_ddeg;           /* mean, 0.1 degree */
+    int16_t  roll_ddeg;
+    uint16_t heading_ddeg;         /* circular mean, 0.1 degree */
+};
+
+/* bin_m <= 0 turns the profile off for the cycle */
+void dive_profile_begin(struct dive_profile *pf, uint32_t cycle, float bin_m);
+/* Account one sample taken in state st; other states are ignored */
+void dive_profile_sample(struct dive_profile *pf, enum dive_state st,
+                         const struct dive_sample *s);
+
+/* Bin i of a direction, shallowest first; false when it has no samples */
+bool dive_profile_get(const struct dive_profile *pf, enum dive_profile_dir dir,
+                      unsigned int i, struct dive_profile_bin *out);
+/* Occupied bins and samples of a direction */
+unsigned int dive_profile_count(const struct dive_profile *pf, enum dive_profile_dir dir,
+                                uint32_t *samples);
+
+/* One-line renderings, no line ending */
+int dive_profile_format_head(const struct dive_profile *pf, char *buf, size_t len);
+int dive_profile_format_bin(enum dive_profile_dir dir, const struct dive_profile_bin *b,
+                            char *buf, size_t len);
+
+#endif /* DIVE_PROFILE_H */
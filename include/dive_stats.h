@@ -0,0 +1,92 @@
+/* dive_stats.h - per-cycle dive statistics
+ *
+ * The deploy loop feeds every sample into streaming accumulators (Welford
+ * mean and variance, min and max) and charges the time spent in each state.
+ * At surfacing the accumulators are reduced to a compact fixed-point
+ * summary record that is printed as one line and kept in NVS, so a dive can
+ * be judged at the surface without downloading the log.
+ *
+ * The accumulators have no Zephyr dependencies (dive_stats.c) and are
+ * shared with tools/replay; persistence lives in dive_stats_store.c.
+ */
+#ifndef DIVE_STATS_H
+#define DIVE_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "app_params.h"
+#include "dive_ctrl.h"
+
+/* Streaming mean/variance with min and max */
+struct dive_stat {
+    uint32_t n;
+    float mean;
+    float m2;                      /* sum of squared deviations */
+    float min;
+    float max;
+};
+
+struct dive_cycle_stats {
+    uint32_t cycle;
+    int64_t start_ms;
+    struct dive_stat depth_m;
+    struct dive_stat descent_m_s;  /* filtered vz while descending */
+    struct dive_stat ascent_m_s;   /* -vz while ascending */
+    struct dive_stat heading_err_deg;  /* desired - measured, dive and climb */
+    struct dive_stat dive_pitch_deg;   /* |pitch| while descending */
+    struct dive_stat climb_pitch_deg;  /* |pitch| while ascending */
+    uint32_t state_ms[DIVE_ST__COUNT];
+};
+
+/* Summary record kept per cycle; fixed point to stay small in NVS */
+struct dive_summary {
+    uint32_t cycle;
+    uint32_t duration_s;
+    uint16_t max_depth_cm;
+    uint16_t descent_mm_s;         /* mean */
+    uint16_t descent_sd_mm_s;
+    uint16_t ascent_mm_s;
+    uint16_t ascent_sd_mm_s;
+    int16_t  hdg_err_ddeg;         /* mean, 0.1 degree */
+    uint16_t hdg_err_sd_ddeg;
+    uint16_t hdg_err_max_ddeg;     /* largest |error| */
+    uint16_t state_s[DIVE_ST__COUNT];
+    uint16_t act_on_ds[DIVE_ACT__COUNT];   /* actuator on-time, 0.1 s */
+    uint8_t  act_starts[DIVE_ACT__COUNT];
+    uint8_t  act_reversals[DIVE_ACT__COUNT];
+    uint16_t energy_mwh;           /* estimated actuator energy */
+};
+
+void dive_stat_reset(struct dive_stat *st);
+void dive_stat_add(struct dive_stat *st, float x);
+/* Sample standard deviation, 0 for fewer than two samples */
+float dive_stat_sd(const struct dive_stat *st);
+
+void dive_stats_begin(struct dive_cycle_stats *cs, uint32_t cycle, int64_t now_ms);
+/* Account one sample taken in state st; vz may be NULL or not yet valid */
+void dive_stats_sample(struct dive_cycle_stats *cs, enum dive_state st,
+                       const struct dive_sample *s, const struct dive_vz *vz,
+                       const struct app_params *p);
+/* Charge ms to a state (call on every transition) */
+void dive_stats_state_time(struct dive_cycle_stats *cs, enum dive_state st, uint32_t ms);
+
+void dive_stats_summarize(const struct dive_cycle_stats *cs, int64_t now_ms,
+                          struct dive_summary *out);
+/* One-line rendering of a summary, no line ending. The COMMS window is
+ * after the summary and is not shown. */
+int dive_summary_format(const struct dive_summary *r, char *buf, size_t len);
+
+/* --- Persistence (dive_stats_store.c) --- */
+
+#define DIVE_STATS_KEEP 8          /* summaries kept in NVS */
+
+int dive_stats_init(void);
+/* Append to the NVS ring; the oldest record drops out */
+int dive_stats_save(const struct dive_summary *r);
+/* i = 0 is the newest; false past the end */
+bool dive_stats_get(unsigned int i, struct dive_summary *out);
+void dive_stats_print(void);
+
+#endif /* DIVE_STATS_H */
@@ -0,0 +1,49 @@
+/* drive_profile.h - soft-start / soft-stop speed profile for a timed move
+ *
+ * With PWM drive an actuator runs at a duty below 100 %, ramping up from
+ * duty_min at the start and back down at the end of a move. Positions
+ * stay in ms of run time at full speed (speed is taken as proportional
+ * to duty), so a move of distance_ms covers the same travel as a plain
+ * GPIO run of distance_ms, it just takes longer. The plan works out the
+ * ramp and cruise lengths for that distance; short moves get a shorter,
+ * triangular profile. No Zephyr dependencies.
+ */
+#ifndef DRIVE_PROFILE_H
+#define DRIVE_PROFILE_H
+
+#include <stdint.h>
+
+#define DRIVE_DUTY_FULL      1000U          /* duties are per mille */
+#define DRIVE_CRUISE_FOREVER UINT32_MAX     /* continuous run, ends on stop */
+
+struct drive_limits {
+    uint16_t duty_min_pm;          /* duty at the start and end of a ramp */
+    uint16_t duty_max_pm;          /* speed limit */
+    uint16_t ramp_ms;              /* duty_min -> duty_max */
+};
+
+struct drive_profile {
+    uint16_t start_pm;
+    uint16_t peak_pm;
+    uint32_t ramp_ms;              /* each of ramp-up and ramp-down */
+    uint32_t cruise_ms;            /* at peak_pm, or DRIVE_CRUISE_FOREVER */
+};
+
+/* Full duty, no ramps: the plain GPIO drive */
+void drive_limits_full(struct drive_limits *lim);
+
+/* Plan a move of distance_ms full-speed ms; 0 = run until stopped */
+void drive_profile_plan(const struct drive_limits *lim, uint32_t distance_ms,
+                        struct drive_profile *out);
+
+/* Wall time of the whole move; DRIVE_CRUISE_FOREVER for a continuous run */
+uint32_t drive_profile_total_ms(const struct drive_profile *p);
+
+/* Duty t_ms into the move, 0 once it is over */
+uint16_t drive_profile_duty(const struct drive_profile *p, uint32_t t_ms);
+
+/* Next time after t_ms at which the duty should be updated when stepping
+ * every step_ms; DRIVE_CRUISE_FOREVER when it no longer changes */
+uint32_t drive_profile_next_ms(const struct drive_profile *p, uint32_t t_ms, uint32_t step_ms);
+
+#endif /* DRIVE_PROFILE_H */
@@ -0,0 +1,64 @@
+/* flash_log.h - binary sample log in the storage partition
+ *
+ * Every deploy/simulate sample (log_rec.h) is compressed into 256-byte
+ * blocks (log_codec.h). The blocks go into a ring of 4 KB sectors in the
+ * part of the storage partition NVS does not use (above
+ * CONFIG_SETTINGS_NVS_SECTOR_COUNT sectors). The log survives with the
+ * glider when the OpenLog is pulled.
+ *
+ * flash_log_put() only copies the record into a queue and never blocks; a
+ * low-priority writer thread encodes it and programs each block as it
+ * fills. When the writer moves into a sector it erases the one after it,
+ * so a write never waits for an erase and the oldest sector is dropped as
+ * the ring wraps. A full queue drops the record and counts it.
+ *
+ * On boot the ring is scanned for the newest valid block and logging
+ * continues after it; samples still in the open block are lost on a
+ * reset, so deploy writes it out early at every surfacing.
+ */
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "log_rec.h"
+#include "log_codec.h"
+
+struct flash_log_info {
+    bool ready;
+    uint32_t capacity;             /* blocks the ring holds */
+    uint32_t first_seq;            /* oldest block in flash */
+    uint32_t next_seq;             /* next block to be written */
+    uint32_t next_sample;          /* sample number of the next record */
+    uint32_t pending;              /* samples in the open block */
+    uint32_t dropped;              /* samples lost: queue full or write failed */
+};
+
+/* Open the partition and find the head; call after app_params_init() */
+int flash_log_init(void);
+
+/* Queue a record (numbered by the writer); false when it was dropped.
+ * Safe from any thread, never blocks. */
+bool flash_log_put(const struct log_rec *r);
+/* Have the writer write out the open block even if it is not full;
+ * returns at once */
+void flash_log_flush(void);
+/* Write out the open block from this thread and wait for it */
+void flash_log_sync(void);
+
+void flash_log_get_info(struct flash_log_info *out);
+/* Blocks, compression, drops, encode/write/erase times and the newest
+ * sample on the console */
+void flash_log_print(void);
+
+/* Copy up to max blocks from *seq on, moving *seq up to the oldest block
+ * still in flash. Stops at the end of the ring so each call is one
+ * contiguous flash read. Returns the number copied (0 once *seq reaches
+ * next_seq) or a negative error. Slots skipped after a torn or failed
+ * write come back as invalid blocks (log_block_valid()). */
+int flash_log_read(uint32_t *seq, struct log_block *buf, uint32_t max);
+/* Wipe the ring and start again from block and sample 0 */
+int flash_log_erase(void);
+
+#endif /* FLASH_LOG_H */
@@ -1,6 +1,13 @@
 #ifndef HW_GPS_H
 #define HW_GPS_H
 #include <stdbool.h>
+#include <stdint.h>
+
+struct gps_fix {
+    double lat_deg;
+    double lon_deg;
+    int64_t t_ms;                  /* uptime when acquired */
+};
 
 /* Interactive GPS fix: blocks while reading the u-blox GPS (I2C/DDC). 
  * Prints 'V' once/sec until a valid fix, then prints:
@@ -15,4 +22,11 @@ void gps_fix_interactive(void);
  */
 bool gps_fix_wait(int timeout_sec);
 
+/* Same as gps_fix_wait(), returning false early once cancel() returns true.
+ * cancel is polled between reads (every few ms); NULL never cancels. */
+bool gps_fix_wait_cancel(int timeout_sec, bool (*cancel)(void));
+
+/* Most recent valid fix from any of the above; false if none yet */
+bool gps_last_fix(struct gps_fix *out);
+
 #endif /* HW_GPS_H */
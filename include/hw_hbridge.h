@@ -0,0 +1,39 @@
+/* hw_hbridge.h - two-input H-bridge driven by GPIO levels or PWM
+ *
+ *  IN1 IN2
+ *   d   0  -> direction A (+1)
+ *   0   d  -> direction B (-1)
+ *   0   0  -> coast
+ * With PWM each input is its own LEDC channel and d is the duty; with
+ * GPIO any non-zero duty is full on. Brake (1 1) is never driven.
+ */
+#ifndef HW_HBRIDGE_H
+#define HW_HBRIDGE_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/pwm.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct hbridge {
+    struct gpio_dt_spec in1;       /* GPIO mode; .port NULL when absent */
+    struct gpio_dt_spec in2;
+    const struct pwm_dt_spec *pwm1;    /* PWM mode; NULL for GPIO */
+    const struct pwm_dt_spec *pwm2;
+};
+
+/* Configure both inputs and leave the bridge coasting */
+int hbridge_configure(const struct hbridge *hb);
+
+/* Both inputs present */
+bool hbridge_ready(const struct hbridge *hb);
+bool hbridge_has_pwm(const struct hbridge *hb);
+
+/* dir +1/-1 at duty_pm per mille; dir 0 or duty 0 coasts. GPIO writes
+ * are register writes and may be made from any context, under a spinlock
+ * or in an ISR. PWM goes through the LEDC driver, which serialises on a
+ * semaphore and may block: thread context only, no spinlock held. */
+int hbridge_drive(const struct hbridge *hb, int dir, uint16_t duty_pm);
+
+#endif /* HW_HBRIDGE_H */
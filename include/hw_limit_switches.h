@@ -9,7 +9,9 @@
 
 /**
  * Initialize pitch limit switches on GPIO32 and GPIO33.
- * Switches are monitored via GPIO interrupts and trigger motor stop.
+ * Switches are monitored via GPIO interrupts: the ISR cuts a pitch run
+ * heading into the switch, and a debounced work item then logs the
+ * switch-to-off latency and backs the motor off the switch.
  * GPIO32/33 are input-only pins and safe from boot strapping conflicts.
  *
  * @return 0 on success, negative errno on failure
@@ -32,13 +34,6 @@ bool limit_switch_is_pressed(int switch_id);
  */
 void limit_switch_callback(int switch_id);
 
-/**
- * Check triggered switches and perform motor stop (SAFE FOR MAIN LOOP).
- * This function should be called periodically from the main event loop,
- * NOT from an ISR. It handles the actual motor stop action.
- */
-void limit_switches_check_and_stop(void);
-
 /**
  * Interactive test loop for limit switches.
  * Continuously displays GPIO32/33 status and exits when user presses 'q'.
@@ -2,6 +2,7 @@
 #define HW_MOTORS_H
 
 #include <zephyr/kernel.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 enum motor_id {
@@ -10,11 +11,37 @@ enum motor_id {
 };
 
 int motors_init(void);
-void motor_run(enum motor_id id, int dir, uint32_t duration_s);
 
+/* Run for duration_ms (0 = until stopped); dir 0 stops. The position is
+ * integrated from the actual start and stop times, so an early stop or a
+ * replaced run leaves it right. */
+void motor_cmd_ms(enum motor_id id, int dir, uint32_t duration_ms);
+void motor_stop(enum motor_id id);
+bool motor_is_running(enum motor_id id);
 
-int32_t motor_get_position_sec(enum motor_id id);
+/* Stop id if it is running in direction dir; callable from an ISR and
+ * quiet (the stop is logged later through actuator_wq). Position and
+ * state stop at once. GPIO drive is off on return; the LEDC write for
+ * PWM drive may block, so it is left to actuator_wq. Returns true if it
+ * cut. t0_cycles (k_cycle_get_32()) starts the motor_cut_us() clock. */
+bool motor_cut(enum motor_id id, int dir, uint32_t t0_cycles);
+/* t0_cycles of the last cut to the bridge actually off, microseconds */
+uint32_t motor_cut_us(enum motor_id id);
+/* Runs motor_cut() has stopped since boot */
+uint32_t motor_cut_count(enum motor_id id);
+
+/* Optional check run before every start; returning false refuses the run
+ * (e.g. pitch driven further into a pressed limit switch) */
+typedef bool (*motor_guard_fn)(int dir);
+void motor_set_guard(enum motor_id id, motor_guard_fn guard);
+
+/* Position in ms of run time from zero, including a run in progress */
+int32_t motor_get_position_ms(enum motor_id id);
 void motor_reset_position(enum motor_id id);
 void motors_reset_all_positions(void);
+/* Restore a known position (checkpoint resume) */
+void motor_set_position_ms(enum motor_id id, int32_t position_ms);
+/* Correct the position by delta_ms, also while running (re-zeroing) */
+void motor_shift_position_ms(enum motor_id id, int32_t delta_ms);
 
 #endif /* HW_MOTORS_H */
\ No newline at end of file
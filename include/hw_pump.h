@@ -2,13 +2,21 @@
 #define HW_PUMP_H
 
 #include <zephyr/kernel.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 int pump_init(void);
-void pump_run(int dir, uint32_t duration_s);
 
+/* Run for duration_ms (0 = until stopped); dir 0 stops. The position is
+ * integrated from the actual start and stop times. */
+void pump_cmd_ms(int dir, uint32_t duration_ms);
+void pump_stop(void);
+bool pump_is_running(void);
 
-int32_t pump_get_position_sec(void);
+/* Position in ms of run time from zero, including a run in progress */
+int32_t pump_get_position_ms(void);
 void pump_reset_position(void);
+/* Restore a known position (checkpoint resume) */
+void pump_set_position_ms(int32_t position_ms);
 
 #endif /* HW_PUMP_H */
\ No newline at end of file
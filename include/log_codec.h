@@ -0,0 +1,96 @@
+/* log_codec.h - compressed blocks for the flash sample log
+ *
+ * Samples (struct log_rec) are packed into self-contained 256-byte blocks.
+ * The first sample of a block is a keyframe, so any block decodes on its
+ * own. After it, each channel is coded as the zig-zag varint of its error
+ * against a prediction: the previous value, or for time and depth (which
+ * move steadily) the previous value plus the previous step. A leading
+ * varint mask lists the channels with a non-zero error. The channels that
+ * change every sample come first, so the mask usually fits in one byte.
+ * Unchanged positions, state and temperature then cost nothing. Heading
+ * errors wrap at 360 degrees.
+ *
+ * A 1 Hz dive sample takes about 8 bytes against 32 raw.
+ *
+ * No Zephyr dependencies; the same encoder and decoder run on the glider
+ * and in the host tools (tools/flog_decode, tools/codec_bench).
+ */
+#ifndef LOG_CODEC_H
+#define LOG_CODEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "log_rec.h"
+
+#define LOG_BLOCK_SIZE      256
+#define LOG_BLOCK_VERSION   1
+
+enum log_channel {
+    /* changing every sample: one mask byte covers them */
+    LOG_CH_T = 0,
+    LOG_CH_DEPTH,
+    LOG_CH_HEADING,
+    LOG_CH_PITCH,
+    LOG_CH_ROLL,
+    LOG_CH_INTERNAL_PA,
+    LOG_CH_TEMP,
+    /* mostly constant */
+    LOG_CH_POS_ROLL,
+    LOG_CH_POS_PITCH,
+    LOG_CH_POS_PUMP,
+    LOG_CH_STATE,
+    LOG_CH__COUNT
+};
+
+struct log_block_hdr {
+    uint32_t seq;                  /* block sequence number */
+    uint32_t first;                /* sample number of the keyframe */
+    uint16_t len;                  /* payload bytes used */
+    uint16_t crc;                  /* CRC-16/CCITT of header and payload */
+    uint8_t  count;                /* samples in the block */
+    uint8_t  version;
+    uint16_t reserved;
+};
+
+#define LOG_BLOCK_PAYLOAD   (LOG_BLOCK_SIZE - (int)sizeof(struct log_block_hdr))
+
+struct log_block {
+    struct log_block_hdr h;
+    uint8_t data[LOG_BLOCK_PAYLOAD];
+};
+
+_Static_assert(sizeof(struct log_block) == LOG_BLOCK_SIZE, "log_block layout");
+
+/* Encoder: one open block plus the predictor state */
+struct log_enc {
+    struct log_block blk;
+    int32_t prev[LOG_CH__COUNT];
+    int32_t step[LOG_CH__COUNT];
+};
+
+/* Open an empty block whose keyframe will be sample number first */
+void log_enc_begin(struct log_enc *e, uint32_t first);
+/* Append a sample; false (and nothing added) when the block is full */
+bool log_enc_add(struct log_enc *e, const struct log_rec *r);
+/* Finish the block for writing: sequence number, CRC, 0xFF padding */
+void log_enc_seal(struct log_enc *e, uint32_t seq);
+
+/* Complete, uncorrupted block */
+bool log_block_valid(const struct log_block *b);
+
+/* Decoder over one block */
+struct log_dec {
+    const struct log_block *b;
+    uint16_t pos;
+    uint8_t n;
+    int32_t prev[LOG_CH__COUNT];
+    int32_t step[LOG_CH__COUNT];
+};
+
+void log_dec_begin(struct log_dec *d, const struct log_block *b);
+/* Next sample (seq is its sample number, CRC sealed); false at the end or
+ * on a malformed payload */
+bool log_dec_next(struct log_dec *d, struct log_rec *out);
+
+#endif /* LOG_CODEC_H */
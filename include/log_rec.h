@@ -0,0 +1,50 @@
+/* log_rec.h - fixed-point sample record for the flash log
+ *
+ * One record per deploy/simulate sample: 32 bytes against ~90 for the
+ * [SENS] line. Fields are scaled integers so nothing needs float formatting
+ * on the way to flash. Records are stored little-endian in this layout;
+ * the sequence number orders them across wrap-around and the CRC-8 tells a
+ * complete record from erased or half-written flash.
+ *
+ * No Zephyr dependencies; shared with the host tools.
+ */
+#ifndef LOG_REC_H
+#define LOG_REC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dive_ctrl.h"
+
+#define LOG_REC_SIZE    32
+#define LOG_REC_NO_SEQ  0xFFFFFFFFu    /* erased flash */
+
+struct log_rec {
+    uint32_t seq;                  /* assigned by the writer */
+    uint32_t t_ms;                 /* uptime */
+    int32_t  depth_mm;
+    int32_t  internal_pa;          /* BMP180 hull pressure */
+    int16_t  temp_cc;              /* MS5837 water temperature, 0.01 C */
+    uint16_t heading_cdeg;
+    int16_t  pitch_cdeg;
+    int16_t  roll_cdeg;
+    int16_t  pos_10ms[DIVE_ACT__COUNT];    /* actuator positions */
+    uint8_t  state;                /* enum dive_state */
+    uint8_t  crc;                  /* CRC-8 of the bytes before it */
+};
+
+_Static_assert(sizeof(struct log_rec) == LOG_REC_SIZE, "log_rec layout");
+
+/* Pack a sample; pos_ms is indexed by enum dive_actuator. The seq and crc
+ * are filled in by log_rec_seal(). */
+void log_rec_pack(struct log_rec *r, const struct dive_sample *s, enum dive_state st,
+                  const int32_t pos_ms[DIVE_ACT__COUNT]);
+/* Unpack into a sample; positions and state stay in the record */
+void log_rec_unpack(const struct log_rec *r, struct dive_sample *s);
+
+/* Set the sequence number and CRC */
+void log_rec_seal(struct log_rec *r, uint32_t seq);
+/* Complete, uncorrupted record */
+bool log_rec_valid(const struct log_rec *r);
+
+#endif /* LOG_REC_H */
@@ -0,0 +1,27 @@
+/* log_server.h - TCP download of the flash sample log
+ *
+ * One client at a time on LOG_SERVER_PORT. Requests are text lines,
+ * replies a text header line and, for GET, raw log block bytes:
+ *
+ *   INFO               -> FLOG <first> <end> <block size>
+ *   GET <off> [<len>]  -> DATA <off> <len>\n then <len> bytes
+ *   QUIT
+ *
+ * Offsets are absolute byte positions in the block stream (block number
+ * times LOG_BLOCK_SIZE), so they stay valid as the ring wraps and a
+ * client resumes an interrupted download by asking for the offset it
+ * stopped at. An offset older than the ring starts at <first> instead (the
+ * DATA header says where); <len> 0 or missing means up to <end>. Any
+ * byte offset works, not only block boundaries. INFO reports the blocks
+ * already on flash and leaves the one being filled alone; deploy writes
+ * that out at every surfacing.
+ *
+ * Each transfer logs its size and throughput. tools/log_fetch.py is the
+ * host side.
+ */
+#ifndef LOG_SERVER_H
+#define LOG_SERVER_H
+
+#define LOG_SERVER_PORT 2324
+
+#endif /* LOG_SERVER_H */
@@ -0,0 +1,129 @@
+/* logd.h - deferred (dictionary) log records
+ *
+ * Hot-path messages are listed in LOGD_FORMATS below. Instead of being
+ * formatted where they are logged, their arguments are copied raw into a
+ * short record: the message id, then each argument as 4 bytes (integers,
+ * floats as float), 8 bytes (long long) or a length-prefixed string. The
+ * record is turned into text later with logd_format(), by a background
+ * thread on the glider (app_logd.c) or on the host from the same table
+ * (tools/logd_decode).
+ *
+ * Formats may use the usual conversions with flags, width and precision,
+ * but not '*'. 'l' means 32 bits (the firmware's long), 'll' 64.
+ *
+ * No Zephyr dependencies (logd.c); shared with the host tools.
+ */
+#ifndef LOGD_H
+#define LOGD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Formats, one per message; the index in this list is the record id, so
+ * append new entries at the end and keep the old ones */
+#define LOGD_FMT_SENS      "[SENS] t=%u IntP=%d Pa, %s=%.2fm, H=%.1f,R=%.1f,P=%.1f\r\n"
+#define LOGD_FMT_ROLL_PI   "[ROLL] PI (%s): heading=%.1f° desired=%d° (Δ=%.1f°, I=%.1f°s), " \
+                           "moving roll %.2fs→%.2fs (%ums)\r\n"
+#define LOGD_FMT_PUMP_VOL  "[%s] pump %.1fmL -> %.1fmL at %.2fbar: %ums\r\n"
+#define LOGD_FMT_MOTOR_RUN "%s %s run %s for %ums\r\n"
+#define LOGD_FMT_MOTOR_RAMP "%s %s run %s for %ums (%ums at up to %u%%)\r\n"
+#define LOGD_FMT_PUMP_RUN  "[PUMP] run %s for %ums\r\n"
+#define LOGD_FMT_PUMP_RAMP "[PUMP] run %s for %ums (%ums at up to %u%%)\r\n"
+
+/* X(name, level): level as in app_print.h (3 = info, 4 = per-sample) */
+#define LOGD_FORMATS(X) \
+    X(SENS, 4)          \
+    X(ROLL_PI, 3)       \
+    X(PUMP_VOL, 3)      \
+    X(MOTOR_RUN, 3)     \
+    X(MOTOR_RAMP, 3)    \
+    X(PUMP_RUN, 3)      \
+    X(PUMP_RAMP, 3)
+
+enum logd_id {
+#define LOGD_ENUM(name, lvl) LOGD_##name,
+    LOGD_FORMATS(LOGD_ENUM)
+#undef LOGD_ENUM
+    LOGD__COUNT
+};
+
+struct logd_fmt {
+    uint8_t level;
+    const char *fmt;
+};
+
+extern const struct logd_fmt logd_dict[LOGD__COUNT];
+
+#define LOGD_REC_MAX    64         /* id + arguments */
+#define LOGD_STR_MAX    31         /* longer string arguments are cut */
+
+/* Record being packed at a call site */
+struct logd_pack {
+    uint8_t *p;
+    uint8_t *end;
+    bool full;                     /* an argument did not fit; drop it */
+};
+
+static inline void logd_pack_begin(struct logd_pack *pk, uint8_t *buf, size_t size,
+                                   enum logd_id id)
+{
+    buf[0] = (uint8_t)id;
+    pk->p = buf + 1;
+    pk->end = buf + size;
+    pk->full = false;
+}
+
+static inline void logd_put(struct logd_pack *pk, const void *v, size_t n)
+{
+    if ((size_t)(pk->end - pk->p) < n) {
+        pk->full = true;
+        return;
+    }
+    memcpy(pk->p, v, n);
+    pk->p += n;
+}
+
+static inline void logd_put_i32(struct logd_pack *pk, int32_t v) { logd_put(pk, &v, 4); }
+static inline void logd_put_i64(struct logd_pack *pk, int64_t v) { logd_put(pk, &v, 8); }
+static inline void logd_put_f(struct logd_pack *pk, double v)
+{
+    float f = (float)v;
+    logd_put(pk, &f, 4);
+}
+static inline void logd_put_s(struct logd_pack *pk, const char *s)
+{
+    size_t n = 0;
+    while (s && n < LOGD_STR_MAX && s[n] != '\0') {
+        n++;
+    }
+    uint8_t len = (uint8_t)n;
+    logd_put(pk, &len, 1);
+    logd_put(pk, s, n);
+}
+
+/* Pack one argument by its C type */
+#define LOGD_ARG(x, pk) _Generic((x),                                   \
+    float: logd_put_f, double: logd_put_f,                              \
+    char *: logd_put_s, const char *: logd_put_s,                       \
+    long long: logd_put_i64, unsigned long long: logd_put_i64,          \
+    default: logd_put_i32)((pk), (x))
+
+/* Text of a record (id + arguments); returns the length, -1 if the record
+ * is not valid. Output is cut to fit len. */
+int logd_format(const uint8_t *rec, size_t rec_len, char *out, size_t len);
+
+/* Raw console line: "~L" + base64(record + CRC-8) + "\r\n". Returns the
+ * line length, or 0 if out is too small. */
+#define LOGD_LINE_TAG   "~L"
+#define LOGD_LINE_MAX   (2 + ((LOGD_REC_MAX + 1 + 2) / 3) * 4 + 3)
+size_t logd_line_encode(const uint8_t *rec, size_t rec_len, char *out, size_t len);
+/* Record from a raw line (tag included, line ending optional); returns the
+ * record length, 0 if the line is not a valid record */
+size_t logd_line_decode(const char *line, uint8_t *rec, size_t max);
+
+/* Identifies this dictionary in a raw log (the [LOGD] dict line) */
+uint32_t logd_dict_crc(void);
+
+#endif /* LOGD_H */
@@ -0,0 +1,117 @@
+/* mission.h - table-driven dive mission
+ *
+ * A mission is a short table of steps stored in NVS next to the parameters.
+ * Each step runs `yos` dive/climb cycles with its own depth, set-points and
+ * heading, then follows its surfacing policy. With a yo-yo turn depth the
+ * yos of a step stay submerged, turning back down at that depth, and only
+ * the last one surfaces. Fields left at their inherit value take it from
+ * app_params, so the default one-step mission behaves exactly like the old
+ * fixed deploy loop (or a yo-yo, when yoyo_dives is set).
+ *
+ * The interpreter resolves a step into a per-cycle copy of app_params once
+ * per yo; the control loop then runs on that copy unchanged, so there is no
+ * per-tick cost. The table code has no Zephyr dependencies (mission.c);
+ * persistence lives in mission_store.c.
+ */
+#ifndef MISSION_H
+#define MISSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "app_params.h"
+
+#define MISSION_MAX_STEPS   16
+#define MISSION_VERSION     1
+#define MISSION_INHERIT     0xFF    /* set-point field: use app_params */
+#define MISSION_HEADING_INHERIT (-1)
+#define MISSION_DEPTH_INHERIT   0xFFFF  /* yo-yo turn depth: use app_params */
+
+/* What to do each time a yo of the step surfaces */
+enum mission_surface {
+    MISSION_SURF_PROMPT = 0,  /* GPS fix, then comms_window_s ENTER window (legacy) */
+    MISSION_SURF_GPS,         /* GPS fix, then dive again */
+    MISSION_SURF_SKIP,        /* no GPS fix, dive again straight away */
+    MISSION_SURF__COUNT
+};
+
+/* Mission flags */
+#define MISSION_F_REPEAT    0x01    /* restart at step 0 after the last step */
+
+/* One table entry, 12 bytes */
+struct mission_step {
+    uint16_t depth_dm;        /* target depth in decimetres, 0 = inherit */
+    int16_t  heading_deg;     /* desired heading, -1 = inherit */
+    uint8_t  dive_pitch_s;
+    uint8_t  dive_pump_s;
+    uint8_t  climb_pitch_s;
+    uint8_t  climb_pump_s;
+    uint8_t  yos;             /* dive/climb cycles, 0 = yoyo_dives */
+    uint8_t  surface;         /* enum mission_surface */
+    uint16_t min_depth_dm;    /* yo-yo turn depth, 0 = surface every yo */
+};
+
+struct mission {
+    uint8_t version;
+    uint8_t count;            /* used entries in steps[] */
+    uint8_t flags;
+    uint8_t reserved;
+    struct mission_step steps[MISSION_MAX_STEPS];
+};
+
+/* Interpreter position */
+struct mission_cursor {
+    uint8_t step;
+    uint8_t yo;               /* yos completed in the current step */
+    bool done;
+};
+
+/* --- Table (mission.c, host-usable) --- */
+
+/* One inherit-everything step, prompt at the surface, repeating */
+void mission_defaults(struct mission *m);
+
+/* Parse "depth dpitch dpump cpitch cpump heading yos policy [turn]", where
+ * '-' means inherit, policy is prompt|gps|skip and turn is the yo-yo turn
+ * depth (omitted or 0 = surface every yo). Returns 0 or -EINVAL. */
+int mission_parse_step(const char *line, struct mission_step *out);
+
+/* Format a step in the same syntax mission_parse_step() accepts */
+int mission_format_step(const struct mission_step *s, char *buf, size_t len);
+
+const char *mission_surface_name(enum mission_surface pol);
+
+/* --- Interpreter --- */
+
+void mission_begin(struct mission_cursor *c);
+
+/* Per-cycle parameters for the current yo: base with the step's fields
+ * applied. yoyo_min_depth_m is set to the turn depth for a yo that stays
+ * submerged and to 0 for one that surfaces. Returns false once the mission
+ * has finished. */
+bool mission_cycle_params(const struct mission *m, const struct mission_cursor *c,
+                          const struct app_params *base, struct app_params *out);
+
+/* Surfacing policy of the current step (applies when the yo surfaces) */
+enum mission_surface mission_cycle_surface(const struct mission *m,
+                                           const struct mission_cursor *c);
+
+/* Count one completed yo and move on to the next step when due */
+void mission_advance(const struct mission *m, struct mission_cursor *c,
+                     const struct app_params *base);
+
+/* --- Persistence (mission_store.c) --- */
+
+int mission_init(void);
+int mission_save(void);
+void mission_reset_defaults(void);
+struct mission *mission_get(void);
+
+/* Learned trim offsets (trim_learn.h), kept under "mission/trim" */
+struct trim_learn;
+struct trim_learn *mission_trim_get(void);
+int mission_trim_save(void);
+void mission_trim_reset(void);      /* clears and saves */
+
+#endif /* MISSION_H */
@@ -9,7 +9,10 @@ extern "C" {
 void net_console_init(void);
 void net_console_add(int fd);
 void net_console_remove(int fd);
-void net_console_write(const char *buf, size_t len);
+/* Queue output for the clients; returns the bytes queued (never waits) */
+size_t net_console_write(const char *buf, size_t len);
+/* Number of connected clients */
+int net_console_clients(void);
 
 /* Input API: get a complete line (terminated by CR or LF). Returns true if a line was read. */
 bool net_console_poll_line(char *out, size_t max_len, k_timeout_t timeout);
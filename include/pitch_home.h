@@ -0,0 +1,30 @@
+/* pitch_home.h - pitch homing and travel calibration on the limit switches
+ *
+ * Pitch position is dead-reckoned from run time, so errors build up.
+ * Homing drives AFT onto the DOWN stop, FWD onto the UP stop and back,
+ * measures the travel both ways and puts the DOWN stop at
+ * pitch_aft_stop_s: from then on pitch positions are absolute. The
+ * measured FWD travel is kept in pitch_travel_s.
+ *
+ * The legs and the back-off runs after each hit are act_sched moves, like
+ * every other actuator run, so they queue behind the current budget.
+ *
+ * Once homed, every confirmed switch hit (e.g. during a mission) re-zeroes
+ * the position against the stop it hit and logs the drift it removed.
+ */
+#ifndef PITCH_HOME_H
+#define PITCH_HOME_H
+
+#include <stdbool.h>
+
+/* Blocking, from a thread. 0, -ETIMEDOUT (no stop within
+ * pitch_home_timeout_s) or -EIO (stopped away from the switch). */
+int pitch_home(void);
+
+/* pitch_travel_s has been measured */
+bool pitch_home_valid(void);
+
+/* Limit switch confirmed with pitch stopped on it (hw_limit_switches.c) */
+void pitch_home_switch_hit(int switch_id);
+
+#endif /* PITCH_HOME_H */
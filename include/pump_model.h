@@ -0,0 +1,59 @@
+/* pump_model.h - pressure-dependent pump displacement
+ *
+ * The pump moves less water per second the harder it has to push: pumping
+ * IN (lighter) works against sea pressure and slows down with depth,
+ * pumping OUT (heavier) is helped by it. Directions are the driver's:
+ * +1 OUT, -1 IN, as in the [PUMP] run lines. Flow is modelled per
+ * direction as a straight line in gauge pressure, fitted by tools/pump_cal
+ * from [PUMPCAL] bench lines.
+ *
+ * With the model on, the pump set-points (*_pump_s, mission steps, learned
+ * trim) keep their units on the menus but stand for a volume: s seconds of
+ * OUT flow at the surface, pump_out_ml_s * s. The pump's volume is integrated
+ * at the pressure each run happened at, and every move is converted to run
+ * time at the current MS5837 pressure, so a set-point gives the same
+ * buoyancy at any depth.
+ *
+ * No Zephyr dependencies; shared with tools/replay and tools/pump_cal.
+ */
+#ifndef PUMP_MODEL_H
+#define PUMP_MODEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_params.h"
+#include "dive_ctrl.h"
+
+/* Flow never drops below this fraction of the surface flow, so a bad fit
+ * cannot ask for an endless run */
+#define PUMP_MODEL_MIN_FLOW_FRAC 0.1f
+
+/* Both directions calibrated */
+bool pump_model_enabled(const struct app_params *p);
+/* Gauge pressure in bar at a depth below the surface reference */
+float pump_model_gauge_bar(float depth_m);
+/* Flow in mL/s for dir (+1 OUT, -1 IN) at gauge_bar */
+float pump_model_flow_ml_s(const struct app_params *p, int dir, float gauge_bar);
+/* Volume a pump set-point stands for */
+float pump_model_setpoint_ml(const struct app_params *p, float setpoint_s);
+
+/* Dead-reckoned pump volume, from the position reported by the driver */
+struct pump_volume {
+    float   ml;
+    int32_t ref_ms;                /* position already folded into ml */
+};
+
+/* Start from a position reached at the surface */
+void pump_volume_reset(struct pump_volume *v, const struct app_params *p, int32_t pos_ms);
+/* Fold the travel since the last call, taken to have run at gauge_bar */
+void pump_volume_track(struct pump_volume *v, const struct app_params *p, int32_t pos_ms,
+                       float gauge_bar);
+
+/* Pump command from v towards the volume of set-point target_s, timed for
+ * gauge_bar. Returns false when already within DIVE_TRIM_TOLERANCE_S worth
+ * of surface flow. */
+bool pump_model_move_to(const struct app_params *p, const struct pump_volume *v,
+                        float target_s, float gauge_bar, struct dive_cmd *out);
+
+#endif /* PUMP_MODEL_H */
@@ -0,0 +1,50 @@
+/* surface_ops.h - concurrent surface-interval tasks
+ *
+ * At the surface the deploy worker hands the slow jobs (GPS fix, telemetry
+ * push, pending-update sync) to one worker thread each, so the interval
+ * lasts as long as the slowest job rather than their sum. The deploy
+ * worker keeps sampling and polls surface_ops_done(); a task still running
+ * when the deploy worker gives up on it is told so through
+ * surface_ops_cancelled() and waited for in surface_ops_finish().
+ *
+ * Only the deploy worker starts and finishes tasks.
+ */
+#ifndef SURFACE_OPS_H
+#define SURFACE_OPS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum surface_task {
+    SURF_TASK_GPS = 0,
+    SURF_TASK_TELEMETRY,
+    SURF_TASK_SYNC,
+    SURF_TASK__COUNT
+};
+
+#define SURF_TASK_BIT(t) (1U << (t))
+
+/* Runs in the task's worker thread; returns false if the job failed */
+typedef bool (*surface_task_fn)(void *arg);
+
+/* New interval: forget the previous results and start the interval clock */
+void surface_ops_begin(void);
+
+/* Queue a task on its worker; -EBUSY if it is still running */
+int surface_ops_start(enum surface_task t, surface_task_fn fn, void *arg);
+
+/* Mask of tasks started this interval that have returned */
+uint32_t surface_ops_done(void);
+
+/* Polled by long-running tasks; true once surface_ops_finish() was called */
+bool surface_ops_cancelled(void);
+
+/* Cancel whatever is still running and wait for it to return */
+void surface_ops_finish(void);
+
+/* One line with per-task time and result and the interval length */
+void surface_ops_report(const char *tag);
+
+const char *surface_task_name(enum surface_task t);
+
+#endif /* SURFACE_OPS_H */
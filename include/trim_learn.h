@@ -0,0 +1,54 @@
+/* trim_learn.h - adaptive buoyancy and pitch trim
+ *
+ * Water density and ballast drift over a deployment, and with them the
+ * descent and ascent rates. After every cycle the learner compares the
+ * measured mean vertical speeds and |pitch| against the target parameters
+ * and nudges offsets on the four dive/climb set-points. Each step is
+ * bounded, and so is the total offset (trim_learn_max_s). A target of 0
+ * leaves its set-point alone.
+ *
+ * The offsets are kept with the mission (mission_store.c) so they carry
+ * across deployments and reboots. No Zephyr dependencies; shared with
+ * tools/replay.
+ */
+#ifndef TRIM_LEARN_H
+#define TRIM_LEARN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_params.h"
+#include "dive_stats.h"
+
+#define TRIM_LEARN_VERSION 1
+
+/* Learned offsets in actuator seconds, added to the configured set-points */
+struct trim_learn {
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t cycles;               /* cycles that changed an offset */
+    float dive_pump_s;
+    float climb_pump_s;
+    float dive_pitch_s;
+    float climb_pitch_s;
+};
+
+/* Effective set-points for a cycle */
+struct dive_trim {
+    float dive_pitch_s;
+    float dive_pump_s;
+    float climb_pitch_s;
+    float climb_pump_s;
+};
+
+void trim_learn_reset(struct trim_learn *t);
+
+/* Fold one cycle into the offsets; returns true if any offset moved */
+bool trim_learn_update(struct trim_learn *t, const struct dive_cycle_stats *cs,
+                       const struct app_params *p);
+
+/* Set-points of p with the offsets applied, never below 0 */
+void trim_learn_setpoints(const struct trim_learn *t, const struct app_params *p,
+                          struct dive_trim *out);
+
+#endif /* TRIM_LEARN_H */
@@ -0,0 +1,99 @@
+/* act_energy.c - actuator on-time and energy accounting (no Zephyr dependencies) */
+#include <string.h>
+
+#include "act_energy.h"
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+void act_energy_reset(struct act_energy *e)
+{
+    memset(e->use, 0, sizeof(e->use));
+}
+
+void act_energy_start(struct act_energy *e, enum dive_state st,
+                      enum dive_actuator act, int dir)
+{
+    if ((unsigned)st >= DIVE_ST__COUNT || (unsigned)act >= DIVE_ACT__COUNT || dir == 0) {
+        return;
+    }
+    int8_t d = (dir > 0) ? 1 : -1;
+    struct act_usage *u = &e->use[st][act];
+
+    u->starts++;
+    if (e->last_dir[act] != 0 && e->last_dir[act] != d) {
+        u->reversals++;
+    }
+    e->last_dir[act] = d;
+}
+
+void act_energy_charge(struct act_energy *e, enum dive_state st,
+                       enum dive_actuator act, uint32_t ms)
+{
+    if ((unsigned)st >= DIVE_ST__COUNT || (unsigned)act >= DIVE_ACT__COUNT) {
+        return;
+    }
+    e->use[st][act].on_ms += ms;
+}
+
+void act_energy_total(const struct act_energy *e, enum dive_actuator act,
+                      struct act_usage *out)
+{
+    memset(out, 0, sizeof(*out));
+    if ((unsigned)act >= DIVE_ACT__COUNT) {
+        return;
+    }
+    for (int st = 0; st < DIVE_ST__COUNT; st++) {
+        out->on_ms += e->use[st][act].on_ms;
+        out->starts += e->use[st][act].starts;
+        out->reversals += e->use[st][act].reversals;
+    }
+}
+
+static uint16_t current_ma(enum dive_actuator act, const struct app_params *p)
+{
+    switch (act) {
+    case DIVE_ACT_ROLL:  return p->roll_current_ma;
+    case DIVE_ACT_PITCH: return p->pitch_current_ma;
+    case DIVE_ACT_PUMP:  return p->pump_current_ma;
+    default:             return 0;
+    }
+}
+
+float act_energy_mwh(const struct act_energy *e, enum dive_state st,
+                     enum dive_actuator act, const struct app_params *p)
+{
+    /* mA * mV * ms = 1e-9 W * 1e-3 s; 1 mWh = 3.6 J */
+    float mwh = 0.0f;
+
+    for (int s = 0; s < DIVE_ST__COUNT; s++) {
+        if (st != DIVE_ST__COUNT && s != (int)st) {
+            continue;
+        }
+        for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+            if (act != DIVE_ACT__COUNT && a != (int)act) {
+                continue;
+            }
+            float joules = (float)e->use[s][a].on_ms * (float)current_ma((enum dive_actuator)a, p) *
+                           (float)p->supply_mv * 1e-9f;
+            mwh += joules / 3.6f;
+        }
+    }
+    return mwh;
+}
+
+void act_energy_summarize(const struct act_energy *e, const struct app_params *p,
+                          struct dive_summary *out)
+{
+    struct act_usage u;
+
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        act_energy_total(e, (enum dive_actuator)a, &u);
+        out->act_on_ds[a] = (uint16_t)MIN((u.on_ms + 50U) / 100U, 65535U);
+        out->act_starts[a] = (uint8_t)MIN(u.starts, 255U);
+        out->act_reversals[a] = (uint8_t)MIN(u.reversals, 255U);
+    }
+    float mwh = act_energy_mwh(e, DIVE_ST__COUNT, DIVE_ACT__COUNT, p) + 0.5f;
+    out->energy_mwh = (mwh > 65535.0f) ? 65535U : (uint16_t)mwh;
+}
@@ -0,0 +1,328 @@
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <string.h>
+
+#include "act_sched.h"
+#include "actuator_wq.h"
+#include "app_params.h"
+#include "app_print.h"
+#include "hw_motors.h"
+#include "hw_pump.h"
+
+enum slot_state { SLOT_FREE, SLOT_WAITING, SLOT_RUNNING };
+
+struct act_slot {
+    enum slot_state state;
+    struct act_move mv;
+    int64_t submit_ms;
+    int64_t start_ms;
+    uint32_t cuts;                 /* motor_cut_count() when it started */
+};
+
+/* A finished move, reported once sched_lock is released */
+struct act_done {
+    struct act_move mv;
+    int result;
+    uint32_t total_ms;
+    uint32_t wait_ms;
+};
+
+/* Each slot can finish twice under one lock: its old move is replaced or
+ * retired, and the next one is refused as it starts */
+struct act_done_list {
+    struct act_done d[2 * DIVE_ACT__COUNT];
+    int n;
+};
+
+struct act_totals {
+    uint32_t moves;
+    uint32_t waited;               /* moves that had to wait for the budget */
+    uint64_t run_ms;
+    uint64_t wait_ms;
+    uint32_t max_wait_ms;
+};
+
+static K_MUTEX_DEFINE(sched_lock);
+static struct act_slot slots[DIVE_ACT__COUNT];
+static struct act_totals totals[DIVE_ACT__COUNT];
+
+static void sched_work_fn(struct k_work *work);
+static K_WORK_DEFINE(sched_work, sched_work_fn);
+
+static bool act_running(enum dive_actuator act)
+{
+    switch (act) {
+    case DIVE_ACT_ROLL:  return motor_is_running(MOTOR_ROLL);
+    case DIVE_ACT_PITCH: return motor_is_running(MOTOR_PITCH);
+    case DIVE_ACT_PUMP:  return pump_is_running();
+    default:             return false;
+    }
+}
+
+static uint32_t act_current_ma(enum dive_actuator act)
+{
+    const struct app_params *p = app_params_get();
+
+    switch (act) {
+    case DIVE_ACT_ROLL:  return p->roll_current_ma;
+    case DIVE_ACT_PITCH: return p->pitch_current_ma;
+    case DIVE_ACT_PUMP:  return p->pump_current_ma;
+    default:             return 0;
+    }
+}
+
+/* Limit switch cuts seen on the actuator, see motor_cut() */
+static uint32_t act_cuts(enum dive_actuator act)
+{
+    switch (act) {
+    case DIVE_ACT_ROLL:  return motor_cut_count(MOTOR_ROLL);
+    case DIVE_ACT_PITCH: return motor_cut_count(MOTOR_PITCH);
+    default:             return 0;
+    }
+}
+
+static void act_issue(const struct act_move *mv)
+{
+    switch (mv->act) {
+    case DIVE_ACT_ROLL:  motor_cmd_ms(MOTOR_ROLL, mv->dir, mv->duration_ms); break;
+    case DIVE_ACT_PITCH: motor_cmd_ms(MOTOR_PITCH, mv->dir, mv->duration_ms); break;
+    case DIVE_ACT_PUMP:  pump_cmd_ms(mv->dir, mv->duration_ms); break;
+    default:             break;
+    }
+}
+
+/* Free the slot and queue its report; lock held */
+static void slot_complete(struct act_slot *sl, int result, int64_t now,
+                          struct act_done_list *done)
+{
+    enum dive_actuator act = sl->mv.act;
+    uint32_t wait_ms = (uint32_t)(((sl->state == SLOT_RUNNING) ? sl->start_ms : now) - sl->submit_ms);
+    struct act_totals *t = &totals[act];
+
+    if (sl->state == SLOT_RUNNING) {
+        t->run_ms += (uint64_t)(now - sl->start_ms);
+    }
+    t->moves++;
+    t->wait_ms += wait_ms;
+    if (wait_ms > 0) {
+        t->waited++;
+    }
+    if (wait_ms > t->max_wait_ms) {
+        t->max_wait_ms = wait_ms;
+    }
+    sl->state = SLOT_FREE;
+
+    if (done->n < (int)ARRAY_SIZE(done->d)) {
+        struct act_done *d = &done->d[done->n++];
+        d->mv = sl->mv;
+        d->result = result;
+        d->total_ms = (uint32_t)(now - sl->submit_ms);
+        d->wait_ms = wait_ms;
+    }
+}
+
+/* Log and signal the moves finished under the lock; lock released, so
+ * callbacks may submit or cancel moves */
+static void report_done(const struct act_done_list *done)
+{
+    for (int i = 0; i < done->n; i++) {
+        const struct act_done *d = &done->d[i];
+        const struct act_move *mv = &d->mv;
+
+        if (d->result != 0 || d->wait_ms > 0) {
+            app_printk("[SCHED] %s %ums move %s in %ums (waited %ums)\r\n",
+                       dive_actuator_name(mv->act), mv->duration_ms,
+                       (d->result == 0) ? "done" : (d->result == -ECANCELED) ? "cancelled" : "failed",
+                       d->total_ms, d->wait_ms);
+        }
+        if (mv->signal) {
+            k_poll_signal_raise(mv->signal, d->result);
+        }
+        if (mv->cb) {
+            mv->cb(mv->act, d->result, d->total_ms, mv->user);
+        }
+    }
+}
+
+/* A running move whose actuator has stopped; -EIO if a limit switch cut
+ * it. Lock held. */
+static void slot_retire(struct act_slot *sl, int64_t now, struct act_done_list *done)
+{
+    bool cut = (act_cuts(sl->mv.act) != sl->cuts);
+
+    slot_complete(sl, cut ? -EIO : 0, now, done);
+}
+
+/* Current of everything running or about to; lock held */
+static uint32_t current_in_use(void)
+{
+    uint32_t ma = 0;
+
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        if (slots[a].state == SLOT_RUNNING || act_running((enum dive_actuator)a)) {
+            ma += act_current_ma((enum dive_actuator)a);
+        }
+    }
+    return ma;
+}
+
+static void slot_start(struct act_slot *sl, int64_t now, struct act_done_list *done)
+{
+    sl->state = SLOT_RUNNING;
+    sl->start_ms = now;
+    sl->cuts = act_cuts(sl->mv.act);
+    act_issue(&sl->mv);
+    if (!act_running(sl->mv.act)) {
+        slot_complete(sl, -EIO, now, done);
+    }
+}
+
+/* Start waiting moves while the budget allows, highest priority first;
+ * a move that does not fit holds back everything below it. Lock held. */
+static void sched_dispatch(struct act_done_list *done)
+{
+    uint32_t budget = app_params_get()->current_budget_ma;
+
+    for (;;) {
+        struct act_slot *best = NULL;
+
+        for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+            struct act_slot *sl = &slots[a];
+            if (sl->state != SLOT_WAITING) {
+                continue;
+            }
+            if (!best || sl->mv.prio > best->mv.prio ||
+                (sl->mv.prio == best->mv.prio && sl->submit_ms < best->submit_ms)) {
+                best = sl;
+            }
+        }
+        if (!best) {
+            return;
+        }
+        uint32_t used = current_in_use();
+        if (budget != 0 && used != 0 && used + act_current_ma(best->mv.act) > budget) {
+            return;
+        }
+        slot_start(best, k_uptime_get(), done);
+    }
+}
+
+/* System work queue: retire stopped moves, then start waiting ones */
+static void sched_work_fn(struct k_work *work)
+{
+    struct act_done_list done = { .n = 0 };
+
+    ARG_UNUSED(work);
+    k_mutex_lock(&sched_lock, K_FOREVER);
+    int64_t now = k_uptime_get();
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        if (slots[a].state == SLOT_RUNNING && !act_running((enum dive_actuator)a)) {
+            slot_retire(&slots[a], now, &done);
+        }
+    }
+    sched_dispatch(&done);
+    k_mutex_unlock(&sched_lock);
+    report_done(&done);
+}
+
+/* Any context, after any actuator stop */
+static void sched_stop_hook(enum dive_actuator act)
+{
+    ARG_UNUSED(act);
+    (void)k_work_submit(&sched_work);
+}
+
+int act_sched_init(void)
+{
+    actuator_wq_set_stop_hook(sched_stop_hook);
+    return 0;
+}
+
+int act_sched_submit(const struct act_move *mv)
+{
+    struct act_done_list done = { .n = 0 };
+
+    if ((unsigned)mv->act >= DIVE_ACT__COUNT || mv->dir == 0 || mv->duration_ms == 0) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&sched_lock, K_FOREVER);
+    struct act_slot *sl = &slots[mv->act];
+    int64_t now = k_uptime_get();
+    /* Stopped but not yet retired by the work item */
+    if (sl->state == SLOT_RUNNING && !act_running(mv->act)) {
+        slot_retire(sl, now, &done);
+    }
+    bool was_running = (sl->state == SLOT_RUNNING);
+
+    if (sl->state != SLOT_FREE) {
+        slot_complete(sl, -ECANCELED, now, &done);
+    }
+    sl->mv = *mv;
+    sl->submit_ms = now;
+    sl->state = SLOT_WAITING;
+    if (was_running || act_running(mv->act)) {
+        /* Replaces a run in progress: no extra current */
+        slot_start(sl, now, &done);
+    } else {
+        sched_dispatch(&done);
+    }
+    k_mutex_unlock(&sched_lock);
+    report_done(&done);
+    return 0;
+}
+
+void act_sched_cancel(uint32_t act_mask)
+{
+    struct act_done_list done = { .n = 0 };
+
+    k_mutex_lock(&sched_lock, K_FOREVER);
+    int64_t now = k_uptime_get();
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        struct act_slot *sl = &slots[a];
+        if (!(act_mask & ACT_MASK(a)) || sl->state == SLOT_FREE) {
+            continue;
+        }
+        if (sl->state == SLOT_RUNNING) {
+            if (a == DIVE_ACT_PUMP) {
+                pump_stop();
+            } else {
+                motor_stop((a == DIVE_ACT_ROLL) ? MOTOR_ROLL : MOTOR_PITCH);
+            }
+        }
+        slot_complete(sl, -ECANCELED, now, &done);
+    }
+    sched_dispatch(&done);
+    k_mutex_unlock(&sched_lock);
+    report_done(&done);
+}
+
+bool act_sched_idle(uint32_t act_mask)
+{
+    bool idle = true;
+
+    k_mutex_lock(&sched_lock, K_FOREVER);
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        if ((act_mask & ACT_MASK(a)) && slots[a].state != SLOT_FREE) {
+            idle = false;
+        }
+    }
+    k_mutex_unlock(&sched_lock);
+    return idle;
+}
+
+void act_sched_print_stats(void)
+{
+    struct act_totals t[DIVE_ACT__COUNT];
+
+    k_mutex_lock(&sched_lock, K_FOREVER);
+    memcpy(t, totals, sizeof(t));
+    k_mutex_unlock(&sched_lock);
+
+    app_printk("\r\n[SCHED] budget %umA\r\n", app_params_get()->current_budget_ma);
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        app_printk("[SCHED] %-5s moves=%u run=%.1fs waited=%u (%.1fs, max %ums)\r\n",
+                   dive_actuator_name((enum dive_actuator)a), t[a].moves,
+                   t[a].run_ms / 1000.0, t[a].waited, t[a].wait_ms / 1000.0, t[a].max_wait_ms);
+    }
+}
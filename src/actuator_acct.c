@@ -0,0 +1,116 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "actuator_acct.h"
+#include "app_print.h"
+
+static struct k_spinlock acct_lock;
+static struct act_energy g_energy;
+static enum dive_state g_state = DIVE_ST_SURFACE_TRIM;
+static bool g_running[DIVE_ACT__COUNT];
+static int64_t g_run_start_ms[DIVE_ACT__COUNT];
+
+/* Charge an open run up to now and restart its interval; lock held */
+static void charge_open(struct act_energy *e, enum dive_actuator act, int64_t now)
+{
+    if (g_running[act]) {
+        act_energy_charge(e, g_state, act, (uint32_t)(now - g_run_start_ms[act]));
+        g_run_start_ms[act] = now;
+    }
+}
+
+void actuator_acct_on(enum dive_actuator act, int dir)
+{
+    if ((unsigned)act >= DIVE_ACT__COUNT || dir == 0) {
+        return;
+    }
+    k_spinlock_key_t key = k_spin_lock(&acct_lock);
+    int64_t now = k_uptime_get();
+
+    charge_open(&g_energy, act, now);
+    act_energy_start(&g_energy, g_state, act, dir);
+    g_running[act] = true;
+    g_run_start_ms[act] = now;
+    k_spin_unlock(&acct_lock, key);
+}
+
+void actuator_acct_off(enum dive_actuator act)
+{
+    if ((unsigned)act >= DIVE_ACT__COUNT) {
+        return;
+    }
+    k_spinlock_key_t key = k_spin_lock(&acct_lock);
+
+    charge_open(&g_energy, act, k_uptime_get());
+    g_running[act] = false;
+    k_spin_unlock(&acct_lock, key);
+}
+
+void actuator_acct_set_state(enum dive_state st)
+{
+    k_spinlock_key_t key = k_spin_lock(&acct_lock);
+    int64_t now = k_uptime_get();
+
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        charge_open(&g_energy, (enum dive_actuator)a, now);
+    }
+    g_state = st;
+    k_spin_unlock(&acct_lock, key);
+}
+
+void actuator_acct_begin_cycle(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&acct_lock);
+    int64_t now = k_uptime_get();
+
+    /* Runs in progress carry over into the new cycle from now */
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        if (g_running[a]) {
+            g_run_start_ms[a] = now;
+        }
+    }
+    act_energy_reset(&g_energy);
+    k_spin_unlock(&acct_lock, key);
+}
+
+void actuator_acct_snapshot(struct act_energy *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&acct_lock);
+    int64_t now = k_uptime_get();
+
+    *out = g_energy;
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        if (g_running[a]) {
+            act_energy_charge(out, g_state, (enum dive_actuator)a,
+                              (uint32_t)(now - g_run_start_ms[a]));
+        }
+    }
+    k_spin_unlock(&acct_lock, key);
+}
+
+void actuator_acct_print(const struct app_params *p)
+{
+    struct act_energy e;
+    struct act_usage u;
+
+    actuator_acct_snapshot(&e);
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        act_energy_total(&e, (enum dive_actuator)a, &u);
+        app_printk("[ENERGY] %-5s on=%.1fs starts=%u reversals=%u %.1fmWh\r\n",
+                   dive_actuator_name((enum dive_actuator)a), u.on_ms / 1000.0,
+                   u.starts, u.reversals,
+                   act_energy_mwh(&e, DIVE_ST__COUNT, (enum dive_actuator)a, p));
+    }
+    for (int st = 0; st < DIVE_ST__COUNT; st++) {
+        float mwh = act_energy_mwh(&e, (enum dive_state)st, DIVE_ACT__COUNT, p);
+        if (mwh > 0.0f) {
+            app_printk("[ENERGY] %-12s roll=%.1fs pitch=%.1fs pump=%.1fs %.1fmWh\r\n",
+                       dive_state_name((enum dive_state)st),
+                       e.use[st][DIVE_ACT_ROLL].on_ms / 1000.0,
+                       e.use[st][DIVE_ACT_PITCH].on_ms / 1000.0,
+                       e.use[st][DIVE_ACT_PUMP].on_ms / 1000.0, mwh);
+        }
+    }
+    app_printk("[ENERGY] cycle total %.1fmWh\r\n",
+               act_energy_mwh(&e, DIVE_ST__COUNT, DIVE_ACT__COUNT, p));
+}
@@ -0,0 +1,135 @@
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "actuator_wq.h"
+#include "dive_stats.h"
+#include "app_print.h"
+
+#define ACT_WQ_STACK_SIZE 1024
+#define ACT_WQ_PRIO       K_PRIO_COOP(2)
+#define ACT_LOG_DEPTH     16
+
+static K_THREAD_STACK_DEFINE(act_wq_stack, ACT_WQ_STACK_SIZE);
+static struct k_work_q act_wq;
+
+/* One deferred stop log line */
+struct act_stop_msg {
+    uint8_t act;
+    uint32_t requested_ms;
+    uint32_t actual_us;
+};
+K_MSGQ_DEFINE(act_log_q, sizeof(struct act_stop_msg), ACT_LOG_DEPTH, 4);
+
+static void act_log_work_fn(struct k_work *work);
+static K_WORK_DEFINE(act_log_work, act_log_work_fn);
+
+/* Lateness (actual - requested) of timed stops, microseconds */
+static struct k_spinlock timing_lock;
+static struct dive_stat late_us[DIVE_ACT__COUNT];
+static atomic_t log_dropped;
+static actuator_stop_hook_t stop_hook;
+
+static const char *const act_tags[DIVE_ACT__COUNT] = {
+    [DIVE_ACT_ROLL]  = "[ROLL]",
+    [DIVE_ACT_PITCH] = "[PITCH]",
+    [DIVE_ACT_PUMP]  = "[PUMP]",
+};
+
+int actuator_wq_init(void)
+{
+    struct k_work_queue_config cfg = { .name = "actuator_wq" };
+
+    k_work_queue_start(&act_wq, act_wq_stack, K_THREAD_STACK_SIZEOF(act_wq_stack),
+                       ACT_WQ_PRIO, &cfg);
+    actuator_wq_reset_timing();
+    return 0;
+}
+
+struct k_work_q *actuator_wq(void)
+{
+    return &act_wq;
+}
+
+void actuator_wq_stopped(enum dive_actuator act, uint32_t requested_ms, uint32_t actual_us)
+{
+    struct act_stop_msg msg = {
+        .act = (uint8_t)act,
+        .requested_ms = requested_ms,
+        .actual_us = actual_us,
+    };
+
+    if (requested_ms != 0) {
+        k_spinlock_key_t key = k_spin_lock(&timing_lock);
+        dive_stat_add(&late_us[act], (float)actual_us - (float)requested_ms * 1000.0f);
+        k_spin_unlock(&timing_lock, key);
+    }
+    if (k_msgq_put(&act_log_q, &msg, K_NO_WAIT) != 0) {
+        atomic_inc(&log_dropped);
+    }
+    (void)k_work_submit(&act_log_work);
+    actuator_wq_notify_stop(act);
+}
+
+void actuator_wq_notify_stop(enum dive_actuator act)
+{
+    actuator_stop_hook_t hook = stop_hook;
+
+    if (hook) {
+        hook(act);
+    }
+}
+
+void actuator_wq_set_stop_hook(actuator_stop_hook_t hook)
+{
+    stop_hook = hook;
+}
+
+/* System work queue: print what the stop handlers queued */
+static void act_log_work_fn(struct k_work *work)
+{
+    struct act_stop_msg msg;
+
+    ARG_UNUSED(work);
+    while (k_msgq_get(&act_log_q, &msg, K_NO_WAIT) == 0) {
+        if (msg.requested_ms != 0) {
+            app_printk("%s timed stop after %uus (requested %ums, %+dus)\r\n",
+                       act_tags[msg.act], msg.actual_us, msg.requested_ms,
+                       (int)(msg.actual_us - msg.requested_ms * 1000U));
+        } else {
+            app_printk("%s stopped after %uus\r\n", act_tags[msg.act], msg.actual_us);
+        }
+    }
+    atomic_val_t dropped = atomic_clear(&log_dropped);
+    if (dropped != 0) {
+        app_printk("[ACT] %u stop log lines dropped\r\n", (unsigned)dropped);
+    }
+}
+
+void actuator_wq_print_timing(void)
+{
+    struct dive_stat st[DIVE_ACT__COUNT];
+
+    k_spinlock_key_t key = k_spin_lock(&timing_lock);
+    memcpy(st, late_us, sizeof(st));
+    k_spin_unlock(&timing_lock, key);
+
+    app_printk("\r\n[ACT] timed stop lateness (actual - requested on-time):\r\n");
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        if (st[a].n == 0) {
+            app_printk("[ACT] %-5s no timed stops\r\n", dive_actuator_name((enum dive_actuator)a));
+            continue;
+        }
+        app_printk("[ACT] %-5s n=%u mean %+.0fus sd %.0fus min %+.0fus max %+.0fus\r\n",
+                   dive_actuator_name((enum dive_actuator)a), st[a].n, (double)st[a].mean,
+                   (double)dive_stat_sd(&st[a]), (double)st[a].min, (double)st[a].max);
+    }
+}
+
+void actuator_wq_reset_timing(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&timing_lock);
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        dive_stat_reset(&late_us[a]);
+    }
+    k_spin_unlock(&timing_lock, key);
+}
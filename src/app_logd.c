@@ -0,0 +1,228 @@
+/* app_logd.c - deferred logging: record ring and formatter thread
+ *
+ * While log_deferred is set, text that was already formatted (app_printk()
+ * and the rest of app_print_write()) goes through the same ring as the
+ * records, so the console shows everything in call order: a state change
+ * never overtakes the [SENS] line that caused it. Ring entries are
+ *
+ *   <len 1..LOGD_REC_MAX> <record>
+ *   LOGD_TEXT_TAG <level> <sink mask> <len lo> <len hi> <text>
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <stdio.h>
+
+#include "app_logd.h"
+#include "app_params.h"
+
+#define LOGD_RING_SIZE  2048
+#define LOGD_TEXT_MAX   256
+#define LOGD_STACK_SIZE 2048
+#define LOGD_PRIO       12      /* below the console drains */
+#define LOGD_TEXT_TAG   0xFF    /* above any record length */
+#define LOGD_TEXT_HDR   5
+#define LOGD_TEXT_WAIT_MS 1000  /* as app_print.c gives UART0 */
+
+BUILD_ASSERT(LOGD_REC_MAX < LOGD_TEXT_TAG);
+
+RING_BUF_DECLARE(logd_ring, LOGD_RING_SIZE);
+static struct k_spinlock lock;
+static K_SEM_DEFINE(logd_data, 0, 1);
+static K_SEM_DEFINE(logd_room, 0, 1);
+
+/* Under lock */
+static uint32_t ring_max;
+static uint32_t records;
+static uint32_t texts;
+static uint32_t dropped;
+static uint64_t submit_cyc;
+
+/* Formatter thread only */
+static uint32_t formatted;
+static uint64_t format_cyc;
+
+enum app_logd_mode app_logd_mode(enum logd_id id)
+{
+    if (!app_print_wants((enum app_log_level)logd_dict[id].level, APP_SINK_ALL)) {
+        return APP_LOGD_SKIP;
+    }
+    return (app_params_get()->log_deferred == 0) ? APP_LOGD_NOW : APP_LOGD_DEFER;
+}
+
+/* Put hdr and body as one entry if there is room; lock held */
+static bool ring_put_entry(const uint8_t *hdr, uint32_t hdr_len, const void *body,
+                           uint32_t body_len)
+{
+    uint32_t space = ring_buf_space_get(&logd_ring);
+    if (space < hdr_len + body_len) {
+        return false;
+    }
+    (void)ring_buf_put(&logd_ring, hdr, hdr_len);
+    (void)ring_buf_put(&logd_ring, body, body_len);
+    uint32_t used = LOGD_RING_SIZE - space + hdr_len + body_len;
+    if (used > ring_max) {
+        ring_max = used;
+    }
+    return true;
+}
+
+void app_logd_submit(const uint8_t *rec, const struct logd_pack *pk)
+{
+    uint32_t t0 = k_cycle_get_32();
+    uint8_t len = (uint8_t)(pk->p - rec);
+    bool queued = false;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (!pk->full && ring_put_entry(&len, 1, rec, len)) {
+        records++;
+        queued = true;
+    } else {
+        dropped++;
+    }
+    submit_cyc += k_cycle_get_32() - t0;
+    k_spin_unlock(&lock, key);
+    if (queued) {
+        k_sem_give(&logd_data);
+    }
+}
+
+bool app_logd_text(enum app_log_level lvl, unsigned int mask, const char *buf, size_t len)
+{
+    if (app_params_get()->log_deferred == 0 || len > LOGD_RING_SIZE - LOGD_TEXT_HDR) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+    const uint8_t hdr[LOGD_TEXT_HDR] = {
+        LOGD_TEXT_TAG, (uint8_t)lvl, (uint8_t)mask, (uint8_t)len, (uint8_t)(len >> 8),
+    };
+    bool may_wait = !k_is_in_isr();
+    int64_t deadline = 0;
+
+    for (;;) {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        bool queued = ring_put_entry(hdr, sizeof(hdr), buf, (uint32_t)len);
+        if (queued) {
+            texts++;
+        }
+        k_spin_unlock(&lock, key);
+        if (queued) {
+            k_sem_give(&logd_data);
+            return true;
+        }
+        int64_t now = k_uptime_get();
+        if (deadline == 0) {
+            deadline = now + LOGD_TEXT_WAIT_MS;
+        }
+        if (!may_wait || now >= deadline) {
+            break;
+        }
+        (void)k_sem_take(&logd_room, K_MSEC(10));
+    }
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    dropped++;
+    k_spin_unlock(&lock, key);
+    return true;
+}
+
+/* Next entry from the ring into buf; its length, 0 when empty. A text
+ * entry comes back without its header, with *is_text set. */
+static size_t next_entry(uint8_t *buf, size_t max, bool *is_text, uint8_t *lvl, uint8_t *mask)
+{
+    uint8_t hdr[LOGD_TEXT_HDR];
+    size_t len = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (ring_buf_get(&logd_ring, hdr, 1) == 1) {
+        *is_text = (hdr[0] == LOGD_TEXT_TAG);
+        if (*is_text) {
+            (void)ring_buf_get(&logd_ring, hdr + 1, LOGD_TEXT_HDR - 1);
+            *lvl = hdr[1];
+            *mask = hdr[2];
+            len = hdr[3] | ((size_t)hdr[4] << 8);
+        } else {
+            len = hdr[0];
+        }
+        /* Entries are never larger than the buffers they were put from */
+        (void)ring_buf_get(&logd_ring, buf, (uint32_t)MIN(len, max));
+    }
+    k_spin_unlock(&lock, key);
+    return len;
+}
+
+/* Raw line to UART0 (log_deferred=2) and text to the sinks that want it */
+static void emit(const uint8_t *rec, size_t len, bool *stamped)
+{
+    static char text[LOGD_TEXT_MAX];
+    enum app_log_level lvl = (enum app_log_level)logd_dict[rec[0]].level;
+    unsigned int text_mask = APP_SINK_ALL;
+
+    if (app_params_get()->log_deferred == 2) {
+        if (app_print_wants(lvl, APP_SINK_UART0)) {
+            if (!*stamped) {
+                /* Names the dictionary tools/logd_decode must have */
+                int n = snprintf(text, sizeof(text), "[LOGD] dict %u %08x\r\n",
+                                 (unsigned)LOGD__COUNT, (unsigned)logd_dict_crc());
+                app_print_sinks(APP_LVL_ERR, APP_SINK_UART0, text, (size_t)n);
+                *stamped = true;
+            }
+            size_t n = logd_line_encode(rec, len, text, sizeof(text));
+            app_print_sinks(lvl, APP_SINK_UART0, text, n);
+        }
+        text_mask &= ~APP_SINK_UART0;
+    } else {
+        *stamped = false;
+    }
+
+    if (app_print_wants(lvl, text_mask)) {
+        uint32_t t0 = k_cycle_get_32();
+        int n = logd_format(rec, len, text, sizeof(text));
+        format_cyc += k_cycle_get_32() - t0;
+        formatted++;
+        if (n > 0) {
+            app_print_sinks(lvl, text_mask, text, (size_t)n);
+        }
+    }
+}
+
+static void logd_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+    static uint8_t buf[LOGD_RING_SIZE];
+    bool stamped = false;
+
+    while (1) {
+        (void)k_sem_take(&logd_data, K_FOREVER);
+        size_t len;
+        bool is_text;
+        uint8_t lvl, mask;
+        while ((len = next_entry(buf, sizeof(buf), &is_text, &lvl, &mask)) > 0) {
+            k_sem_give(&logd_room);
+            if (is_text) {
+                app_print_sinks((enum app_log_level)lvl, mask, (const char *)buf, len);
+            } else {
+                emit(buf, len, &stamped);
+            }
+        }
+    }
+}
+
+K_THREAD_DEFINE(logd_tx, LOGD_STACK_SIZE, logd_thread, NULL, NULL, NULL, LOGD_PRIO, 0, 0);
+
+void app_logd_print_stats(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint32_t n = records, t = texts, drop = dropped, max = ring_max;
+    uint64_t sub = submit_cyc;
+    k_spin_unlock(&lock, key);
+
+    app_printk("[LOGD] mode %u, dict %u formats %08x: %u records, %u text, %u dropped, "
+               "ring max %u/%u\r\n",
+               app_params_get()->log_deferred, (unsigned)LOGD__COUNT, (unsigned)logd_dict_crc(),
+               n, t, drop, max, (unsigned)LOGD_RING_SIZE);
+    app_printk("[LOGD] queue mean %uns per call, background format mean %uus (%u)\r\n",
+               n ? (uint32_t)(k_cyc_to_ns_floor64(sub) / n) : 0U,
+               formatted ? (uint32_t)(k_cyc_to_us_floor64(format_cyc) / formatted) : 0U,
+               formatted);
+}
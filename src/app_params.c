@@ -8,10 +8,46 @@
 #include "app_params.h"
 #include "app_print.h"
 
-#define APP_PARAMS_SETTINGS_KEY "params/blob"
+#define APP_PARAMS_SETTINGS_KEY "params/v2"
+#define APP_PARAMS_LEGACY_KEY   "params/blob"
 
 static struct app_params g_params;
 
+/* Stored form. data_len is how much of struct app_params the writer had,
+ * up to the end of its last field; anything past it keeps the defaults,
+ * including new fields that landed in what used to be trailing padding. */
+#define PARAMS_BLOB_VERSION 1
+
+struct params_blob {
+    uint16_t version;
+    uint16_t data_len;
+    struct app_params params;
+};
+
+static struct params_blob g_blob;      /* staging for load and save */
+static bool loaded_v2;                 /* a versioned blob beats the legacy one */
+
+/* Unversioned "params/blob" records were the bare struct, trailing padding
+ * included. Their size tells the layout; the shorter one wins a tie. */
+static const struct {
+    uint16_t size;
+    uint16_t data_len;
+} legacy_layouts[] = {
+    { 32, 30 },  { 44, 44 },  { 48, 46 },  { 52, 52 },  { 64, 62 },
+    { 72, 70 },  { 76, 76 },  { 88, 88 },  { 100, 98 }, { 112, 112 },
+    { 116, 114 }, { 132, 132 }, { 136, 136 }, { 144, 142 },
+};
+
+static size_t legacy_data_len(size_t size)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(legacy_layouts); i++) {
+        if (legacy_layouts[i].size == size) {
+            return legacy_layouts[i].data_len;
+        }
+    }
+    return 0;
+}
+
 /* Raw flash persistence (64KB storage partition at 0x1E0000) */
 #define PARAMS_FLASH_OFFSET 0x001E0000u
 #define PARAMS_FLASH_SECTOR_SIZE 4096u
@@ -25,23 +61,69 @@ struct params_flash_blob {
 
 static void app_params_set_defaults_internal(void)
 {
-    g_params.dive_depth_m        = 5.0f;
-    g_params.dive_timeout_min    = 5;
-    g_params.dive_pump_s         = 3;
-    g_params.deploy_wait_s       = 10;
-    g_params.start_pump_s        = 0;
-    g_params.climb_pump_s        = 0;
-
-    g_params.start_pitch_s       = 0;
-    g_params.surface_pitch_s     = 5;
-    g_params.dive_pitch_s        = 7;
-    g_params.climb_pitch_s       = 0;
-
-    g_params.start_roll_s        = 0;
-    g_params.max_roll_s          = 1;
-    g_params.roll_time_s         = 5;
-
-    g_params.desired_heading_deg = 180;
+    app_params_defaults(&g_params);
+}
+
+/* Copy the first data_len bytes of a stored struct over the defaults */
+static void params_apply(const struct app_params *src, size_t data_len)
+{
+    size_t ours = app_params_data_len();
+
+    if (data_len < ours) {
+        app_printk("[PARAM] older layout (%zu of %zu bytes), keeping defaults for new fields\r\n",
+                   data_len, ours);
+    } else {
+        data_len = ours;
+    }
+    app_params_defaults(&g_params);
+    memcpy(&g_params, src, data_len);
+}
+
+static int params_load_v2(size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    size_t hdr = offsetof(struct params_blob, params);
+
+    if (len < hdr || len > sizeof(g_blob)) {
+        app_printk("[PARAM] blob size %zu not supported\r\n", len);
+        return -EINVAL;
+    }
+    memset(&g_blob, 0, sizeof(g_blob));
+    int rc = read_cb(cb_arg, &g_blob, len);
+    if (rc < 0) {
+        app_printk("[PARAM] read_cb failed: %d\r\n", rc);
+        return rc;
+    }
+    if (g_blob.version != PARAMS_BLOB_VERSION || g_blob.data_len > len - hdr) {
+        app_printk("[PARAM] blob version %u / length %u not supported\r\n",
+                   g_blob.version, g_blob.data_len);
+        return -EINVAL;
+    }
+    params_apply(&g_blob.params, g_blob.data_len);
+    loaded_v2 = true;
+    app_printk("[PARAM] loaded from NVM\r\n");
+    return 0;
+}
+
+static int params_load_legacy(size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    size_t data_len = legacy_data_len(len);
+
+    if (loaded_v2) {
+        return 0;
+    }
+    if (data_len == 0) {
+        app_printk("[PARAM] legacy blob size %zu unknown, ignoring\r\n", len);
+        return -EINVAL;
+    }
+    memset(&g_blob, 0, sizeof(g_blob));
+    int rc = read_cb(cb_arg, &g_blob.params, len);
+    if (rc < 0) {
+        app_printk("[PARAM] read_cb failed: %d\r\n", rc);
+        return rc;
+    }
+    params_apply(&g_blob.params, data_len);
+    app_printk("[PARAM] loaded legacy blob from NVM\r\n");
+    return 0;
 }
 
 /* settings handler: load blob from NVS into g_params */
@@ -52,32 +134,33 @@ static int app_params_settings_set(const char *key, size_t len,
 
     app_printk("[PARAM] settings_set called with key='%s', len=%zu\r\n", key, len);
 
+    if (settings_name_steq(key, "v2", &next) && !next) {
+        return params_load_v2(len, read_cb, cb_arg);
+    }
     if (settings_name_steq(key, "blob", &next) && !next) {
-        app_printk("[PARAM] blob key matched, expected size=%zu, got=%zu\r\n", 
-                   sizeof(g_params), len);
-        if (len != sizeof(g_params)) {
-            app_printk("[PARAM] size mismatch!\r\n");
-            return -EINVAL;
-        }
-        int rc = read_cb(cb_arg, &g_params, sizeof(g_params));
-        if (rc < 0) {
-            app_printk("[PARAM] read_cb failed: %d\r\n", rc);
-            return rc;
-        }
-        app_printk("[PARAM] loaded from NVM\r\n");
-        return 0;
+        return params_load_legacy(len, read_cb, cb_arg);
     }
 
-    app_printk("[PARAM] key did not match 'blob'\r\n");
+    app_printk("[PARAM] key did not match 'v2' or 'blob'\r\n");
     return -ENOENT;
 }
 
+/* Current parameters in stored form */
+static size_t params_pack(void)
+{
+    g_blob.version = PARAMS_BLOB_VERSION;
+    g_blob.data_len = (uint16_t)app_params_data_len();
+    g_blob.params = g_params;
+    return offsetof(struct params_blob, params) + g_blob.data_len;
+}
+
 /* Export handler: called by settings_save_one to write data */
 static int app_params_export(int (*cb)(const char *name,
                                        const void *value, size_t val_len))
 {
     app_printk("[PARAM] export handler called\r\n");
-    int rc = cb("blob", &g_params, sizeof(g_params));
+    size_t len = params_pack();
+    int rc = cb("v2", &g_blob, len);
     if (rc < 0) {
         app_printk("[PARAM] export cb failed: %d\r\n", rc);
     } else {
@@ -126,8 +209,9 @@ int app_params_save(void)
     int rc;
     
     /* Save parameters to NVS via settings subsystem */
-    rc = settings_save_one(APP_PARAMS_SETTINGS_KEY, &g_params, sizeof(g_params));
+    rc = settings_save_one(APP_PARAMS_SETTINGS_KEY, &g_blob, params_pack());
     if (rc == 0) {
+        (void)settings_delete(APP_PARAMS_LEGACY_KEY);
         app_printk("[PARAM] saved to NVS successfully\r\n");
     } else {
         app_printk("[PARAM] save to NVS failed: %d\r\n", rc);
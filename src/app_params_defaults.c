@@ -0,0 +1,86 @@
+/* app_params_defaults.c - compiled-in parameter defaults
+ *
+ * Kept free of Zephyr includes so host tools (tools/replay) start from the
+ * same values as the firmware.
+ */
+#include <string.h>
+
+#include "app_params.h"
+
+void app_params_defaults(struct app_params *p)
+{
+    memset(p, 0, sizeof(*p));
+
+    p->dive_depth_m        = 5.0f;
+    p->dive_timeout_min    = 5;
+    p->dive_pump_s         = 3;
+    p->deploy_wait_s       = 10;
+    p->start_pump_s        = 0;
+    p->climb_pump_s        = 0;
+
+    p->start_pitch_s       = 0;
+    p->surface_pitch_s     = 5;
+    p->dive_pitch_s        = 7;
+    p->climb_pitch_s       = 0;
+
+    p->start_roll_s        = 0;
+    p->max_roll_s          = 1;
+    p->roll_time_s         = 5;
+
+    p->desired_heading_deg = 180;
+
+    p->heading_kp          = 0.05f;
+    p->heading_ki          = 0.002f;
+    p->heading_period_s    = 2;
+    p->roll_deadband_ms    = 300;
+
+    p->inflect_lead_ms     = 4000;
+
+    p->yoyo_dives          = 1;
+    p->yoyo_min_depth_m    = 2.0f;
+
+    p->trim_timeout_s      = 30;
+    p->climb_timeout_min   = 10;
+    p->surface_dwell_s     = 5;
+    p->gps_timeout_s       = 30;
+    p->comms_window_s      = 10;
+    p->roll_current_ma     = 300;
+    p->pitch_current_ma    = 500;
+    p->pump_current_ma     = 1500;
+    p->supply_mv           = 12000;
+
+    p->abort_pump_s        = 0;
+    p->abort_pitch_s       = 0;
+    p->abort_depth_fails   = 5;
+
+    p->target_descent_mm_s = 0;
+    p->target_ascent_mm_s  = 0;
+    p->target_dive_pitch_deg  = 0;
+    p->target_climb_pitch_deg = 0;
+    p->trim_learn_max_s    = 2.0f;
+
+    p->roll_duty_pct       = 70;
+    p->pitch_duty_pct      = 100;
+    p->pump_duty_pct       = 100;
+    p->drive_min_duty_pct  = 40;
+    p->drive_ramp_ms       = 200;
+
+    p->pitch_aft_stop_s    = 0.0f;
+    p->pitch_travel_s      = 0.0f;
+    p->pitch_home_timeout_s = 60;
+    p->pitch_home_on_deploy = 0;
+
+    p->current_budget_ma   = 2000;
+
+    p->pump_out_ml_s       = 0.0f;
+    p->pump_out_loss_ml_s_bar = 0.0f;
+    p->pump_in_ml_s        = 0.0f;
+    p->pump_in_loss_ml_s_bar  = 0.0f;
+
+    p->profile_bin_m       = 1.0f;
+
+    p->log_uart0_level     = 0;
+    p->log_uart1_level     = 0;
+    p->log_net_level       = 0;
+    p->log_deferred        = 1;
+}
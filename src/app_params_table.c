@@ -0,0 +1,148 @@
+/* app_params_table.c - parameter access by name
+ *
+ * Used by the console ("name=value" in the parameters menu) and by the
+ * host tools' -s overrides. Kept free of Zephyr includes.
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_params.h"
+
+enum param_type { P_F32, P_U16, P_I16 };
+
+struct param_desc {
+    const char *name;
+    size_t off;
+    enum param_type type;
+};
+
+#define PARAM(n, t) { #n, offsetof(struct app_params, n), t }
+
+static const struct param_desc param_table[] = {
+    PARAM(dive_depth_m, P_F32),
+    PARAM(deploy_wait_s, P_U16),
+    PARAM(dive_timeout_min, P_U16),
+    PARAM(dive_pump_s, P_U16),
+    PARAM(start_pump_s, P_U16),
+    PARAM(climb_pump_s, P_U16),
+    PARAM(start_pitch_s, P_U16),
+    PARAM(surface_pitch_s, P_U16),
+    PARAM(dive_pitch_s, P_U16),
+    PARAM(climb_pitch_s, P_U16),
+    PARAM(start_roll_s, P_U16),
+    PARAM(max_roll_s, P_U16),
+    PARAM(roll_time_s, P_U16),
+    PARAM(desired_heading_deg, P_I16),
+    PARAM(heading_kp, P_F32),
+    PARAM(heading_ki, P_F32),
+    PARAM(heading_period_s, P_U16),
+    PARAM(roll_deadband_ms, P_U16),
+    PARAM(inflect_lead_ms, P_U16),
+    PARAM(yoyo_dives, P_U16),
+    PARAM(yoyo_min_depth_m, P_F32),
+    PARAM(trim_timeout_s, P_U16),
+    PARAM(climb_timeout_min, P_U16),
+    PARAM(surface_dwell_s, P_U16),
+    PARAM(gps_timeout_s, P_U16),
+    PARAM(comms_window_s, P_U16),
+    PARAM(roll_current_ma, P_U16),
+    PARAM(pitch_current_ma, P_U16),
+    PARAM(pump_current_ma, P_U16),
+    PARAM(supply_mv, P_U16),
+    PARAM(abort_pump_s, P_U16),
+    PARAM(abort_pitch_s, P_U16),
+    PARAM(abort_depth_fails, P_U16),
+    PARAM(target_descent_mm_s, P_U16),
+    PARAM(target_ascent_mm_s, P_U16),
+    PARAM(target_dive_pitch_deg, P_U16),
+    PARAM(target_climb_pitch_deg, P_U16),
+    PARAM(trim_learn_max_s, P_F32),
+    PARAM(roll_duty_pct, P_U16),
+    PARAM(pitch_duty_pct, P_U16),
+    PARAM(pump_duty_pct, P_U16),
+    PARAM(drive_min_duty_pct, P_U16),
+    PARAM(drive_ramp_ms, P_U16),
+    PARAM(pitch_aft_stop_s, P_F32),
+    PARAM(pitch_travel_s, P_F32),
+    PARAM(pitch_home_timeout_s, P_U16),
+    PARAM(pitch_home_on_deploy, P_U16),
+    PARAM(current_budget_ma, P_U16),
+    PARAM(pump_out_ml_s, P_F32),
+    PARAM(pump_out_loss_ml_s_bar, P_F32),
+    PARAM(pump_in_ml_s, P_F32),
+    PARAM(pump_in_loss_ml_s_bar, P_F32),
+    PARAM(profile_bin_m, P_F32),
+    PARAM(log_uart0_level, P_U16),
+    PARAM(log_uart1_level, P_U16),
+    PARAM(log_net_level, P_U16),
+    PARAM(log_deferred, P_U16),
+};
+
+#define PARAM_COUNT (sizeof(param_table) / sizeof(param_table[0]))
+
+static size_t param_size(enum param_type t)
+{
+    return (t == P_F32) ? sizeof(float) : sizeof(uint16_t);
+}
+
+size_t app_params_data_len(void)
+{
+    size_t end = 0;
+
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        size_t e = param_table[i].off + param_size(param_table[i].type);
+        if (e > end) {
+            end = e;
+        }
+    }
+    return end;
+}
+
+int app_params_set_named(struct app_params *p, const char *name, size_t name_len,
+                         const char *value)
+{
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        const struct param_desc *d = &param_table[i];
+        if (strlen(d->name) != name_len || strncmp(d->name, name, name_len) != 0) {
+            continue;
+        }
+        char *end = NULL;
+        double v = strtod(value, &end);
+        if (end == value || *end != '\0') {
+            return -EINVAL;
+        }
+        char *base = (char *)p + d->off;
+        switch (d->type) {
+        case P_F32:
+            *(float *)base = (float)v;
+            break;
+        case P_U16:
+            if (v < 0.0 || v > 65535.0) return -EINVAL;
+            *(uint16_t *)base = (uint16_t)v;
+            break;
+        case P_I16:
+            if (v < -32768.0 || v > 32767.0) return -EINVAL;
+            *(int16_t *)base = (int16_t)v;
+            break;
+        }
+        return 0;
+    }
+    return -ENOENT;
+}
+
+int app_params_format_named(const struct app_params *p, unsigned int i, char *buf, size_t len)
+{
+    if (i >= PARAM_COUNT) {
+        return -1;
+    }
+    const struct param_desc *d = &param_table[i];
+    const char *base = (const char *)p + d->off;
+    switch (d->type) {
+    case P_F32: return snprintf(buf, len, "%s=%g", d->name, (double)*(const float *)base);
+    case P_U16: return snprintf(buf, len, "%s=%u", d->name, *(const uint16_t *)base);
+    case P_I16: return snprintf(buf, len, "%s=%d", d->name, *(const int16_t *)base);
+    }
+    return -1;
+}
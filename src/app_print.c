@@ -1,81 +1,347 @@
+/* app_print.c - application console output
+ *
+ * Each message is formatted once, into a buffer from a small pool, and
+ * copied into a byte ring per sink. UART0 (console / OpenLog) and UART1
+ * are drained by their own low-priority threads; the net console already
+ * queues to its sender thread. A 9600 baud UART therefore never holds up
+ * the other sinks, and the caller pays for one format and a few copies.
+ *
+ * A full ring drops the message for that sink only. UART0 carries the
+ * operator menus and the OpenLog record, so it waits up to
+ * APP_PRINT_UART0_WAIT_MS for room first, as the old synchronous printk
+ * did.
+ */
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
+#include <zephyr/sys/cbprintf.h>
+#include <zephyr/sys/ring_buffer.h>
 #include <zephyr/drivers/uart.h>
 #include <zephyr/device.h>
 #include <zephyr/init.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdbool.h>
+#include "app_params.h"
+#include "app_logd.h"
 #include "net_console.h"
 
-/* Mirror only to UART1; console remains whatever Zephyr is configured to use */
+#define APP_PRINT_LINE_MAX      384     /* longest message, e.g. [STATS] */
+#define APP_PRINT_POOL_COUNT    4       /* messages being formatted at once */
+#define APP_PRINT_UART0_RING    2048
+#define APP_PRINT_UART1_RING    2048
+#define APP_PRINT_UART0_WAIT_MS 1000
+#define APP_PRINT_DRAIN_CHUNK   64
+#define APP_PRINT_SPILL_CHUNK   48      /* pool-miss pieces, on the caller's stack */
+#define APP_PRINT_DRAIN_STACK   1024
+#define APP_PRINT_DRAIN_PRIO    11      /* below the flash log writer */
+
 #if DT_NODE_HAS_STATUS(DT_NODELABEL(uart1), okay)
 static const struct device *const uart1_dev = DEVICE_DT_GET(DT_NODELABEL(uart1));
 #else
 static const struct device *const uart1_dev = NULL;
 #endif
+static const struct device *const uart0_dev = DEVICE_DT_GET_OR_NULL(DT_CHOSEN(zephyr_console));
 
-static bool uart1_ready = false;
+K_MEM_SLAB_DEFINE_STATIC(line_pool, APP_PRINT_LINE_MAX, APP_PRINT_POOL_COUNT, 4);
 
-static inline void uart1_out_ch(char c) {
-    if (!uart1_ready) return;
-    if (c == '\n') { uart_poll_out(uart1_dev, '\r'); }
-    uart_poll_out(uart1_dev, c);
-}
+struct app_sink {
+    const char *name;
+    size_t level_off;              /* its log_*_level in struct app_params */
+    /* Send len bytes; false if any were dropped. Runs on the drain thread,
+     * or inline for a sink without a ring (must not block then). */
+    bool (*write)(struct app_sink *s, const char *buf, size_t len);
+    struct ring_buf *ring;
+    struct k_sem *data;            /* ring has bytes */
+    struct k_sem *room;            /* drain made space */
+    int32_t wait_ms;               /* how long a full ring may hold up the caller */
+    const struct device *dev;
+    bool ready;
+    char last;                     /* previous byte sent, for CR/LF */
 
-static void uart1_out_buf(const char *buf, size_t len) {
+    struct k_spinlock lock;
+    uint32_t ring_max;             /* high-water mark, bytes */
+    atomic_t lines;
+    atomic_t dropped;
+};
+
+/* "\n" goes out as "\r\n" unless the message already has the CR */
+static bool uart_sink_write(struct app_sink *s, const char *buf, size_t len)
+{
     for (size_t i = 0; i < len; i++) {
-        uart1_out_ch(buf[i]);
+        if (buf[i] == '\n' && s->last != '\r') {
+            uart_poll_out(s->dev, '\r');
+        }
+        uart_poll_out(s->dev, buf[i]);
+        s->last = buf[i];
+    }
+    return true;
+}
+
+static bool net_sink_write(struct app_sink *s, const char *buf, size_t len)
+{
+    ARG_UNUSED(s);
+    return net_console_write(buf, len) == len;
+}
+
+RING_BUF_DECLARE(uart0_ring, APP_PRINT_UART0_RING);
+RING_BUF_DECLARE(uart1_ring, APP_PRINT_UART1_RING);
+static K_SEM_DEFINE(uart0_data, 0, 1);
+static K_SEM_DEFINE(uart0_room, 0, 1);
+static K_SEM_DEFINE(uart1_data, 0, 1);
+static K_SEM_DEFINE(uart1_room, 0, 1);
+
+/* Bit i of an APP_SINK_* mask */
+enum { SINK_UART0, SINK_UART1, SINK_NET, SINK__COUNT };
+
+static struct app_sink sinks[SINK__COUNT] = {
+    [SINK_UART0] = {
+        .name = "uart0", .level_off = offsetof(struct app_params, log_uart0_level),
+        .write = uart_sink_write, .ring = &uart0_ring, .data = &uart0_data,
+        .room = &uart0_room, .wait_ms = APP_PRINT_UART0_WAIT_MS,
+    },
+    [SINK_UART1] = {
+        .name = "uart1", .level_off = offsetof(struct app_params, log_uart1_level),
+        .write = uart_sink_write, .ring = &uart1_ring, .data = &uart1_data,
+        .room = &uart1_room,
+    },
+    [SINK_NET] = {
+        .name = "net", .level_off = offsetof(struct app_params, log_net_level),
+        .write = net_sink_write,
+    },
+};
+
+static atomic_t pool_misses;
+static atomic_t fmt_lines;
+static atomic_t fmt_us;
+
+static bool sink_wants(const struct app_sink *s, enum app_log_level lvl)
+{
+    const uint16_t *max = (const uint16_t *)((const char *)app_params_get() + s->level_off);
+    return s->ready && (*max == 0 || (uint16_t)lvl <= *max);
+}
+
+/* Copy a whole message into the sink's ring, or drop it */
+static void sink_put(struct app_sink *s, const char *buf, size_t len, bool may_wait)
+{
+    int64_t deadline = 0;
+
+    if (!s->ring) {
+        if (!s->write(s, buf, len)) {
+            atomic_inc(&s->dropped);
+        }
+        atomic_inc(&s->lines);
+        return;
+    }
+    for (;;) {
+        k_spinlock_key_t key = k_spin_lock(&s->lock);
+        uint32_t space = ring_buf_space_get(s->ring);
+        if (space >= len) {
+            (void)ring_buf_put(s->ring, (const uint8_t *)buf, (uint32_t)len);
+            uint32_t used = ring_buf_size_get(s->ring) - space + (uint32_t)len;
+            if (used > s->ring_max) {
+                s->ring_max = used;
+            }
+            k_spin_unlock(&s->lock, key);
+            k_sem_give(s->data);
+            atomic_inc(&s->lines);
+            return;
+        }
+        k_spin_unlock(&s->lock, key);
+        if (!may_wait || s->wait_ms == 0) {
+            break;
+        }
+        int64_t now = k_uptime_get();
+        if (deadline == 0) {
+            deadline = now + s->wait_ms;
+        } else if (now >= deadline) {
+            break;
+        }
+        (void)k_sem_take(s->room, K_MSEC(10));
+    }
+    atomic_inc(&s->dropped);
+}
+
+static void sink_drain(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p2); ARG_UNUSED(p3);
+    struct app_sink *s = p1;
+    char chunk[APP_PRINT_DRAIN_CHUNK];
+
+    while (1) {
+        (void)k_sem_take(s->data, K_FOREVER);
+        for (;;) {
+            k_spinlock_key_t key = k_spin_lock(&s->lock);
+            uint32_t n = ring_buf_get(s->ring, (uint8_t *)chunk, sizeof(chunk));
+            k_spin_unlock(&s->lock, key);
+            if (n == 0) {
+                break;
+            }
+            (void)s->write(s, chunk, n);
+            k_sem_give(s->room);
+        }
+    }
+}
+
+K_THREAD_DEFINE(uart0_tx, APP_PRINT_DRAIN_STACK, sink_drain, &sinks[SINK_UART0], NULL, NULL,
+                APP_PRINT_DRAIN_PRIO, 0, 0);
+K_THREAD_DEFINE(uart1_tx, APP_PRINT_DRAIN_STACK, sink_drain, &sinks[SINK_UART1], NULL, NULL,
+                APP_PRINT_DRAIN_PRIO, 0, 0);
+
+bool app_print_wants(enum app_log_level lvl, unsigned int mask)
+{
+    for (int i = 0; i < SINK__COUNT; i++) {
+        if ((mask & (1u << i)) && sink_wants(&sinks[i], lvl)) {
+            return true;
+        }
     }
+    return false;
 }
 
-static int vprint_mirror(const char *fmt, va_list ap) {
-    char tmp[256];
-    int n = vsnprintk(tmp, sizeof(tmp), fmt, ap);
-    if (n < 0) return n;
-    size_t to_send = (n < (int)sizeof(tmp)) ? (size_t)n : sizeof(tmp) - 1;
-    uart1_out_buf(tmp, to_send);
-    /* Also mirror to any connected net console clients */
-    net_console_write(tmp, to_send);
-    return n;
+void app_print_write(enum app_log_level lvl, unsigned int mask, const char *buf, size_t len)
+{
+    if (!app_print_wants(lvl, mask)) {
+        return;
+    }
+    /* Behind the deferred records, so the console keeps call order */
+    if (!app_logd_text(lvl, mask, buf, len)) {
+        app_print_sinks(lvl, mask, buf, len);
+    }
 }
 
-void app_vprintk(const char *fmt, va_list ap) {
-    /* Print to normal Zephyr console */
-    vprintk(fmt, ap);
-    /* Mirror to UART1 */
-    vprint_mirror(fmt, ap);
+void app_print_sinks(enum app_log_level lvl, unsigned int mask, const char *buf, size_t len)
+{
+    bool may_wait = !k_is_in_isr();
+
+    /* The waiting sink last, so it never delays the others */
+    for (int i = SINK__COUNT - 1; i >= 0; i--) {
+        if ((mask & (1u << i)) && sink_wants(&sinks[i], lvl)) {
+            sink_put(&sinks[i], buf, len, may_wait);
+        }
+    }
 }
 
-void app_printk(const char *fmt, ...) {
+/* Pool exhausted: format straight into the rings in small pieces. The
+ * message keeps its place in the queue, though a concurrent one may land
+ * between two pieces. */
+struct spill {
+    enum app_log_level lvl;
+    size_t len;
+    char buf[APP_PRINT_SPILL_CHUNK];
+};
+
+static int spill_out(int c, void *ctx)
+{
+    struct spill *sp = ctx;
+
+    sp->buf[sp->len++] = (char)c;
+    if (sp->len == sizeof(sp->buf)) {
+        app_print_write(sp->lvl, APP_SINK_ALL, sp->buf, sp->len);
+        sp->len = 0;
+    }
+    return c;
+}
+
+static void spill_vlogk(enum app_log_level lvl, const char *fmt, va_list ap)
+{
+    struct spill sp = { .lvl = lvl };
+
+    (void)cbvprintf(spill_out, &sp, fmt, ap);
+    if (sp.len > 0) {
+        app_print_write(lvl, APP_SINK_ALL, sp.buf, sp.len);
+    }
+}
+
+void app_vlogk(enum app_log_level lvl, const char *fmt, va_list ap)
+{
+    bool in_isr = k_is_in_isr();
+    char *buf;
+
+    if (!app_print_wants(lvl, APP_SINK_ALL)) {
+        return;
+    }
+    if (k_mem_slab_alloc(&line_pool, (void **)&buf, in_isr ? K_NO_WAIT : K_MSEC(10)) != 0) {
+        atomic_inc(&pool_misses);
+        spill_vlogk(lvl, fmt, ap);
+        return;
+    }
+
+    uint32_t t0 = k_cycle_get_32();
+    int n = vsnprintk(buf, APP_PRINT_LINE_MAX, fmt, ap);
+    if (n > 0) {
+        size_t len = (n < APP_PRINT_LINE_MAX) ? (size_t)n : APP_PRINT_LINE_MAX - 1;
+        app_print_write(lvl, APP_SINK_ALL, buf, len);
+    }
+    (void)atomic_add(&fmt_us, (atomic_val_t)k_cyc_to_us_floor32(k_cycle_get_32() - t0));
+    atomic_inc(&fmt_lines);
+    k_mem_slab_free(&line_pool, buf);
+}
+
+void app_logk(enum app_log_level lvl, const char *fmt, ...)
+{
     va_list ap;
     va_start(ap, fmt);
-    /* Print to console */
-    vprintk(fmt, ap);
-    /* Need a copy of va_list for second pass */
+    app_vlogk(lvl, fmt, ap);
     va_end(ap);
+}
+
+void app_vprintk(const char *fmt, va_list ap)
+{
+    app_vlogk(APP_LVL_INF, fmt, ap);
+}
+
+void app_printk(const char *fmt, ...)
+{
+    va_list ap;
     va_start(ap, fmt);
-    (void)vprint_mirror(fmt, ap);
+    app_vlogk(APP_LVL_INF, fmt, ap);
     va_end(ap);
 }
 
-int app_puts(const char *s) {
-    printk("%s\n", s);
-    size_t len = strlen(s);
-    uart1_out_buf(s, len);
-    uart1_out_ch('\n');
-    return (int)len;
+int app_puts(const char *s)
+{
+    app_printk("%s\r\n", s);
+    return (int)strlen(s);
 }
 
-int app_putchar(int c) {
-    printk("%c", (char)c);
-    uart1_out_ch((char)c);
+int app_putchar(int c)
+{
+    char ch = (char)c;
+
+    app_print_write(APP_LVL_INF, APP_SINK_ALL, &ch, 1);
     return c;
 }
 
-static int _app_print_init(void) {
-    uart1_ready = (uart1_dev && device_is_ready(uart1_dev));
+void app_print_stats(void)
+{
+    uint32_t lines = (uint32_t)atomic_get(&fmt_lines);
+    uint32_t us = (uint32_t)atomic_get(&fmt_us);
+
+    app_printk("[LOG] %u messages, format+queue mean %uus, %u pool misses\r\n",
+               lines, lines ? us / lines : 0U, (uint32_t)atomic_get(&pool_misses));
+    for (int i = 0; i < SINK__COUNT; i++) {
+        const struct app_sink *s = &sinks[i];
+        if (!s->ready) {
+            app_printk("[LOG] %-5s not present\r\n", s->name);
+        } else if (s->ring) {
+            app_printk("[LOG] %-5s %u lines, %u dropped, ring max %u/%u\r\n", s->name,
+                       (uint32_t)atomic_get(&s->lines), (uint32_t)atomic_get(&s->dropped),
+                       s->ring_max, ring_buf_size_get(s->ring));
+        } else {
+            app_printk("[LOG] %-5s %u lines, %u dropped\r\n", s->name,
+                       (uint32_t)atomic_get(&s->lines), (uint32_t)atomic_get(&s->dropped));
+        }
+    }
+}
+
+static int _app_print_init(void)
+{
     net_console_init();
+    sinks[SINK_UART0].dev = uart0_dev;
+    sinks[SINK_UART0].ready = (uart0_dev && device_is_ready(uart0_dev));
+    sinks[SINK_UART1].dev = uart1_dev;
+    sinks[SINK_UART1].ready = (uart1_dev && device_is_ready(uart1_dev));
+    sinks[SINK_NET].ready = true;
     return 0;
 }
 
@@ -0,0 +1,187 @@
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "checkpoint.h"
+#include "hw_motors.h"
+#include "hw_pump.h"
+#include "app_print.h"
+
+#define CKPT_MAGIC        0x544B4344u   /* "DCKT" */
+#define CKPT_SETTINGS_KEY "ckpt/state"
+#define CKPT_BODY_LEN     offsetof(struct checkpoint, seq)
+
+/* Retained across warm resets; validated by magic and CRC */
+static struct checkpoint ckpt_ram __noinit;
+
+static struct checkpoint ckpt_flash;    /* last copy read from / written to NVS */
+static struct checkpoint ckpt_boot;     /* what was found on boot */
+static bool boot_pending;
+static uint32_t next_seq;
+static K_MUTEX_DEFINE(ckpt_lock);
+
+static uint32_t ckpt_crc(const struct checkpoint *ck)
+{
+    return crc32_ieee((const uint8_t *)ck, offsetof(struct checkpoint, crc));
+}
+
+static bool ckpt_valid(const struct checkpoint *ck)
+{
+    return ck->magic == CKPT_MAGIC && ck->version == CHECKPOINT_VERSION &&
+           ck->crc == ckpt_crc(ck);
+}
+
+static int ckpt_settings_set(const char *key, size_t len,
+                             settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+    struct checkpoint ck;
+
+    if (!settings_name_steq(key, "state", &next) || next) {
+        return -ENOENT;
+    }
+    if (len != sizeof(ck)) {
+        app_printk("[CKPT] stored checkpoint size mismatch (%zu != %zu), ignoring\r\n",
+                   len, sizeof(ck));
+        return -EINVAL;
+    }
+    int rc = read_cb(cb_arg, &ck, len);
+    if (rc < 0) {
+        app_printk("[CKPT] read_cb failed: %d\r\n", rc);
+        return rc;
+    }
+    if (!ckpt_valid(&ck)) {
+        app_printk("[CKPT] stored checkpoint invalid, ignoring\r\n");
+        return -EINVAL;
+    }
+    ckpt_flash = ck;
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(ckpt, "ckpt", NULL, ckpt_settings_set, NULL, NULL);
+
+int checkpoint_init(void)
+{
+    const struct checkpoint *ck = NULL;
+
+    memset(&ckpt_flash, 0, sizeof(ckpt_flash));
+    int rc = settings_load_subtree("ckpt");
+    if (rc != 0 && rc != -ENOENT) {
+        app_printk("[CKPT] load failed: %d\r\n", rc);
+    }
+
+    bool ram_ok = ckpt_valid(&ckpt_ram);
+    bool flash_ok = ckpt_valid(&ckpt_flash);
+    if (ram_ok && (!flash_ok || ckpt_ram.seq >= ckpt_flash.seq)) {
+        ck = &ckpt_ram;
+    } else if (flash_ok) {
+        ck = &ckpt_flash;
+    }
+    if (!ram_ok) {
+        memset(&ckpt_ram, 0, sizeof(ckpt_ram));
+    }
+    if (ck == NULL) {
+        return 0;
+    }
+    next_seq = ck->seq + 1U;
+    if (!(ck->flags & CKPT_F_ACTIVE)) {
+        return 0;
+    }
+
+    ckpt_boot = *ck;
+    boot_pending = true;
+    motor_set_position_ms(MOTOR_ROLL, ck->pos_ms[DIVE_ACT_ROLL]);
+    motor_set_position_ms(MOTOR_PITCH, ck->pos_ms[DIVE_ACT_PITCH]);
+    pump_set_position_ms(ck->pos_ms[DIVE_ACT_PUMP]);
+    app_printk("[CKPT] interrupted deployment (%s copy): cycle %u, step %u yo %u, %s%s\r\n",
+               (ck == &ckpt_ram) ? "RAM" : "NVS", (unsigned)ck->cycle, ck->step + 1U,
+               ck->yo + 1U, dive_state_name((enum dive_state)ck->state),
+               (ck->flags & CKPT_F_ABORTED) ? " (aborting)" : "");
+    app_printk("[CKPT] restored positions: roll=%dms pitch=%dms pump=%dms\r\n",
+               (int)ck->pos_ms[DIVE_ACT_ROLL], (int)ck->pos_ms[DIVE_ACT_PITCH],
+               (int)ck->pos_ms[DIVE_ACT_PUMP]);
+    if (ck->flags & CKPT_F_FIX) {
+        app_printk("[CKPT] last fix %.6f %.6f\r\n", (double)ck->lat_e7 / 1e7,
+                   (double)ck->lon_e7 / 1e7);
+    }
+    return 0;
+}
+
+bool checkpoint_pending(void)
+{
+    return boot_pending;
+}
+
+bool checkpoint_take(struct checkpoint *out)
+{
+    k_mutex_lock(&ckpt_lock, K_FOREVER);
+    bool pending = boot_pending;
+    if (pending) {
+        *out = ckpt_boot;
+        boot_pending = false;
+    }
+    k_mutex_unlock(&ckpt_lock);
+    return pending;
+}
+
+void checkpoint_save(struct checkpoint *ck)
+{
+    k_mutex_lock(&ckpt_lock, K_FOREVER);
+    if (!(ck->flags & CKPT_F_FIX) && ckpt_valid(&ckpt_ram) && (ckpt_ram.flags & CKPT_F_FIX)) {
+        ck->flags |= CKPT_F_FIX;
+        ck->lat_e7 = ckpt_ram.lat_e7;
+        ck->lon_e7 = ckpt_ram.lon_e7;
+    }
+    ck->magic = CKPT_MAGIC;
+    ck->version = CHECKPOINT_VERSION;
+    memset(ck->reserved, 0, sizeof(ck->reserved));
+    ck->seq = next_seq++;
+    ck->crc = ckpt_crc(ck);
+    ckpt_ram = *ck;
+
+    /* The RAM copy covers resets; flash only has to follow real changes */
+    if (memcmp(ck, &ckpt_flash, CKPT_BODY_LEN) != 0) {
+        int rc = settings_save_one(CKPT_SETTINGS_KEY, ck, sizeof(*ck));
+        if (rc == 0) {
+            ckpt_flash = *ck;
+        } else {
+            app_printk("[CKPT] save to NVS failed: %d\r\n", rc);
+        }
+    }
+    k_mutex_unlock(&ckpt_lock);
+}
+
+void checkpoint_clear(void)
+{
+    k_mutex_lock(&ckpt_lock, K_FOREVER);
+    memset(&ckpt_ram, 0, sizeof(ckpt_ram));
+    memset(&ckpt_flash, 0, sizeof(ckpt_flash));
+    boot_pending = false;
+    (void)settings_delete(CKPT_SETTINGS_KEY);
+    k_mutex_unlock(&ckpt_lock);
+}
+
+enum dive_state checkpoint_resume_state(const struct checkpoint *ck)
+{
+    if (ck->flags & CKPT_F_ABORTED) {
+        return DIVE_ST_ABORT;
+    }
+    switch ((enum dive_state)ck->state) {
+    case DIVE_ST_DESCEND:
+        return DIVE_ST_DESCEND;
+    case DIVE_ST_INFLECT:
+    case DIVE_ST_ASCEND:
+        return DIVE_ST_INFLECT;
+    case DIVE_ST_SURFACE:
+    case DIVE_ST_GPS:
+    case DIVE_ST_COMMS:
+        return DIVE_ST_SURFACE;
+    case DIVE_ST_ABORT:
+        return DIVE_ST_ABORT;
+    case DIVE_ST_SURFACE_TRIM:
+    default:
+        return DIVE_ST_SURFACE_TRIM;
+    }
+}
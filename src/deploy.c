@@ -1,107 +1,242 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "app_params.h"
 #include "app_print.h"
+#include "app_logd.h"
+#include "dive_ctrl.h"
+#include "dive_stats.h"
+#include "dive_profile.h"
+#include "actuator_acct.h"
+#include "act_sched.h"
+#include "checkpoint.h"
 #include "hw_ms5837.h"
 #include "hw_bmp180.h"
 #include "hw_hmc6343.h"
 #include "hw_motors.h"
 #include "hw_pump.h"
+#include "pump_model.h"
+#include "flash_log.h"
 #include "hw_gps.h"
+#include "pitch_home.h"
+#include "mission.h"
+#include "surface_ops.h"
+#include "trim_learn.h"
 #include "net_console.h"
 
-/* Physical constants */
-#define SEA_WATER_DENSITY_KG_M3 1025.0
-#define GRAVITY_M_S2 9.80665
-
-/* Heading control constants */
-#define HEADING_CHECK_INTERVAL_SEC 10
-#define HEADING_TOLERANCE_DEG 5.0
-
 /* Flag to signal that deploy/simulate failed and should return to menu */
 static atomic_t return_to_menu_flag = ATOMIC_INIT(0);
 
-/* Helper: Calculate shortest angular distance between two headings (in degrees)
- * Returns positive for starboard (right) turn, negative for port (left) turn
- * Range: -180 to +180 */
-static float heading_delta(float current_deg, float desired_deg)
+/* Abort channel: posted by deploy_abort(), tested every control tick and
+ * waited on by every sleep of the deploy worker, so an abort takes effect
+ * within one tick */
+#define DEPLOY_EVT_ABORT BIT(0)
+#define DEPLOY_EVT_TRIM  BIT(1)   /* the last trim move has stopped */
+K_EVENT_DEFINE(deploy_evt);
+static const char *volatile abort_reason = "";
+
+void deploy_abort(const char *reason)
 {
-    float delta = desired_deg - current_deg;
-    while (delta > 180.0f) delta -= 360.0f;
-    while (delta < -180.0f) delta += 360.0f;
-    return delta;
+    abort_reason = reason;
+    k_event_post(&deploy_evt, DEPLOY_EVT_ABORT);
 }
 
-/* Helper: Determine roll direction based on phase and heading delta
- * dive_phase: true for dive, false for climb
- * heading_delta: desired - current heading
- * Returns: motor direction (+1, -1, or 0 for neutral) */
-static int roll_direction_for_phase(bool dive_phase, float hdg_delta)
+static bool abort_requested(void)
 {
-    if (hdg_delta > HEADING_TOLERANCE_DEG) {
-        /* Need to turn starboard (right) */
-        if (dive_phase) {
-            return -1;  /* Dive: bank to port (negative roll) to turn starboard */
-        } else {
-            return +1;  /* Climb: bank to starboard (positive roll) to turn starboard */
-        }
-    } else if (hdg_delta < -HEADING_TOLERANCE_DEG) {
-        /* Need to turn port (left) */
-        if (dive_phase) {
-            return +1;  /* Dive: bank to starboard (positive roll) to turn port */
-        } else {
-            return -1;  /* Climb: bank to port (negative roll) to turn port */
+    return k_event_test(&deploy_evt, DEPLOY_EVT_ABORT) != 0;
+}
+
+/* Parameter and mission edits typed while a deployment runs; the sync
+ * task applies them at the next surfacing */
+#define DEPLOY_UPDATE_LEN 96
+K_MSGQ_DEFINE(deploy_updates, DEPLOY_UPDATE_LEN, 8, 1);
+
+int deploy_queue_update(const char *line)
+{
+    char buf[DEPLOY_UPDATE_LEN];
+
+    if (strlen(line) >= sizeof(buf)) {
+        return -EINVAL;
+    }
+    strcpy(buf, line);
+    return (k_msgq_put(&deploy_updates, buf, K_NO_WAIT) == 0) ? 0 : -ENOSPC;
+}
+
+/* Sleep for ms unless an abort comes in first; true if aborted */
+static bool abortable_sleep(int64_t ms)
+{
+    if (ms <= 0) {
+        return abort_requested();
+    }
+    return k_event_wait(&deploy_evt, DEPLOY_EVT_ABORT, false, K_MSEC(ms)) != 0;
+}
+
+/* Current dead-reckoned position of an actuator (seconds) */
+static float actuator_pos_s(enum dive_actuator act)
+{
+    switch (act) {
+    case DIVE_ACT_ROLL:  return (float)motor_get_position_ms(MOTOR_ROLL) / 1000.0f;
+    case DIVE_ACT_PITCH: return (float)motor_get_position_ms(MOTOR_PITCH) / 1000.0f;
+    case DIVE_ACT_PUMP:  return (float)pump_get_position_ms() / 1000.0f;
+    default:             return 0.0f;
+    }
+}
+
+/* Trim moves (pitch and pump) still to stop, and when they were issued */
+static atomic_t trim_pending;
+static int64_t trim_start_ms;
+
+/* Where each actuator stands once its last submitted move has run (ms) */
+static int32_t cmd_target_ms[DIVE_ACT__COUNT];
+
+static void trim_move_done(enum dive_actuator act, int result, uint32_t total_ms, void *user)
+{
+    ARG_UNUSED(act); ARG_UNUSED(result); ARG_UNUSED(total_ms); ARG_UNUSED(user);
+    if (atomic_dec(&trim_pending) == 1) {
+        k_event_post(&deploy_evt, DEPLOY_EVT_TRIM);
+    }
+}
+
+/* Hand a controller command to the actuator scheduler; trim moves are
+ * counted until they stop */
+static void deploy_issue(const struct dive_cmd *cmd, enum act_prio prio, bool trim)
+{
+    struct act_move mv = {
+        .act = cmd->act,
+        .dir = cmd->dir,
+        .duration_ms = cmd->duration_ms,
+        .prio = prio,
+    };
+
+    if (trim) {
+        mv.cb = trim_move_done;
+        atomic_inc(&trim_pending);
+    }
+    if (act_sched_submit(&mv) != 0) {
+        if (trim) {
+            atomic_dec(&trim_pending);
         }
+        return;
+    }
+    cmd_target_ms[cmd->act] = (int32_t)lroundf(cmd->target_s * 1000.0f);
+}
+
+/* Move an actuator to an absolute set-point as part of a trim change */
+static void deploy_move_to(enum dive_actuator act, float target_s, enum act_prio prio)
+{
+    struct dive_cmd cmd;
+    if (dive_ctrl_move_to(act, target_s, actuator_pos_s(act), &cmd)) {
+        deploy_issue(&cmd, prio, true);
     }
-    return 0;  /* Heading within tolerance, use neutral roll */
-}
-
-/* Helper: Set roll to target position based on phase and heading
- * Returns true if roll was changed, false if already at target */
-static bool update_roll_for_heading(bool dive_phase, float current_heading, float desired_heading, struct app_params *p)
-{
-    float hdg_delta = heading_delta(current_heading, desired_heading);
-    
-    /* If heading is already within tolerance, check if we need to return to neutral */
-    if (hdg_delta <= HEADING_TOLERANCE_DEG && hdg_delta >= -HEADING_TOLERANCE_DEG) {
-        float current_roll = motor_get_position_sec(MOTOR_ROLL);
-        float neutral_roll = (float)p->start_roll_s;
-        float neutral_delta = neutral_roll - current_roll;
-        if (fabsf(neutral_delta) > 0.5f) {
-            int dir = (neutral_delta > 0) ? +1 : -1;
-            uint32_t duration = (uint32_t)(fabsf(neutral_delta) + 0.5f);
-            app_printk("[ROLL] RETURN: heading=%.1f° (within ±%.1f° tolerance), "
-                       "returning roll to neutral (%.1fs→%.1fs, duration=%us)\r\n",
-                       current_heading, HEADING_TOLERANCE_DEG, current_roll, neutral_roll, duration);
-            motor_run(MOTOR_ROLL, dir, duration);
-            return true;
+}
+
+/* Heading controller update for this sample; moves roll and logs the
+ * decision. Returns true if roll was changed */
+static bool update_roll_for_heading(struct dive_ctrl *c, const struct dive_sample *s,
+                                    struct app_params *p)
+{
+    float current_roll = actuator_pos_s(DIVE_ACT_ROLL);
+    struct dive_cmd cmd;
+
+    if (!dive_ctrl_heading(c, s, current_roll, p, &cmd)) {
+        return false;
+    }
+
+    APP_LOGD(ROLL_PI, c->dive_phase ? "dive" : "climb", s->heading_deg,
+             p->desired_heading_deg, c->heading_err_deg, c->heading_integ,
+             current_roll, cmd.target_s, cmd.duration_ms);
+    deploy_issue(&cmd, ACT_PRIO_LOW, false);
+    return true;
+}
+
+/* Read all sensors into one timestamped sample; false if depth is unknown */
+static bool deploy_read_sample(double surface_pa, bool report_errors, struct dive_sample *s)
+{
+    double temp_c = 0.0, press_kpa = 0.0;
+    bool depth_ok = true;
+
+    s->t_ms = k_uptime_get();
+    s->internal_pa = 0;
+    if (bmp180_read_pa(&s->internal_pa) != 0 && report_errors) {
+        app_printk("[DEPLOY] Internal pressure read failed\r\n");
+    }
+
+    if (ms5837_read(&temp_c, &press_kpa) != 0) {
+        depth_ok = false;
+        if (report_errors) {
+            app_printk("[DEPLOY] External pressure read failed\r\n");
         }
-        return false;  /* Already at neutral, no action needed */
-    }
-    
-    /* Heading outside tolerance - determine correction direction */
-    int roll_dir = roll_direction_for_phase(dive_phase, hdg_delta);
-    
-    float current_roll = motor_get_position_sec(MOTOR_ROLL);
-    float target_roll = (roll_dir > 0) ? (float)p->max_roll_s : -(float)p->max_roll_s;
-    float roll_delta = target_roll - current_roll;
-    
-    if (fabsf(roll_delta) > 0.5f) {
-        int dir = (roll_delta > 0) ? +1 : -1;
-        uint32_t duration = (uint32_t)(fabsf(roll_delta) + 0.5f);
-        const char *phase = (dive_phase ? "dive" : "climb");
-        app_printk("[ROLL] MOVE (%s): heading=%.1f° desired=%.1f° (Δ=%.1f°), "
-                   "moving roll %.1fs→%.1fs for %us\r\n",
-                   phase, current_heading, desired_heading, hdg_delta,
-                   current_roll, target_roll, duration);
-        motor_run(MOTOR_ROLL, dir, duration);
-        return true;
     }
-    return false;
+    s->depth_m = (float)dive_depth_from_pa(press_kpa * 1000.0, surface_pa);
+    s->temp_c = (float)temp_c;
+
+    s->heading_deg = s->pitch_deg = s->roll_deg = 0.0f;
+    if (hmc6343_read(&s->heading_deg, &s->pitch_deg, &s->roll_deg) != 0 && report_errors) {
+        app_printk("[DEPLOY] Compass read failed\r\n");
+    }
+    return depth_ok;
+}
+
+/* One [SENS] line per sample; tools/replay parses this format */
+static void log_sample(const char *depth_tag, const struct dive_sample *s)
+{
+    APP_LOGD(SENS, (uint32_t)s->t_ms, s->internal_pa, depth_tag, s->depth_m,
+             s->heading_deg, s->roll_deg, s->pitch_deg);
+}
+
+/* Test for the climb; logs the decision */
+static bool inflect_due(const char *tag, const struct dive_inflect *inf, const struct dive_vz *vz,
+                        const struct dive_sample *s, const struct app_params *p)
+{
+    float predicted_m;
+
+    if (!dive_inflect_due(inf, vz, s, p, &predicted_m)) {
+        return false;
+    }
+    if (predicted_m > s->depth_m) {
+        app_printk("[%s] predicted apex %.2fm (depth=%.2fm, vz=%.2fm/s, lead=%.1fs) -> start climb\r\n",
+                   tag, predicted_m, s->depth_m, vz->vz_m_s, inf->lead_s);
+    } else {
+        app_printk("[%s] target depth reached (%.2fm) -> start climb\r\n", tag, s->depth_m);
+    }
+    return true;
+}
+
+/* Yo-yo: test for the turn back down during a climb; logs the decision */
+static bool turn_due(const char *tag, const struct dive_inflect *inf, const struct dive_vz *vz,
+                     const struct dive_sample *s, const struct app_params *p)
+{
+    float predicted_m;
+
+    if (!dive_inflect_turn_due(inf, vz, s, p, &predicted_m)) {
+        return false;
+    }
+    app_printk("[%s] yo-yo turn at %.2fm (predicted %.2fm, turn depth %.1fm) -> dive again\r\n",
+               tag, s->depth_m, predicted_m, p->yoyo_min_depth_m);
+    return true;
+}
+
+/* End of climb: learn the lead from the observed apex */
+static void inflect_report(const char *tag, struct dive_inflect *inf)
+{
+    float inflect_depth_m = inf->inflect_depth_m;
+    float apex_depth_m = inf->apex_depth_m;
+    int64_t apex_after_ms = inf->apex_ms - inf->inflect_ms;
+
+    if (!dive_inflect_learn(inf)) {
+        return;
+    }
+    app_printk("[%s] apex %.2fm %.1fs after inflection at %.2fm (overshoot %.2fm); lead now %.1fs\r\n",
+               tag, apex_depth_m, (double)apex_after_ms / 1000.0, inflect_depth_m,
+               apex_depth_m - inflect_depth_m, inf->lead_s);
 }
 
 /* Check if external pressure sensor is available */
@@ -111,260 +246,883 @@ bool deploy_check_sensor_available(void)
     return (ms5837_read(&temp_c, &press_kpa) == 0);
 }
 
-/* Single dive/climb cycle */
-static void deploy_dive_cycle(struct app_params *p, double surface_pa)
-{
-    int32_t heading_check_counter = 0;  /* Reused for both dive and climb phases */
-    
-    /* Move to surface position (start_pitch and start_pump) */
-    float start_pitch_pos_s = motor_get_position_sec(MOTOR_PITCH);
-    float start_pump_pos_s = pump_get_position_sec();
-    float pitch_delta = (float)p->start_pitch_s - start_pitch_pos_s;
-    float pump_delta = (float)p->start_pump_s - start_pump_pos_s;
-    
-    app_printk("[DEPLOY] moving to surface position: pitch target=%us (delta=%.1fs), pump target=%us (delta=%.1fs)\r\n",
-               p->start_pitch_s, pitch_delta, p->start_pump_s, pump_delta);
-    
-    if (pitch_delta > 0.5f) {
-        motor_run(MOTOR_PITCH, +1, (uint32_t)(pitch_delta + 0.5f));
-    } else if (pitch_delta < -0.5f) {
-        motor_run(MOTOR_PITCH, -1, (uint32_t)(-pitch_delta + 0.5f));
-    }
-    
-    if (pump_delta > 0.5f) {
-        pump_run(+1, (uint32_t)(pump_delta + 0.5f));
-    } else if (pump_delta < -0.5f) {
-        pump_run(-1, (uint32_t)(-pump_delta + 0.5f));
-    }
-
-    /* Dive sequence: move pitch and pump to the absolute dive targets */
-    {
-        float cur_pitch = motor_get_position_sec(MOTOR_PITCH);
-        float cur_pump = pump_get_position_sec();
-        float pitch_to_dive = (float)p->dive_pitch_s - cur_pitch;
-        float pump_to_dive = (float)p->dive_pump_s - cur_pump;
-        app_printk("[DEPLOY] moving to dive targets: pitch=%us (delta=%.1fs), pump=%us (delta=%.1fs)\r\n",
-                   p->dive_pitch_s, pitch_to_dive, p->dive_pump_s, pump_to_dive);
-        if (pitch_to_dive > 0.5f) {
-            motor_run(MOTOR_PITCH, +1, (uint32_t)(pitch_to_dive + 0.5f));
-        } else if (pitch_to_dive < -0.5f) {
-            motor_run(MOTOR_PITCH, -1, (uint32_t)(-pitch_to_dive + 0.5f));
-        }
-        if (pump_to_dive > 0.5f) {
-            pump_run(+1, (uint32_t)(pump_to_dive + 0.5f));
-        } else if (pump_to_dive < -0.5f) {
-            pump_run(-1, (uint32_t)(-pump_to_dive + 0.5f));
+/* --- Deploy state machine ---
+ *
+ * One yo runs SURFACE_TRIM -> DESCEND -> INFLECT -> ASCEND -> SURFACE ->
+ * GPS -> COMMS; a yo-yo turn goes from ASCEND straight back to DESCEND.
+ * Every state has a time limit from the parameters (dive_state_timeout_ms)
+ * and every transition is logged with its uptime stamp. Deploy and simulate
+ * run the same machine and differ only in their sample source.
+ */
+
+/* Simulated depth: 50 cm/s down, 25 cm/s up, with the new rate taking
+ * effect SIM_TURN_LAG_MS after each trim change so the inflection
+ * predictor has some actuation latency to learn */
+#define SIM_DIVE_RATE_M_S   0.5
+#define SIM_CLIMB_RATE_M_S  (-0.25)
+#define SIM_TURN_LAG_MS     4000
+
+struct sim_depth {
+    double depth_m;
+    double rate_m_s;
+    double next_rate_m_s;
+    int64_t last_ms;
+    int64_t turn_ms;
+};
+
+struct deploy_run;
+
+/* Where samples and fixes come from */
+struct deploy_src {
+    const char *tag;               /* log prefix */
+    const char *depth_tag;         /* [SENS] depth field name */
+    /* false if the depth could not be read */
+    bool (*read)(struct deploy_run *run, bool report_errors, struct dive_sample *s);
+    /* Runs in the surface GPS worker; true on a fix */
+    bool (*gps)(struct deploy_run *run);
+    /* Trim set-points changed on entering st (simulate: depth model); may be NULL */
+    void (*trim)(struct deploy_run *run, enum dive_state st);
+    bool learn_trim;               /* fold measured rates into mission trim */
+    bool checkpoint;               /* record state for resume after a reset */
+};
+
+struct deploy_run {
+    const struct deploy_src *src;
+    struct app_params *base;       /* configured parameters */
+    struct app_params cyc;         /* current yo, mission step applied */
+    double surface_pa;
+    struct sim_depth sim;
+
+    struct mission *m;
+    struct mission_cursor cur;
+    enum mission_surface surface_pol;
+
+    struct dive_ctrl ctrl;
+    struct dive_vz vz;
+    struct dive_inflect inf;
+    struct dive_sample s;          /* latest sample */
+    struct pump_volume pump_vol;   /* with the pump model on */
+    uint16_t depth_fails;          /* consecutive failed depth reads */
+    bool aborted;
+    struct dive_cycle_stats stats;
+    struct dive_profile profile;
+    uint32_t cycle;
+    struct dive_summary sum;       /* last cycle, for telemetry */
+    uint8_t tlm_pending;           /* summaries not yet pushed to clients */
+
+    int64_t surface_ms;            /* start of the surface interval */
+    uint32_t surface_wait;         /* surface tasks the next dive waits for */
+
+    enum dive_state state;
+    int64_t state_ms;              /* uptime when the state was entered */
+};
+
+/* Sentinel for "mission over" */
+#define DEPLOY_DONE DIVE_ST__COUNT
+
+/* Log which mission step the next cycle runs */
+static void log_mission_cycle(const char *tag, const struct mission *m,
+                              const struct mission_cursor *c, const struct app_params *cyc)
+{
+    if (cyc->yoyo_min_depth_m > 0.0f) {
+        app_printk("[%s] mission step %u/%u, yo %u/%u: depth=%.1fm heading=%d° turn at %.1fm\r\n",
+                   tag, c->step + 1, m->count, c->yo + 1, cyc->yoyo_dives,
+                   cyc->dive_depth_m, cyc->desired_heading_deg, cyc->yoyo_min_depth_m);
+    } else {
+        app_printk("[%s] mission step %u/%u, yo %u/%u: depth=%.1fm heading=%d° surface=%s\r\n",
+                   tag, c->step + 1, m->count, c->yo + 1, cyc->yoyo_dives,
+                   cyc->dive_depth_m, cyc->desired_heading_deg,
+                   mission_surface_name(mission_cycle_surface(m, c)));
+    }
+}
+
+/* Resolve the next mission yo into run->cyc; false once the mission is over */
+static bool next_yo(struct deploy_run *run, bool advance)
+{
+    if (advance) {
+        mission_advance(run->m, &run->cur, run->base);
+    }
+    if (!mission_cycle_params(run->m, &run->cur, run->base, &run->cyc)) {
+        return false;
+    }
+    log_mission_cycle(run->src->tag, run->m, &run->cur, &run->cyc);
+    return true;
+}
+
+/* Pump move by volume (pump model on): timed for the latest depth */
+static void deploy_pump_to(struct deploy_run *run, float target_s, enum act_prio prio)
+{
+    const struct app_params *p = &run->cyc;
+    float bar = pump_model_gauge_bar(run->s.depth_m);
+    struct dive_cmd cmd;
+
+    pump_volume_track(&run->pump_vol, p, pump_get_position_ms(), bar);
+    if (pump_model_move_to(p, &run->pump_vol, target_s, bar, &cmd)) {
+        APP_LOGD(PUMP_VOL, run->src->tag, run->pump_vol.ml, pump_model_setpoint_ml(p, target_s),
+                 bar, cmd.duration_ms);
+        deploy_issue(&cmd, prio, true);
+    }
+}
+
+/* Issue pitch and pump moves; trim is reached when both have stopped.
+ * If the current budget cannot run both, pitch goes first, except on an
+ * emergency ascent where buoyancy matters most. */
+static void trim_to(struct deploy_run *run, float pitch_s, float pump_s)
+{
+    bool abort = (run->state == DIVE_ST_ABORT);
+    enum act_prio pump_prio = abort ? ACT_PRIO_HIGH : ACT_PRIO_NORMAL;
+
+    k_event_clear(&deploy_evt, DEPLOY_EVT_TRIM);
+    trim_start_ms = k_uptime_get();
+    deploy_move_to(DIVE_ACT_PITCH, pitch_s, abort ? ACT_PRIO_NORMAL : ACT_PRIO_HIGH);
+    if (pump_model_enabled(&run->cyc)) {
+        deploy_pump_to(run, pump_s, pump_prio);
+    } else {
+        deploy_move_to(DIVE_ACT_PUMP, pump_s, pump_prio);
+    }
+}
+
+/* True once the trim moves have stopped; logs how long they took */
+static bool trim_reached(struct deploy_run *run)
+{
+    if (atomic_get(&trim_pending) != 0) {
+        return false;
+    }
+    if (k_event_clear(&deploy_evt, DEPLOY_EVT_TRIM) != 0) {
+        app_printk("[%s] trim reached in %ums\r\n", run->src->tag,
+                   (uint32_t)(k_uptime_get() - trim_start_ms));
+    }
+    return true;
+}
+
+/* Sleep out the rest of a one-second tick, waking as soon as trim is
+ * reached or an abort comes in */
+static void trim_sleep(void)
+{
+    (void)k_event_wait(&deploy_evt, DEPLOY_EVT_ABORT | DEPLOY_EVT_TRIM, false, K_MSEC(1000));
+}
+
+/* Queue the sample for the flash log; never waits on flash */
+static void record_sample(const struct deploy_run *run)
+{
+    int32_t pos_ms[DIVE_ACT__COUNT] = {
+        [DIVE_ACT_ROLL] = motor_get_position_ms(MOTOR_ROLL),
+        [DIVE_ACT_PITCH] = motor_get_position_ms(MOTOR_PITCH),
+        [DIVE_ACT_PUMP] = pump_get_position_ms(),
+    };
+    struct log_rec rec;
+
+    log_rec_pack(&rec, &run->s, run->state, pos_ms);
+    (void)flash_log_put(&rec);
+}
+
+/* Read, log and account one sample; the velocity estimate runs while
+ * submerged. A failed depth read keeps the last good depth and feeds
+ * nothing depth-based: a 0 m reading at 20 m would wreck vz, the apex
+ * prediction, the stats and the profile. */
+static void take_sample(struct deploy_run *run, bool report_errors)
+{
+    bool submerged = (run->state == DIVE_ST_DESCEND || run->state == DIVE_ST_INFLECT ||
+                      run->state == DIVE_ST_ASCEND || run->state == DIVE_ST_ABORT);
+
+    const struct app_params *p = &run->cyc;
+    float last_depth_m = run->s.depth_m;
+
+    if (run->src->read(run, report_errors, &run->s)) {
+        run->depth_fails = 0;
+    } else {
+        run->s.depth_m = last_depth_m;
+        if (run->depth_fails < UINT16_MAX) {
+            run->depth_fails++;
         }
     }
+    if (p->abort_depth_fails != 0 && run->depth_fails == p->abort_depth_fails) {
+        deploy_abort("depth sensor failed");
+    }
+    log_sample(run->src->depth_tag, &run->s);
+    record_sample(run);
+    if (run->depth_fails != 0) {
+        /* Pump travel is picked up at the next good depth */
+        return;
+    }
+    /* Pump travel since the last sample happened at about this depth */
+    pump_volume_track(&run->pump_vol, p, pump_get_position_ms(),
+                      pump_model_gauge_bar(run->s.depth_m));
+    if (submerged) {
+        dive_vz_update(&run->vz, &run->s);
+    }
+    dive_stats_sample(&run->stats, run->state, &run->s, &run->vz, &run->cyc);
+    dive_profile_sample(&run->profile, run->state, &run->s);
+}
 
-    /* Monitor sensors while diving to target depth */
-    app_printk("[DEPLOY] monitoring sensors while diving to %.1fm\r\n", p->dive_depth_m);
-    double temp_c = 0.0, press_kpa = 0.0;
-    uint64_t deadline_ms = k_uptime_get() + (uint64_t)p->dive_timeout_min * 60ULL * 1000ULL;
-    heading_check_counter = 0;
+/* One [PROFILE] line per occupied depth bin, descent then ascent */
+static void report_profile(const struct dive_profile *pf)
+{
+    struct dive_profile_bin b;
+    char line[96];
 
-    while (1) {
-        int32_t internal_pa = 0;
-        if (bmp180_read_pa(&internal_pa) != 0) {
-            app_printk("[DEPLOY] Internal pressure read failed\r\n");
+    if (pf->bin_m <= 0.0f) {
+        return;
+    }
+    dive_profile_format_head(pf, line, sizeof(line));
+    app_printk("[PROFILE] %s\r\n", line);
+    for (int d = 0; d < DIVE_PROF__COUNT; d++) {
+        for (unsigned int i = 0; i < DIVE_PROFILE_BINS; i++) {
+            if (dive_profile_get(pf, (enum dive_profile_dir)d, i, &b)) {
+                dive_profile_format_bin((enum dive_profile_dir)d, &b, line, sizeof(line));
+                app_printk("[PROFILE] %s\r\n", line);
+            }
         }
+    }
+}
 
-        if (ms5837_read(&temp_c, &press_kpa) != 0) {
-            app_printk("[DEPLOY] External pressure read failed\r\n");
+/* Actuator energy and the one-line cycle summary, on the console and in NVS */
+static void report_cycle(struct deploy_run *run)
+{
+    struct dive_summary *sum = &run->sum;
+    struct act_energy e;
+    char line[384];
+
+    dive_stats_summarize(&run->stats, k_uptime_get(), sum);
+    actuator_acct_snapshot(&e);
+    act_energy_summarize(&e, &run->cyc, sum);
+    actuator_acct_print(&run->cyc);
+    dive_summary_format(sum, line, sizeof(line));
+    app_printk("[STATS] %s\r\n", line);
+    report_profile(&run->profile);
+    (void)dive_stats_save(sum);
+    if (run->tlm_pending < DIVE_STATS_KEEP) {
+        run->tlm_pending++;
+    }
+}
+
+/* --- Surface interval tasks (run in surface_ops workers) --- */
+
+static bool surface_gps_task(void *arg)
+{
+    struct deploy_run *run = arg;
+    return run->src->gps(run);
+}
+
+/* Push the stored cycle summaries clients have not seen yet, oldest first,
+ * and the latest fix. With nobody connected they wait for a later surfacing. */
+static bool surface_telemetry_task(void *arg)
+{
+    struct deploy_run *run = arg;
+    struct dive_summary sum;
+    struct gps_fix fix;
+    char line[400];
+    int n;
+
+    if (net_console_clients() == 0) {
+        return true;
+    }
+    for (int i = (int)run->tlm_pending - 1; i >= 0; i--) {
+        if (!dive_stats_get((unsigned int)i, &sum)) {
+            continue;
         }
-        double external_pa = press_kpa * 1000.0;
-        double depth_m = (surface_pa > 0.0) ? ((external_pa - surface_pa) / (SEA_WATER_DENSITY_KG_M3 * GRAVITY_M_S2)) : 0.0;
-        if (depth_m < 0.0) depth_m = 0.0;
+        n = snprintf(line, sizeof(line), "[TLM] ");
+        dive_summary_format(&sum, line + n, sizeof(line) - (size_t)n - 2);
+        strcat(line, "\r\n");
+        net_console_write(line, strlen(line));
+    }
+    run->tlm_pending = 0;
+    if (gps_last_fix(&fix)) {
+        n = snprintf(line, sizeof(line), "[TLM] fix %.6f %.6f age %us\r\n", fix.lat_deg,
+                     fix.lon_deg, (uint32_t)((k_uptime_get() - fix.t_ms) / 1000));
+    } else {
+        n = snprintf(line, sizeof(line), "[TLM] no fix\r\n");
+    }
+    net_console_write(line, (size_t)n);
+    return true;
+}
 
-        float head=0.0f, pitch=0.0f, roll=0.0f;
-        if (hmc6343_read(&head, &pitch, &roll) != 0) {
-            app_printk("[DEPLOY] Compass read failed\r\n");
+/* "name=value" sets a parameter, "mission set <n> <step>" replaces a step */
+static bool apply_update(struct deploy_run *run, const char *line,
+                         bool *params_changed, bool *mission_changed)
+{
+    const char *eq = strchr(line, '=');
+
+    if (strncmp(line, "mission set ", 12) == 0) {
+        struct mission_step step;
+        char *endp = NULL;
+        long n = strtol(line + 12, &endp, 10);
+
+        if (endp == line + 12 || n < 1 || n > run->m->count ||
+            mission_parse_step(endp, &step) != 0) {
+            return false;
         }
+        run->m->steps[n - 1] = step;
+        *mission_changed = true;
+        return true;
+    }
+    if (eq && app_params_set_named(run->base, line, (size_t)(eq - line), eq + 1) == 0) {
+        *params_changed = true;
+        return true;
+    }
+    return false;
+}
 
-        app_printk("[SENS] IntP=%d Pa, ExtDepth=%.2fm, H=%.1f,R=%.1f,P=%.1f\r\n",
-                   internal_pa, depth_m, head, roll, pitch);
+/* Apply queued updates to the configuration; the next yo picks them up */
+static bool surface_sync_task(void *arg)
+{
+    struct deploy_run *run = arg;
+    char line[DEPLOY_UPDATE_LEN];
+    bool params_changed = false, mission_changed = false;
+    bool ok = true;
 
-        /* Check heading and adjust roll every HEADING_CHECK_INTERVAL_SEC */
-        heading_check_counter++;
-        if (heading_check_counter >= HEADING_CHECK_INTERVAL_SEC) {
-            heading_check_counter = 0;
-            update_roll_for_heading(true, head, (float)p->desired_heading_deg, p);
+    while (k_msgq_get(&deploy_updates, line, K_NO_WAIT) == 0) {
+        if (apply_update(run, line, &params_changed, &mission_changed)) {
+            app_printk("[%s] update applied: %s\r\n", run->src->tag, line);
+        } else {
+            app_printk("[%s] update rejected: %s\r\n", run->src->tag, line);
+            ok = false;
         }
+    }
+    if (params_changed && app_params_save() != 0) {
+        ok = false;
+    }
+    if (mission_changed && mission_save() != 0) {
+        ok = false;
+    }
+    return ok;
+}
 
-        if (depth_m >= (double)p->dive_depth_m) {
-            app_printk("[DEPLOY] target depth reached (%.2fm) -> start climb\r\n", depth_m);
-            break;
+/* GPS fix (unless skipped) and update sync start as soon as the glider is
+ * up; telemetry follows once the cycle summary exists */
+static void surface_begin(struct deploy_run *run)
+{
+    bool want_gps = run->surface_pol != MISSION_SURF_SKIP || run->aborted;
+
+    surface_ops_begin();
+    run->surface_ms = k_uptime_get();
+    run->surface_wait = 0;
+    if (want_gps && surface_ops_start(SURF_TASK_GPS, surface_gps_task, run) == 0) {
+        run->surface_wait |= SURF_TASK_BIT(SURF_TASK_GPS);
+    }
+    if (!run->aborted && surface_ops_start(SURF_TASK_SYNC, surface_sync_task, run) == 0) {
+        run->surface_wait |= SURF_TASK_BIT(SURF_TASK_SYNC);
+    }
+}
+
+static bool surface_task_done(enum surface_task t)
+{
+    return (surface_ops_done() & SURF_TASK_BIT(t)) != 0;
+}
+
+/* Fold the cycle into the learned trim and keep it with the mission */
+static void learn_trim(struct deploy_run *run)
+{
+    struct trim_learn *t = mission_trim_get();
+
+    if (!trim_learn_update(t, &run->stats, &run->cyc)) {
+        return;
+    }
+    app_printk("[%s] trim learned: dive pitch %+.2fs pump %+.2fs, climb pitch %+.2fs pump %+.2fs\r\n",
+               run->src->tag, t->dive_pitch_s, t->dive_pump_s, t->climb_pitch_s, t->climb_pump_s);
+    (void)mission_trim_save();
+}
+
+/* Sleep out the rest of a one-second tick, or less if a deadline is
+ * sooner; returns early on abort */
+static void tick_sleep(int64_t deadline_ms)
+{
+    int64_t wait_ms = deadline_ms - k_uptime_get();
+    if (wait_ms > 1000) wait_ms = 1000;
+    (void)abortable_sleep(wait_ms);
+}
+
+/* Position to record for a resume: the commanded target while a move is
+ * still scheduled, so the resume does not issue that move a second time */
+static int32_t checkpoint_pos_ms(enum dive_actuator act)
+{
+    if (!act_sched_idle(ACT_MASK(act))) {
+        return cmd_target_ms[act];
+    }
+    switch (act) {
+    case DIVE_ACT_ROLL:  return motor_get_position_ms(MOTOR_ROLL);
+    case DIVE_ACT_PITCH: return motor_get_position_ms(MOTOR_PITCH);
+    case DIVE_ACT_PUMP:  return pump_get_position_ms();
+    default:             return 0;
+    }
+}
+
+/* Where the deployment is, for a warm resume after a reset */
+static void save_checkpoint(const struct deploy_run *run)
+{
+    struct checkpoint ck;
+    struct gps_fix fix;
+
+    memset(&ck, 0, sizeof(ck));
+    ck.flags = CKPT_F_ACTIVE | (run->aborted ? CKPT_F_ABORTED : 0);
+    ck.state = (uint8_t)run->state;
+    ck.step = run->cur.step;
+    ck.yo = run->cur.yo;
+    ck.cycle = run->cycle;
+    for (int a = 0; a < DIVE_ACT__COUNT; a++) {
+        ck.pos_ms[a] = checkpoint_pos_ms((enum dive_actuator)a);
+    }
+    ck.surface_pa = (float)run->surface_pa;
+    ck.inflect_lead_s = run->inf.lead_s;
+    if (gps_last_fix(&fix)) {
+        ck.flags |= CKPT_F_FIX;
+        ck.lat_e7 = (int32_t)lround(fix.lat_deg * 1e7);
+        ck.lon_e7 = (int32_t)lround(fix.lon_deg * 1e7);
+    }
+    checkpoint_save(&ck);
+}
+
+static void enter_state(struct deploy_run *run, enum dive_state next)
+{
+    struct app_params *p = &run->cyc;
+    const char *tag = run->src->tag;
+    int64_t now = k_uptime_get();
+    struct dive_trim trim;
+
+    app_printk("[%s] t=%u %s -> %s after %ums\r\n", tag, (uint32_t)now,
+               dive_state_name(run->state), dive_state_name(next),
+               (uint32_t)(now - run->state_ms));
+    dive_stats_state_time(&run->stats, run->state, (uint32_t)(now - run->state_ms));
+    run->state = next;
+    run->state_ms = now;
+    actuator_acct_set_state(next);
+    if (run->src->trim) {
+        run->src->trim(run, next);
+    }
+
+    switch (next) {
+    case DIVE_ST_SURFACE_TRIM:
+        dive_stats_begin(&run->stats, ++run->cycle, now);
+        dive_profile_begin(&run->profile, run->cycle, p->profile_bin_m);
+        actuator_acct_begin_cycle();
+        app_printk("[%s] moving to surface position: pitch target=%us (delta=%.1fs), pump target=%us (delta=%.1fs)\r\n",
+                   tag, p->start_pitch_s, (float)p->start_pitch_s - actuator_pos_s(DIVE_ACT_PITCH),
+                   p->start_pump_s, (float)p->start_pump_s - actuator_pos_s(DIVE_ACT_PUMP));
+        trim_to(run, p->start_pitch_s, p->start_pump_s);
+        break;
+
+    case DIVE_ST_DESCEND:
+        trim_learn_setpoints(mission_trim_get(), p, &trim);
+        app_printk("[%s] moving to dive targets: pitch=%.2fs (delta=%.1fs), pump=%.2fs (delta=%.1fs)\r\n",
+                   tag, trim.dive_pitch_s, trim.dive_pitch_s - actuator_pos_s(DIVE_ACT_PITCH),
+                   trim.dive_pump_s, trim.dive_pump_s - actuator_pos_s(DIVE_ACT_PUMP));
+        trim_to(run, trim.dive_pitch_s, trim.dive_pump_s);
+        app_printk("[%s] monitoring sensors while diving to %.1fm\r\n", tag, p->dive_depth_m);
+        dive_ctrl_begin_phase(&run->ctrl, true, now);
+        dive_vz_reset(&run->vz);
+        break;
+
+    case DIVE_ST_INFLECT:
+        trim_learn_setpoints(mission_trim_get(), p, &trim);
+        app_printk("[%s] moving to climb targets: pitch=%.2fs (delta=%.1fs), pump=%.2fs (delta=%.1fs)\r\n",
+                   tag, trim.climb_pitch_s, trim.climb_pitch_s - actuator_pos_s(DIVE_ACT_PITCH),
+                   trim.climb_pump_s, trim.climb_pump_s - actuator_pos_s(DIVE_ACT_PUMP));
+        trim_to(run, trim.climb_pitch_s, trim.climb_pump_s);
+        dive_inflect_begin(&run->inf, &run->vz, &run->s);
+        break;
+
+    case DIVE_ST_ASCEND:
+        dive_ctrl_begin_phase(&run->ctrl, false, now);
+        break;
+
+    case DIVE_ST_SURFACE: {
+        app_printk("[%s] depth < 1m reached; moving to surface position\r\n", tag);
+        trim_to(run, p->start_pitch_s, p->start_pump_s);
+
+        /* Return roll to neutral when reaching surface */
+        float current_roll = actuator_pos_s(DIVE_ACT_ROLL);
+        struct dive_cmd cmd;
+        if (dive_ctrl_roll_neutral(current_roll, p, &cmd)) {
+            deploy_issue(&cmd, ACT_PRIO_LOW, false);
+            app_printk("[ROLL] RETURN: surfacing, returning roll to neutral (%.2fs→%.2fs, duration=%ums)\r\n",
+                       current_roll, cmd.target_s, cmd.duration_ms);
         }
-        
-        if ((int64_t)k_uptime_get() >= (int64_t)deadline_ms) {
-            app_printk("[DEPLOY] dive timeout -> start climb\r\n");
-            break;
+        run->surface_pol = mission_cycle_surface(run->m, &run->cur);
+        surface_begin(run);
+        flash_log_flush();         /* the dive is on flash before any download */
+        break;
+    }
+
+    case DIVE_ST_ABORT: {
+        float current_roll = actuator_pos_s(DIVE_ACT_ROLL);
+        struct dive_cmd cmd;
+
+        run->aborted = true;
+        app_printk("[%s] ABORT (%s): emergency ascent at %.2fm, pump -> %us, pitch -> %us\r\n",
+                   tag, abort_reason, run->s.depth_m, p->abort_pump_s, p->abort_pitch_s);
+        trim_to(run, p->abort_pitch_s, p->abort_pump_s);
+        if (dive_ctrl_roll_neutral(current_roll, p, &cmd)) {
+            deploy_issue(&cmd, ACT_PRIO_LOW, false);
         }
+        break;
+    }
 
-        k_sleep(K_SECONDS(1));
-    }
-
-    /* Start climb sequence */
-    {
-        float cur_pitch = motor_get_position_sec(MOTOR_PITCH);
-        float cur_pump = pump_get_position_sec();
-        float pitch_to_climb = (float)p->climb_pitch_s - cur_pitch;
-        float pump_to_climb = (float)p->climb_pump_s - cur_pump;
-        app_printk("[DEPLOY] moving to climb targets: pitch=%us (delta=%.1fs), pump=%us (delta=%.1fs)\r\n",
-                   p->climb_pitch_s, pitch_to_climb, p->climb_pump_s, pump_to_climb);
-        if (pitch_to_climb > 0.5f) {
-            motor_run(MOTOR_PITCH, +1, (uint32_t)(pitch_to_climb + 0.5f));
-        } else if (pitch_to_climb < -0.5f) {
-            motor_run(MOTOR_PITCH, -1, (uint32_t)(-pitch_to_climb + 0.5f));
+    case DIVE_ST_COMMS:
+        /* Summary before the operator window; the window itself is not
+         * part of the cycle */
+        report_cycle(run);
+        if (run->src->learn_trim && !run->aborted) {
+            learn_trim(run);
         }
-        if (pump_to_climb > 0.5f) {
-            pump_run(+1, (uint32_t)(pump_to_climb + 0.5f));
-        } else if (pump_to_climb < -0.5f) {
-            pump_run(-1, (uint32_t)(-pump_to_climb + 0.5f));
+        if (surface_ops_start(SURF_TASK_TELEMETRY, surface_telemetry_task, run) == 0) {
+            run->surface_wait |= SURF_TASK_BIT(SURF_TASK_TELEMETRY);
         }
+        break;
+
+    case DIVE_ST_GPS:
+        app_printk("[%s] acquired surface position, waiting for GPS fix\r\n", tag);
+        break;
+
+    default:
+        break;
     }
 
-    /* Monitor climb until surface */
-    bool surface_reached = false;
-    heading_check_counter = 0;
-    for (int i=0;i<60;i++) {  /* Allow up to 60 seconds for climb monitoring */
-        int32_t internal_pa = 0;
-        bmp180_read_pa(&internal_pa);
-        ms5837_read(&temp_c,&press_kpa);
-        double external_pa = press_kpa * 1000.0;
-        double depth_m = (surface_pa>0.0)?((external_pa - surface_pa) / (SEA_WATER_DENSITY_KG_M3 * GRAVITY_M_S2)):0.0;
-        if (depth_m < 0.0) depth_m = 0.0;
-        
-        float head=0.0f, pitch=0.0f, roll=0.0f;
-        hmc6343_read(&head,&pitch,&roll);
-        app_printk("[SENS] IntP=%d Pa, ExtDepth=%.2fm, H=%.1f,R=%.1f,P=%.1f\r\n",
-                   internal_pa, depth_m, head, roll, pitch);
-        
-        /* Check heading and adjust roll every HEADING_CHECK_INTERVAL_SEC */
-        heading_check_counter++;
-        if (heading_check_counter >= HEADING_CHECK_INTERVAL_SEC) {
-            heading_check_counter = 0;
-            update_roll_for_heading(false, head, (float)p->desired_heading_deg, p);
+    /* After the entry moves are queued: they are recorded at their
+     * targets, so a resume in this state finds nothing left to trim */
+    if (run->src->checkpoint) {
+        save_checkpoint(run);
+    }
+}
+
+/* A failed depth read reads as 0 m, which must not count as surfacing */
+static bool surfaced(const struct deploy_run *run)
+{
+    return run->depth_fails == 0 && dive_ctrl_surface_reached(&run->s);
+}
+
+static enum dive_state st_surface_trim(struct deploy_run *run)
+{
+    int64_t now = k_uptime_get();
+    if (trim_reached(run)) {
+        return DIVE_ST_DESCEND;
+    }
+    if (dive_state_timed_out(DIVE_ST_SURFACE_TRIM, run->state_ms, now, &run->cyc)) {
+        app_printk("[%s] surface trim timeout -> dive\r\n", run->src->tag);
+        return DIVE_ST_DESCEND;
+    }
+    trim_sleep();
+    return DIVE_ST_SURFACE_TRIM;
+}
+
+static enum dive_state st_descend(struct deploy_run *run)
+{
+    struct app_params *p = &run->cyc;
+
+    take_sample(run, true);
+    update_roll_for_heading(&run->ctrl, &run->s, p);
+
+    if (run->depth_fails == 0 && inflect_due(run->src->tag, &run->inf, &run->vz, &run->s, p)) {
+        return DIVE_ST_INFLECT;
+    }
+    if (dive_state_timed_out(DIVE_ST_DESCEND, run->state_ms, run->s.t_ms, p)) {
+        app_printk("[%s] dive timeout -> start climb\r\n", run->src->tag);
+        return DIVE_ST_INFLECT;
+    }
+    tick_sleep(INT64_MAX);
+    return DIVE_ST_DESCEND;
+}
+
+/* Climb trim is moving; keep sampling so the apex is seen */
+static enum dive_state st_inflect(struct deploy_run *run)
+{
+    take_sample(run, false);
+    if (run->depth_fails == 0) {
+        dive_inflect_track(&run->inf, &run->s);
+    }
+
+    if (trim_reached(run)) {
+        return DIVE_ST_ASCEND;
+    }
+    if (dive_state_timed_out(DIVE_ST_INFLECT, run->state_ms, run->s.t_ms, &run->cyc)) {
+        app_printk("[%s] climb trim timeout -> ascend\r\n", run->src->tag);
+        return DIVE_ST_ASCEND;
+    }
+    trim_sleep();
+    return DIVE_ST_INFLECT;
+}
+
+static enum dive_state st_ascend(struct deploy_run *run)
+{
+    struct app_params *p = &run->cyc;
+
+    take_sample(run, false);
+    if (run->depth_fails == 0) {
+        dive_inflect_track(&run->inf, &run->s);
+    }
+    update_roll_for_heading(&run->ctrl, &run->s, p);
+
+    if (p->yoyo_min_depth_m > 0.0f && run->depth_fails == 0 &&
+        turn_due(run->src->tag, &run->inf, &run->vz, &run->s, p)) {
+        inflect_report(run->src->tag, &run->inf);
+        /* The last yo of a step never turns, so the mission continues */
+        return next_yo(run, true) ? DIVE_ST_DESCEND : DIVE_ST_SURFACE;
+    }
+    if (surfaced(run)) {
+        inflect_report(run->src->tag, &run->inf);
+        return DIVE_ST_SURFACE;
+    }
+    if (dive_state_timed_out(DIVE_ST_ASCEND, run->state_ms, run->s.t_ms, p)) {
+        app_printk("[%s] climb timeout at %.2fm -> surface\r\n", run->src->tag, run->s.depth_m);
+        inflect_report(run->src->tag, &run->inf);
+        return DIVE_ST_SURFACE;
+    }
+    tick_sleep(INT64_MAX);
+    return DIVE_ST_ASCEND;
+}
+
+/* Emergency ascent: abort trim is moving, wait for the surface */
+static enum dive_state st_abort(struct deploy_run *run)
+{
+    take_sample(run, false);
+    if (surfaced(run)) {
+        return DIVE_ST_SURFACE;
+    }
+    if (dive_state_timed_out(DIVE_ST_ABORT, run->state_ms, run->s.t_ms, &run->cyc)) {
+        app_printk("[%s] emergency ascent timeout at %.2fm -> surface\r\n",
+                   run->src->tag, run->s.depth_m);
+        return DIVE_ST_SURFACE;
+    }
+    tick_sleep(INT64_MAX);
+    return DIVE_ST_ABORT;
+}
+
+static enum dive_state st_surface(struct deploy_run *run)
+{
+    take_sample(run, false);
+    if (dive_state_timed_out(DIVE_ST_SURFACE, run->state_ms, run->s.t_ms, &run->cyc)) {
+        /* The fix started with the interval; only wait if it is still going */
+        if ((run->surface_wait & SURF_TASK_BIT(SURF_TASK_GPS)) &&
+            !surface_task_done(SURF_TASK_GPS)) {
+            return DIVE_ST_GPS;
         }
-        
-        if (!surface_reached && depth_m < 1.0) {
-            surface_reached = true;
-            app_printk("[DEPLOY] depth < 1m reached; moving to surface position\r\n");
-            
-            float current_pitch = motor_get_position_sec(MOTOR_PITCH);
-            float pitch_to_surface = (float)p->start_pitch_s - current_pitch;
-            if (pitch_to_surface > 0.5f) {
-                motor_run(MOTOR_PITCH, +1, (uint32_t)(pitch_to_surface + 0.5f));
-            } else if (pitch_to_surface < -0.5f) {
-                motor_run(MOTOR_PITCH, -1, (uint32_t)(-pitch_to_surface + 0.5f));
-            }
-            
-            float current_pump = pump_get_position_sec();
-            float pump_to_surface = (float)p->start_pump_s - current_pump;
-            if (pump_to_surface > 0.5f) {
-                pump_run(+1, (uint32_t)(pump_to_surface + 0.5f));
-            } else if (pump_to_surface < -0.5f) {
-                pump_run(-1, (uint32_t)(-pump_to_surface + 0.5f));
-            }
-            
-            /* Return roll to neutral when reaching surface */
-            float current_roll = motor_get_position_sec(MOTOR_ROLL);
-            float roll_delta = (float)p->start_roll_s - current_roll;
-            if (fabsf(roll_delta) > 0.5f) {
-                int dir = (roll_delta > 0) ? +1 : -1;
-                uint32_t duration = (uint32_t)(fabsf(roll_delta) + 0.5f);
-                motor_run(MOTOR_ROLL, dir, duration);
-                app_printk("[ROLL] RETURN: surfacing, returning roll to neutral (%.1fs→0.0s, duration=%us)\r\n",
-                           current_roll, duration);
+        return DIVE_ST_COMMS;
+    }
+    tick_sleep(INT64_MAX);
+    return DIVE_ST_SURFACE;
+}
+
+/* The fix has gps_timeout_s from the start of the surface interval, not
+ * from here, so the dwell and the fix overlap */
+static enum dive_state st_gps(struct deploy_run *run)
+{
+    take_sample(run, false);
+    if (surface_task_done(SURF_TASK_GPS) ||
+        dive_state_timed_out(DIVE_ST_GPS, run->surface_ms, run->s.t_ms, &run->cyc)) {
+        return DIVE_ST_COMMS;
+    }
+    tick_sleep(INT64_MAX);
+    return DIVE_ST_GPS;
+}
+
+/* Wait for the surface tasks, or comms_window_s at most; prompting steps
+ * also give the operator that window to press ENTER */
+static enum dive_state st_comms(struct deploy_run *run)
+{
+    const char *tag = run->src->tag;
+    bool prompt = run->surface_pol == MISSION_SURF_PROMPT && !run->aborted;
+
+    if (prompt) {
+        app_printk("[%s] press ENTER within %u seconds to stop, or will start another dive...\r\n",
+                   tag, run->cyc.comms_window_s);
+    }
+    while (!dive_state_timed_out(DIVE_ST_COMMS, run->state_ms, k_uptime_get(), &run->cyc)) {
+        if (!prompt && (surface_ops_done() & run->surface_wait) == run->surface_wait) {
+            break;
+        }
+        char line[128];
+        if (prompt && net_console_poll_line(line, sizeof(line), K_MSEC(500))) {
+            /* User pressed ENTER on net console */
+            if (line[0] == '\0' || line[0] == '\r' || line[0] == '\n') {
+                app_printk("[%s] user requested stop\r\n", tag);
+                surface_ops_finish();
+                return DEPLOY_DONE;
             }
-            
-            for (int j=0; j<5; j++) {
-                k_sleep(K_SECONDS(1));
-                bmp180_read_pa(&internal_pa);
-                ms5837_read(&temp_c,&press_kpa);
-                external_pa = press_kpa * 1000.0;
-                depth_m = (surface_pa>0.0)?((external_pa - surface_pa) / (SEA_WATER_DENSITY_KG_M3 * GRAVITY_M_S2)):0.0;
-                hmc6343_read(&head,&pitch,&roll);
-                app_printk("[SENS] IntP=%d Pa, ExtDepth=%.2fm, H=%.1f,R=%.1f,P=%.1f\r\n",
-                           internal_pa, depth_m, head, roll, pitch);
+        }
+        if (abortable_sleep(100)) {
+            return DIVE_ST_COMMS;  /* handled by the run loop */
+        }
+    }
+    surface_ops_finish();
+    surface_ops_report(tag);
+
+    if (run->aborted) {
+        app_printk("[%s] deployment aborted (%s)\r\n", tag, abort_reason);
+        return DEPLOY_DONE;
+    }
+    if (!next_yo(run, true)) {
+        app_printk("[%s] mission complete\r\n", tag);
+        return DEPLOY_DONE;
+    }
+    app_printk("[%s] starting another dive cycle\r\n", tag);
+    return DIVE_ST_SURFACE_TRIM;
+}
+
+/* Run the mission table to completion or until the operator stops it */
+static void deploy_run_mission(struct deploy_run *run, const struct checkpoint *resume)
+{
+    enum dive_state first = DIVE_ST_SURFACE_TRIM;
+
+    run->m = mission_get();
+    mission_begin(&run->cur);
+    dive_inflect_init(&run->inf, run->base);  /* the lead is learned across cycles */
+    if (resume) {
+        run->cur.step = resume->step;
+        run->cur.yo = resume->yo;
+        run->inf.lead_s = resume->inflect_lead_s;
+        first = checkpoint_resume_state(resume);
+        if (first == DIVE_ST_ABORT) {
+            abort_reason = "resumed after reset";
+        }
+    }
+    if (!next_yo(run, false)) {
+        return;
+    }
+    /* Taken as surface volume, including on a resume at depth */
+    pump_volume_reset(&run->pump_vol, &run->cyc, pump_get_position_ms());
+
+    run->state = DIVE_ST_COMMS;
+    run->state_ms = k_uptime_get();
+    if (first == DIVE_ST_SURFACE_TRIM) {
+        run->cycle = resume ? resume->cycle - 1U : 0U;  /* SURFACE_TRIM counts it */
+    } else {
+        /* Mid-cycle: the statistics start over from here */
+        run->cycle = resume->cycle;
+        dive_stats_begin(&run->stats, run->cycle, run->state_ms);
+        dive_profile_begin(&run->profile, run->cycle, run->cyc.profile_bin_m);
+        actuator_acct_begin_cycle();
+    }
+    enter_state(run, first);
+
+    while (1) {
+        enum dive_state next;
+
+        if (abort_requested()) {
+            if (run->aborted) {
+                /* Second abort: stop the worker outright */
+                app_printk("[%s] abort repeated (%s), stopping\r\n", run->src->tag, abort_reason);
+                surface_ops_finish();
+                return;
             }
-            break;
+            k_event_clear(&deploy_evt, DEPLOY_EVT_ABORT);
+            enter_state(run, DIVE_ST_ABORT);
+        }
+
+        switch (run->state) {
+        case DIVE_ST_SURFACE_TRIM: next = st_surface_trim(run); break;
+        case DIVE_ST_DESCEND:      next = st_descend(run); break;
+        case DIVE_ST_INFLECT:      next = st_inflect(run); break;
+        case DIVE_ST_ASCEND:       next = st_ascend(run); break;
+        case DIVE_ST_SURFACE:      next = st_surface(run); break;
+        case DIVE_ST_GPS:          next = st_gps(run); break;
+        case DIVE_ST_COMMS:        next = st_comms(run); break;
+        case DIVE_ST_ABORT:        next = st_abort(run); break;
+        default:                   next = DEPLOY_DONE; break;
+        }
+        if (next == DEPLOY_DONE) {
+            return;
+        }
+        if (next != run->state) {
+            enter_state(run, next);
         }
-        
-        k_sleep(K_SECONDS(1));
     }
 }
 
-void deploy_start(void)
+/* --- Deploy: real sensors --- */
+
+static bool deploy_src_read(struct deploy_run *run, bool report_errors, struct dive_sample *s)
 {
-    struct app_params *p = app_params_get();
+    return deploy_read_sample(run->surface_pa, report_errors, s);
+}
+
+/* Stop the surface fix on abort or when the deploy worker stops waiting */
+static bool surface_gps_cancel(void)
+{
+    return abort_requested() || surface_ops_cancelled();
+}
+
+static bool deploy_src_gps(struct deploy_run *run)
+{
+    return gps_fix_wait_cancel(run->cyc.gps_timeout_s, surface_gps_cancel);
+}
 
+static const struct deploy_src deploy_src = {
+    .tag = "DEPLOY",
+    .depth_tag = "ExtDepth",
+    .read = deploy_src_read,
+    .gps = deploy_src_gps,
+    .trim = NULL,
+    .learn_trim = true,
+    .checkpoint = true,
+};
+
+/* Surface reference, pre-dive wait and first fix; false to stop */
+static bool deploy_prepare(struct deploy_run *run, struct app_params *p)
+{
     app_printk("[DEPLOY] starting sequence\r\n");
 
     /* 1) Take reading from external pressure sensor to use as surface reference */
     double temp_c = 0.0, press_kpa = 0.0;
-    double surface_pa = 0.0;
     if (ms5837_read(&temp_c, &press_kpa) != 0) {
         app_printk("[DEPLOY] ERROR: cannot read external pressure sensor (MS5837)\r\n");
         app_printk("[DEPLOY] Try 'simulate' instead to test with simulated pressure\r\n");
         atomic_set(&return_to_menu_flag, 1);
-        return;
+        return false;
     }
-    surface_pa = press_kpa * 1000.0; /* kPa -> Pa */
+    run->surface_pa = press_kpa * 1000.0; /* kPa -> Pa */
     app_printk("[DEPLOY] surface external pressure: %.3f kPa (T=%.2f C)\r\n", press_kpa, temp_c);
 
+    /* Absolute pitch before the first dive; a failed homing is not fatal,
+     * pitch just stays dead-reckoned */
+    if (p->pitch_home_on_deploy) {
+        (void)pitch_home();
+    }
+
     /* Record starting positions */
-    float start_pitch_pos_s = motor_get_position_sec(MOTOR_PITCH);
-    float start_roll_pos_s = motor_get_position_sec(MOTOR_ROLL);
-    float start_pump_pos_s = pump_get_position_sec();
     app_printk("[DEPLOY] starting positions: pitch=%.1fs, roll=%.1fs, pump=%.1fs\r\n",
-               start_pitch_pos_s, start_roll_pos_s, start_pump_pos_s);
+               actuator_pos_s(DIVE_ACT_PITCH), actuator_pos_s(DIVE_ACT_ROLL),
+               actuator_pos_s(DIVE_ACT_PUMP));
 
     /* 2) Wait before first dive */
     uint32_t wait_s = (uint32_t)p->deploy_wait_s;
-    app_printk("[DEPLOY] waiting %us before first dive\r\n", wait_s);
-    for (uint32_t i = 0; i < wait_s; ++i) {
-        k_sleep(K_SECONDS(1));
+    app_printk("[DEPLOY] waiting %us before first dive ('abort' to cancel)\r\n", wait_s);
+    if (abortable_sleep((int64_t)wait_s * 1000)) {
+        app_printk("[DEPLOY] aborted before first dive (%s)\r\n", abort_reason);
+        return false;
     }
 
     /* 3) Acquire GPS fix before dive */
     app_printk("[DEPLOY] acquiring GPS fix before dive\r\n");
-    gps_fix_wait(30);  /* 30 second timeout */
+    (void)gps_fix_wait_cancel(p->gps_timeout_s, abort_requested);
+    return true;
+}
 
-    /* 4) Main dive/climb loop */
-    while (1) {
-        /* Perform dive and climb cycle */
-        deploy_dive_cycle(p, surface_pa);
-
-        /* 5) After climb, acquire another GPS fix */
-        app_printk("[DEPLOY] acquired surface position, getting GPS fix\r\n");
-        gps_fix_wait(30);  /* 30 second timeout */
-
-        /* 6) Wait 10 seconds for user to press ENTER to stop, else auto-restart dive */
-        app_printk("[DEPLOY] press ENTER within 10 seconds to stop, or will start another dive...\r\n");
-        int64_t wait_start = k_uptime_get();
-        bool enter_pressed = false;
-        
-        while (k_uptime_get() - wait_start < 10000) {  /* 10 second timeout */
-            char line[128];
-            if (net_console_poll_line(line, sizeof(line), K_MSEC(500))) {
-                /* User pressed ENTER on net console */
-                if (line[0] == '\0' || line[0] == '\r' || line[0] == '\n') {
-                    enter_pressed = true;
-                    break;
-                }
-            }
-            k_sleep(K_MSEC(100));
-        }
+void deploy_start(void)
+{
+    static struct deploy_run run;
+    struct app_params *p = app_params_get();
+    struct checkpoint ck;
+    bool resume = checkpoint_take(&ck);
 
-        if (enter_pressed) {
-            app_printk("[DEPLOY] user requested stop\r\n");
-            break;
-        }
+    k_event_clear(&deploy_evt, DEPLOY_EVT_ABORT);
+    memset(&run, 0, sizeof(run));
+    run.src = &deploy_src;
+    run.base = p;
 
-        app_printk("[DEPLOY] no user input, starting another dive cycle\r\n");
+    if (resume) {
+        /* Warm resume after a reset: keep the old surface reference and go
+         * straight back into the mission */
+        run.surface_pa = (double)ck.surface_pa;
+        app_printk("[DEPLOY] resuming interrupted deployment (surface %.3f kPa)\r\n",
+                   run.surface_pa / 1000.0);
+    } else if (!deploy_prepare(&run, p)) {
+        return;
     }
 
+    /* 4) Run the mission table */
+    deploy_run_mission(&run, resume ? &ck : NULL);
+    checkpoint_clear();
+
+    flash_log_sync();
     app_printk("[DEPLOY] deployment complete, returning to menu\r\n");
 }
 
@@ -395,239 +1153,127 @@ void deploy_start_async(void)
 }
 
 /* --- Simulate deployment (with simulated external pressure) --- */
-/* Single simulate dive/climb cycle with simulated depth */
-static void simulate_dive_cycle(struct app_params *p, double surface_pa)
-{
-    int32_t heading_check_counter = 0;  /* Reused for both dive and climb phases */
-    
-    /* Move to surface position */
-    float start_pitch_pos_s = motor_get_position_sec(MOTOR_PITCH);
-    float start_pump_pos_s = pump_get_position_sec();
-    float pitch_delta = (float)p->start_pitch_s - start_pitch_pos_s;
-    float pump_delta = (float)p->start_pump_s - start_pump_pos_s;
-    
-    app_printk("[SIMULATE] moving to surface position: pitch target=%us, pump target=%us\r\n",
-               p->start_pitch_s, p->start_pump_s);
-    
-    if (pitch_delta > 0.5f) {
-        motor_run(MOTOR_PITCH, +1, (uint32_t)(pitch_delta + 0.5f));
-    } else if (pitch_delta < -0.5f) {
-        motor_run(MOTOR_PITCH, -1, (uint32_t)(-pitch_delta + 0.5f));
-    }
-    
-    if (pump_delta > 0.5f) {
-        pump_run(+1, (uint32_t)(pump_delta + 0.5f));
-    } else if (pump_delta < -0.5f) {
-        pump_run(-1, (uint32_t)(-pump_delta + 0.5f));
-    }
-
-    /* Dive sequence */
-    {
-        float cur_pitch = motor_get_position_sec(MOTOR_PITCH);
-        float cur_pump = pump_get_position_sec();
-        float pitch_to_dive = (float)p->dive_pitch_s - cur_pitch;
-        float pump_to_dive = (float)p->dive_pump_s - cur_pump;
-        app_printk("[SIMULATE] moving to dive targets: pitch=%us, pump=%us\r\n",
-                   p->dive_pitch_s, p->dive_pump_s);
-        if (pitch_to_dive > 0.5f) {
-            motor_run(MOTOR_PITCH, +1, (uint32_t)(pitch_to_dive + 0.5f));
-        } else if (pitch_to_dive < -0.5f) {
-            motor_run(MOTOR_PITCH, -1, (uint32_t)(-pitch_to_dive + 0.5f));
-        }
-        if (pump_to_dive > 0.5f) {
-            pump_run(+1, (uint32_t)(pump_to_dive + 0.5f));
-        } else if (pump_to_dive < -0.5f) {
-            pump_run(-1, (uint32_t)(-pump_to_dive + 0.5f));
-        }
+
+static void sim_depth_set_rate(struct sim_depth *d, double rate_m_s, bool immediate)
+{
+    d->next_rate_m_s = rate_m_s;
+    d->turn_ms = k_uptime_get() + (immediate ? 0 : SIM_TURN_LAG_MS);
+    if (immediate) {
+        d->rate_m_s = rate_m_s;
+        d->last_ms = d->turn_ms;
     }
+}
 
-    /* Simulate dive to target depth at 50 cm/s */
-    app_printk("[SIMULATE] diving to %.1fm (simulated pressure at 50cm/s)\r\n", p->dive_depth_m);
-    uint64_t dive_start_ms = k_uptime_get();
-    heading_check_counter = 0;
-    
-    while (1) {
-        uint64_t elapsed_ms = k_uptime_get() - dive_start_ms;
-        double elapsed_s = (double)elapsed_ms / 1000.0;
-        double simulated_depth_m = 0.5 * elapsed_s;  /* 50 cm/s = 0.5 m/s */
-        
-        int32_t internal_pa = 0;
-        bmp180_read_pa(&internal_pa);
-        
-        float head=0.0f, pitch=0.0f, roll=0.0f;
-        hmc6343_read(&head, &pitch, &roll);
-
-        app_printk("[SENS] IntP=%d Pa, SimDepth=%.2fm, H=%.1f,R=%.1f,P=%.1f\r\n",
-                   internal_pa, simulated_depth_m, head, roll, pitch);
-
-        /* Check heading and adjust roll every HEADING_CHECK_INTERVAL_SEC */
-        heading_check_counter++;
-        if (heading_check_counter >= HEADING_CHECK_INTERVAL_SEC) {
-            heading_check_counter = 0;
-            update_roll_for_heading(true, head, (float)p->desired_heading_deg, p);
-        }
+static double sim_depth_now(struct sim_depth *d)
+{
+    int64_t now = k_uptime_get();
+    if (d->rate_m_s != d->next_rate_m_s && now >= d->turn_ms) {
+        d->depth_m += d->rate_m_s * (double)(d->turn_ms - d->last_ms) / 1000.0;
+        d->last_ms = d->turn_ms;
+        d->rate_m_s = d->next_rate_m_s;
+    }
+    d->depth_m += d->rate_m_s * (double)(now - d->last_ms) / 1000.0;
+    d->last_ms = now;
+    if (d->depth_m < 0.0) {
+        d->depth_m = 0.0;
+    }
+    return d->depth_m;
+}
 
-        if (simulated_depth_m >= (double)p->dive_depth_m) {
-            app_printk("[SIMULATE] target depth reached (%.2fm) -> start climb\r\n", simulated_depth_m);
-            break;
-        }
+/* Real hull pressure and compass, simulated depth */
+static bool simulate_src_read(struct deploy_run *run, bool report_errors, struct dive_sample *s)
+{
+    ARG_UNUSED(report_errors);
+    s->t_ms = k_uptime_get();
+    s->internal_pa = 0;
+    (void)bmp180_read_pa(&s->internal_pa);
+    s->depth_m = (float)sim_depth_now(&run->sim);
+    s->temp_c = 0.0f;
+    s->heading_deg = s->pitch_deg = s->roll_deg = 0.0f;
+    (void)hmc6343_read(&s->heading_deg, &s->pitch_deg, &s->roll_deg);
+    return true;
+}
 
-        k_sleep(K_SECONDS(1));
-    }
-
-    /* Climb sequence */
-    {
-        float cur_pitch = motor_get_position_sec(MOTOR_PITCH);
-        float cur_pump = pump_get_position_sec();
-        float pitch_to_climb = (float)p->climb_pitch_s - cur_pitch;
-        float pump_to_climb = (float)p->climb_pump_s - cur_pump;
-        app_printk("[SIMULATE] moving to climb targets: pitch=%us, pump=%us\r\n",
-                   p->climb_pitch_s, p->climb_pump_s);
-        if (pitch_to_climb > 0.5f) {
-            motor_run(MOTOR_PITCH, +1, (uint32_t)(pitch_to_climb + 0.5f));
-        } else if (pitch_to_climb < -0.5f) {
-            motor_run(MOTOR_PITCH, -1, (uint32_t)(-pitch_to_climb + 0.5f));
-        }
-        if (pump_to_climb > 0.5f) {
-            pump_run(+1, (uint32_t)(pump_to_climb + 0.5f));
-        } else if (pump_to_climb < -0.5f) {
-            pump_run(-1, (uint32_t)(-pump_to_climb + 0.5f));
+static bool simulate_src_gps(struct deploy_run *run)
+{
+    ARG_UNUSED(run);
+    for (int i = 0; i < 20; i++) {
+        if (surface_gps_cancel()) {
+            return false;
         }
+        k_sleep(K_MSEC(100));
     }
+    app_printk("[GPS] acquired (simulated)\r\n");
+    return true;
+}
 
-    /* Simulate climb back to surface */
-    bool surface_reached = false;
-    heading_check_counter = 0;
-    for (int i=0;i<60;i++) {
-        uint64_t elapsed_ms = k_uptime_get() - dive_start_ms;
-        double elapsed_s = (double)elapsed_ms / 1000.0;
-        double simulated_depth_m = 0.5 * elapsed_s;
-        
-        if (simulated_depth_m > (double)p->dive_depth_m) {
-            simulated_depth_m = (double)p->dive_depth_m - 0.5 * (simulated_depth_m - (double)p->dive_depth_m);
-            if (simulated_depth_m < 0.0) simulated_depth_m = 0.0;
-        }
+/* Depth model follows the trim: dives straight away from the surface,
+ * reverses after the lag at depth */
+static void simulate_src_trim(struct deploy_run *run, enum dive_state st)
+{
+    struct sim_depth *sim = &run->sim;
+    bool at_surface = sim->depth_m < SURFACE_DEPTH_M;
 
-        int32_t internal_pa = 0;
-        bmp180_read_pa(&internal_pa);
-        
-        float head=0.0f, pitch=0.0f, roll=0.0f;
-        hmc6343_read(&head,&pitch,&roll);
-        app_printk("[SENS] IntP=%d Pa, SimDepth=%.2fm, H=%.1f,R=%.1f,P=%.1f\r\n",
-                   internal_pa, simulated_depth_m, head, roll, pitch);
-
-        /* Check heading and adjust roll every HEADING_CHECK_INTERVAL_SEC */
-        heading_check_counter++;
-        if (heading_check_counter >= HEADING_CHECK_INTERVAL_SEC) {
-            heading_check_counter = 0;
-            update_roll_for_heading(false, head, (float)p->desired_heading_deg, p);
-        }
-        
-        if (!surface_reached && simulated_depth_m < 1.0) {
-            surface_reached = true;
-            app_printk("[SIMULATE] depth < 1m reached; moving to surface position\r\n");
-            
-            float current_pitch = motor_get_position_sec(MOTOR_PITCH);
-            float pitch_to_surface = (float)p->start_pitch_s - current_pitch;
-            if (pitch_to_surface > 0.5f) {
-                motor_run(MOTOR_PITCH, +1, (uint32_t)(pitch_to_surface + 0.5f));
-            } else if (pitch_to_surface < -0.5f) {
-                motor_run(MOTOR_PITCH, -1, (uint32_t)(-pitch_to_surface + 0.5f));
-            }
-            
-            float current_pump = pump_get_position_sec();
-            float pump_to_surface = (float)p->start_pump_s - current_pump;
-            if (pump_to_surface > 0.5f) {
-                pump_run(+1, (uint32_t)(pump_to_surface + 0.5f));
-            } else if (pump_to_surface < -0.5f) {
-                pump_run(-1, (uint32_t)(-pump_to_surface + 0.5f));
-            }
-            
-            /* Return roll to neutral when reaching surface */
-            float current_roll = motor_get_position_sec(MOTOR_ROLL);
-            float roll_delta = (float)p->start_roll_s - current_roll;
-            if (fabsf(roll_delta) > 0.5f) {
-                int dir = (roll_delta > 0) ? +1 : -1;
-                uint32_t duration = (uint32_t)(fabsf(roll_delta) + 0.5f);
-                motor_run(MOTOR_ROLL, dir, duration);
-                app_printk("[ROLL] RETURN: surfacing, returning roll to neutral (%.1fs→0.0s, duration=%us)\r\n",
-                           current_roll, duration);
-            }
-            
-            for (int j=0; j<5; j++) {
-                k_sleep(K_SECONDS(1));
-                bmp180_read_pa(&internal_pa);
-                hmc6343_read(&head,&pitch,&roll);
-                app_printk("[SENS] IntP=%d Pa, SimDepth=0.00m, H=%.1f,R=%.1f,P=%.1f\r\n",
-                           internal_pa, head, roll, pitch);
-            }
-            break;
-        }
-        
-        k_sleep(K_SECONDS(1));
+    switch (st) {
+    case DIVE_ST_DESCEND:
+        sim_depth_set_rate(sim, SIM_DIVE_RATE_M_S, at_surface);
+        break;
+    case DIVE_ST_INFLECT:
+    case DIVE_ST_ABORT:
+        sim_depth_set_rate(sim, SIM_CLIMB_RATE_M_S, false);
+        break;
+    case DIVE_ST_SURFACE:
+        sim->depth_m = 0.0;
+        sim_depth_set_rate(sim, 0.0, true);
+        break;
+    default:
+        break;
     }
 }
 
+static const struct deploy_src simulate_src = {
+    .tag = "SIMULATE",
+    .depth_tag = "SimDepth",
+    .read = simulate_src_read,
+    .gps = simulate_src_gps,
+    .trim = simulate_src_trim,
+    .learn_trim = false,           /* fixed model rates would only drift it */
+    .checkpoint = false,           /* the depth model does not survive a reset */
+};
+
 void simulate_start(void)
 {
+    static struct deploy_run run;
     struct app_params *p = app_params_get();
 
     app_printk("[SIMULATE] starting simulation sequence (pressure sensor simulated)\r\n");
+    k_event_clear(&deploy_evt, DEPLOY_EVT_ABORT);
 
-    double surface_pa = 101325.0;  /* Sea level reference */
-    app_printk("[SIMULATE] simulated surface pressure: %.3f kPa\r\n", surface_pa / 1000.0);
+    memset(&run, 0, sizeof(run));
+    run.src = &simulate_src;
+    run.base = p;
+    run.surface_pa = 101325.0;  /* Sea level reference */
+    app_printk("[SIMULATE] simulated surface pressure: %.3f kPa\r\n", run.surface_pa / 1000.0);
 
-    float start_pitch_pos_s = motor_get_position_sec(MOTOR_PITCH);
-    float start_roll_pos_s = motor_get_position_sec(MOTOR_ROLL);
-    float start_pump_pos_s = pump_get_position_sec();
     app_printk("[SIMULATE] starting positions: pitch=%.1fs, roll=%.1fs, pump=%.1fs\r\n",
-               start_pitch_pos_s, start_roll_pos_s, start_pump_pos_s);
+               actuator_pos_s(DIVE_ACT_PITCH), actuator_pos_s(DIVE_ACT_ROLL),
+               actuator_pos_s(DIVE_ACT_PUMP));
 
     /* Initial wait */
     uint32_t wait_s = (uint32_t)p->deploy_wait_s;
-    app_printk("[SIMULATE] waiting %us before first dive\r\n", wait_s);
-    for (uint32_t i = 0; i < wait_s; ++i) {
-        k_sleep(K_SECONDS(1));
+    app_printk("[SIMULATE] waiting %us before first dive ('abort' to cancel)\r\n", wait_s);
+    if (abortable_sleep((int64_t)wait_s * 1000)) {
+        app_printk("[SIMULATE] aborted before first dive (%s)\r\n", abort_reason);
+        return;
     }
 
     /* Acquire simulated GPS fix before dive */
     app_printk("[SIMULATE] acquiring simulated GPS fix before dive\r\n");
-    k_sleep(K_SECONDS(2));
-    app_printk("[GPS] acquired (simulated)\r\n");
+    simulate_src_gps(&run);
 
-    /* Main dive/climb loop */
-    while (1) {
-        simulate_dive_cycle(p, surface_pa);
-
-        /* After climb, get simulated GPS fix */
-        app_printk("[SIMULATE] acquired surface position, getting simulated GPS fix\r\n");
-        k_sleep(K_SECONDS(2));
-        app_printk("[GPS] acquired (simulated)\r\n");
-
-        /* Wait 10 seconds for user to press ENTER to stop, else auto-restart dive */
-        app_printk("[SIMULATE] press ENTER within 10 seconds to stop, or will start another dive...\r\n");
-        int64_t wait_start = k_uptime_get();
-        bool enter_pressed = false;
-        
-        while (k_uptime_get() - wait_start < 10000) {  /* 10 second timeout */
-            char line[128];
-            if (net_console_poll_line(line, sizeof(line), K_MSEC(500))) {
-                if (line[0] == '\0' || line[0] == '\r' || line[0] == '\n') {
-                    enter_pressed = true;
-                    break;
-                }
-            }
-            k_sleep(K_MSEC(100));
-        }
-
-        if (enter_pressed) {
-            app_printk("[SIMULATE] user requested stop\r\n");
-            break;
-        }
-
-        app_printk("[SIMULATE] no user input, starting another dive cycle\r\n");
-    }
+    deploy_run_mission(&run, NULL);
 
+    flash_log_sync();
     app_printk("[SIMULATE] simulation complete, returning to menu\r\n");
 }
 
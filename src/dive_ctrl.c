@@ -0,0 +1,283 @@
+/* dive_ctrl.c - dive/climb decision logic (no Zephyr dependencies) */
+#include <math.h>
+#include <stddef.h>
+
+#include "dive_ctrl.h"
+
+/* Alpha-beta filter gains for the 1 Hz depth stream */
+#define VZ_ALPHA 0.5f
+#define VZ_BETA  0.15f
+
+/* Inflection learning */
+#define INFLECT_MIN_VZ_M_S  0.05f   /* too slow to learn a lead from */
+#define INFLECT_LEAD_GAIN   0.5f    /* EWMA weight of a new measurement */
+#define INFLECT_LEAD_MAX_S  60.0f
+
+double dive_depth_from_pa(double external_pa, double surface_pa)
+{
+    if (surface_pa <= 0.0) {
+        return 0.0;
+    }
+    double depth_m = (external_pa - surface_pa) / (SEA_WATER_DENSITY_KG_M3 * GRAVITY_M_S2);
+    return (depth_m < 0.0) ? 0.0 : depth_m;
+}
+
+/* Returns positive for starboard (right) turn, negative for port (left) turn */
+float dive_heading_delta(float current_deg, float desired_deg)
+{
+    float delta = desired_deg - current_deg;
+    while (delta > 180.0f) delta -= 360.0f;
+    while (delta < -180.0f) delta += 360.0f;
+    return delta;
+}
+
+void dive_ctrl_begin_phase(struct dive_ctrl *c, bool dive_phase, int64_t now_ms)
+{
+    c->dive_phase = dive_phase;
+    c->phase_start_ms = now_ms;
+    c->last_heading_ms = now_ms;
+    c->heading_err_deg = 0.0f;
+    /* Roll sense flips between dive and climb, so the integral restarts */
+    c->heading_integ = 0.0f;
+}
+
+bool dive_ctrl_move_to(enum dive_actuator act, float target_s, float pos_s,
+                       struct dive_cmd *out)
+{
+    float delta = target_s - pos_s;
+    if (fabsf(delta) <= DIVE_TRIM_TOLERANCE_S) {
+        return false;
+    }
+    out->act = act;
+    out->reason = DIVE_CMD_TRIM;
+    out->dir = (delta > 0) ? +1 : -1;
+    out->duration_ms = (uint32_t)(fabsf(delta) * 1000.0f + 0.5f);
+    out->target_s = target_s;
+    return true;
+}
+
+/* Millisecond roll move towards target_s unless inside the deadband */
+static bool roll_move(float target_s, float roll_pos_s, const struct app_params *p,
+                      struct dive_cmd *out)
+{
+    float delta = target_s - roll_pos_s;
+    uint32_t delta_ms = (uint32_t)(fabsf(delta) * 1000.0f + 0.5f);
+    if (delta_ms == 0 || delta_ms < p->roll_deadband_ms) {
+        return false;
+    }
+    out->act = DIVE_ACT_ROLL;
+    out->dir = (delta > 0) ? +1 : -1;
+    out->duration_ms = delta_ms;
+    out->target_s = target_s;
+    return true;
+}
+
+bool dive_ctrl_roll_neutral(float roll_pos_s, const struct app_params *p,
+                            struct dive_cmd *out)
+{
+    if (!roll_move((float)p->start_roll_s, roll_pos_s, p, out)) {
+        return false;
+    }
+    out->reason = DIVE_CMD_TRIM;
+    return true;
+}
+
+bool dive_ctrl_heading(struct dive_ctrl *c, const struct dive_sample *s,
+                       float roll_pos_s, const struct app_params *p,
+                       struct dive_cmd *out)
+{
+    int64_t period_ms = (int64_t)p->heading_period_s * 1000LL;
+    int64_t dt_ms = s->t_ms - c->last_heading_ms;
+    if (dt_ms < period_ms) {
+        return false;
+    }
+    c->last_heading_ms = s->t_ms;
+
+    float err = dive_heading_delta(s->heading_deg, (float)p->desired_heading_deg);
+    float limit = (float)p->max_roll_s;
+    float integ = c->heading_integ + err * ((float)dt_ms / 1000.0f);
+    float u = p->heading_kp * err + p->heading_ki * integ;
+
+    /* Anti-windup: freeze the integral while saturated in the error's direction */
+    if (u > limit) {
+        u = limit;
+        if (err < 0.0f) c->heading_integ = integ;
+    } else if (u < -limit) {
+        u = -limit;
+        if (err > 0.0f) c->heading_integ = integ;
+    } else {
+        c->heading_integ = integ;
+    }
+    c->heading_err_deg = err;
+
+    /* Positive error = turn starboard: bank to port (negative roll) when
+     * diving, to starboard (positive roll) when climbing */
+    float target = (float)p->start_roll_s + (c->dive_phase ? -u : u);
+    c->roll_target_s = target;
+
+    if (!roll_move(target, roll_pos_s, p, out)) {
+        return false;
+    }
+    out->reason = DIVE_CMD_HEADING;
+    return true;
+}
+
+void dive_vz_reset(struct dive_vz *f)
+{
+    f->valid = false;
+    f->t_ms = 0;
+    f->depth_m = 0.0f;
+    f->vz_m_s = 0.0f;
+}
+
+void dive_vz_update(struct dive_vz *f, const struct dive_sample *s)
+{
+    if (!f->valid) {
+        f->valid = true;
+        f->t_ms = s->t_ms;
+        f->depth_m = s->depth_m;
+        f->vz_m_s = 0.0f;
+        return;
+    }
+
+    float dt = (float)(s->t_ms - f->t_ms) / 1000.0f;
+    if (dt <= 0.0f) {
+        return;
+    }
+    f->t_ms = s->t_ms;
+
+    float predicted = f->depth_m + f->vz_m_s * dt;
+    float residual = s->depth_m - predicted;
+    f->depth_m = predicted + VZ_ALPHA * residual;
+    f->vz_m_s += (VZ_BETA / dt) * residual;
+}
+
+void dive_inflect_init(struct dive_inflect *in, const struct app_params *p)
+{
+    in->lead_s = (float)p->inflect_lead_ms / 1000.0f;
+    in->cycles_learned = 0;
+    in->active = false;
+}
+
+bool dive_inflect_due(const struct dive_inflect *in, const struct dive_vz *vz,
+                      const struct dive_sample *s, const struct app_params *p,
+                      float *predicted_m)
+{
+    *predicted_m = s->depth_m;
+    if (p->inflect_lead_ms == 0 || !vz->valid || vz->vz_m_s <= 0.0f) {
+        return dive_ctrl_target_reached(s, p);
+    }
+    *predicted_m = s->depth_m + vz->vz_m_s * in->lead_s;
+    return *predicted_m >= p->dive_depth_m;
+}
+
+bool dive_inflect_turn_due(const struct dive_inflect *in, const struct dive_vz *vz,
+                           const struct dive_sample *s, const struct app_params *p,
+                           float *predicted_m)
+{
+    *predicted_m = s->depth_m;
+    if (p->inflect_lead_ms != 0 && vz->valid && vz->vz_m_s < 0.0f) {
+        *predicted_m = s->depth_m + vz->vz_m_s * in->lead_s;
+    }
+    return *predicted_m <= p->yoyo_min_depth_m;
+}
+
+void dive_inflect_begin(struct dive_inflect *in, const struct dive_vz *vz,
+                        const struct dive_sample *s)
+{
+    in->active = true;
+    in->inflect_ms = s->t_ms;
+    in->inflect_depth_m = s->depth_m;
+    in->inflect_vz_m_s = vz->valid ? vz->vz_m_s : 0.0f;
+    in->apex_ms = s->t_ms;
+    in->apex_depth_m = s->depth_m;
+}
+
+void dive_inflect_track(struct dive_inflect *in, const struct dive_sample *s)
+{
+    if (in->active && s->depth_m > in->apex_depth_m) {
+        in->apex_depth_m = s->depth_m;
+        in->apex_ms = s->t_ms;
+    }
+}
+
+bool dive_inflect_learn(struct dive_inflect *in)
+{
+    if (!in->active) {
+        return false;
+    }
+    in->active = false;
+    if (in->inflect_vz_m_s < INFLECT_MIN_VZ_M_S) {
+        return false;
+    }
+
+    float measured = (in->apex_depth_m - in->inflect_depth_m) / in->inflect_vz_m_s;
+    if (measured < 0.0f) measured = 0.0f;
+    if (measured > INFLECT_LEAD_MAX_S) measured = INFLECT_LEAD_MAX_S;
+
+    /* First measurement replaces the configured guess outright */
+    if (in->cycles_learned == 0) {
+        in->lead_s = measured;
+    } else {
+        in->lead_s += INFLECT_LEAD_GAIN * (measured - in->lead_s);
+    }
+    in->cycles_learned++;
+    return true;
+}
+
+bool dive_ctrl_target_reached(const struct dive_sample *s, const struct app_params *p)
+{
+    return s->depth_m >= p->dive_depth_m;
+}
+
+int64_t dive_state_timeout_ms(enum dive_state st, const struct app_params *p)
+{
+    switch (st) {
+    case DIVE_ST_SURFACE_TRIM:
+    case DIVE_ST_INFLECT:  return (int64_t)p->trim_timeout_s * 1000LL;
+    case DIVE_ST_DESCEND:  return (int64_t)p->dive_timeout_min * 60LL * 1000LL;
+    case DIVE_ST_ASCEND:
+    case DIVE_ST_ABORT:    return (int64_t)p->climb_timeout_min * 60LL * 1000LL;
+    case DIVE_ST_SURFACE:  return (int64_t)p->surface_dwell_s * 1000LL;
+    case DIVE_ST_GPS:      return (int64_t)p->gps_timeout_s * 1000LL;
+    case DIVE_ST_COMMS:    return (int64_t)p->comms_window_s * 1000LL;
+    default:               return 0;
+    }
+}
+
+bool dive_state_timed_out(enum dive_state st, int64_t entered_ms, int64_t now_ms,
+                          const struct app_params *p)
+{
+    int64_t limit_ms = dive_state_timeout_ms(st, p);
+    return limit_ms > 0 && (now_ms - entered_ms) >= limit_ms;
+}
+
+const char *dive_state_name(enum dive_state st)
+{
+    switch (st) {
+    case DIVE_ST_SURFACE_TRIM: return "SURFACE_TRIM";
+    case DIVE_ST_DESCEND:      return "DESCEND";
+    case DIVE_ST_INFLECT:      return "INFLECT";
+    case DIVE_ST_ASCEND:       return "ASCEND";
+    case DIVE_ST_SURFACE:      return "SURFACE";
+    case DIVE_ST_GPS:          return "GPS";
+    case DIVE_ST_COMMS:        return "COMMS";
+    case DIVE_ST_ABORT:        return "ABORT";
+    default:                   return "?";
+    }
+}
+
+bool dive_ctrl_surface_reached(const struct dive_sample *s)
+{
+    return s->depth_m < SURFACE_DEPTH_M;
+}
+
+const char *dive_actuator_name(enum dive_actuator act)
+{
+    switch (act) {
+    case DIVE_ACT_ROLL:  return "ROLL";
+    case DIVE_ACT_PITCH: return "PITCH";
+    case DIVE_ACT_PUMP:  return "PUMP";
+    default:             return "?";
+    }
+}
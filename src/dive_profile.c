@@ -0,0 +1,154 @@
+/* dive_profile.c - depth-binned profile of a cycle (no Zephyr dependencies) */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dive_profile.h"
+
+#define DEG_TO_RAD (3.14159265f / 180.0f)
+
+static const char *const dir_name[DIVE_PROF__COUNT] = { "down", "up" };
+
+void dive_profile_begin(struct dive_profile *pf, uint32_t cycle, float bin_m)
+{
+    memset(pf, 0, sizeof(*pf));
+    pf->cycle = cycle;
+    pf->bin_m = (bin_m > 0.0f) ? bin_m : 0.0f;
+}
+
+/* Fold b into a, weighting the means by their counts */
+static void acc_merge(struct dive_profile_acc *a, const struct dive_profile_acc *b)
+{
+    uint32_t n = a->n + b->n;
+
+    if (b->n == 0) {
+        return;
+    }
+    float wa = (float)a->n / (float)n;
+    float wb = (float)b->n / (float)n;
+    a->temp_c = a->temp_c * wa + b->temp_c * wb;
+    a->pitch_deg = a->pitch_deg * wa + b->pitch_deg * wb;
+    a->roll_deg = a->roll_deg * wa + b->roll_deg * wb;
+    a->hdg_x = a->hdg_x * wa + b->hdg_x * wb;
+    a->hdg_y = a->hdg_y * wa + b->hdg_y * wb;
+    a->n = n;
+}
+
+/* Double the bin size: bins 2i and 2i+1 become bin i */
+static void widen(struct dive_profile *pf)
+{
+    for (int d = 0; d < DIVE_PROF__COUNT; d++) {
+        struct dive_profile_acc *acc = pf->acc[d];
+        for (int i = 0; i < DIVE_PROFILE_BINS / 2; i++) {
+            struct dive_profile_acc m = acc[2 * i];
+            acc_merge(&m, &acc[2 * i + 1]);
+            acc[i] = m;
+        }
+        memset(&acc[DIVE_PROFILE_BINS / 2], 0,
+               sizeof(acc[0]) * (DIVE_PROFILE_BINS - DIVE_PROFILE_BINS / 2));
+    }
+    pf->bin_m *= 2.0f;
+}
+
+void dive_profile_sample(struct dive_profile *pf, enum dive_state st,
+                         const struct dive_sample *s)
+{
+    enum dive_profile_dir dir;
+
+    if (pf->bin_m <= 0.0f) {
+        return;
+    }
+    if (st == DIVE_ST_DESCEND || st == DIVE_ST_INFLECT) {
+        dir = DIVE_PROF_DOWN;
+    } else if (st == DIVE_ST_ASCEND || st == DIVE_ST_ABORT) {
+        dir = DIVE_PROF_UP;
+    } else {
+        return;
+    }
+
+    float depth = (s->depth_m > 0.0f) ? s->depth_m : 0.0f;
+    while (depth >= pf->bin_m * (float)DIVE_PROFILE_BINS) {
+        widen(pf);
+    }
+
+    struct dive_profile_acc *a = &pf->acc[dir][(int)(depth / pf->bin_m)];
+    float h = s->heading_deg * DEG_TO_RAD;
+
+    a->n++;
+    float k = 1.0f / (float)a->n;
+    a->temp_c += (s->temp_c - a->temp_c) * k;
+    a->pitch_deg += (s->pitch_deg - a->pitch_deg) * k;
+    a->roll_deg += (s->roll_deg - a->roll_deg) * k;
+    a->hdg_x += (cosf(h) - a->hdg_x) * k;
+    a->hdg_y += (sinf(h) - a->hdg_y) * k;
+}
+
+static int16_t fix_i16(float v, float scale)
+{
+    float x = v * scale;
+    x += (x < 0.0f) ? -0.5f : 0.5f;
+    if (x < -32768.0f) return -32768;
+    if (x > 32767.0f) return 32767;
+    return (int16_t)x;
+}
+
+bool dive_profile_get(const struct dive_profile *pf, enum dive_profile_dir dir,
+                      unsigned int i, struct dive_profile_bin *out)
+{
+    if ((unsigned)dir >= DIVE_PROF__COUNT || i >= DIVE_PROFILE_BINS) {
+        return false;
+    }
+    const struct dive_profile_acc *a = &pf->acc[dir][i];
+    if (a->n == 0) {
+        return false;
+    }
+
+    float hdg = atan2f(a->hdg_y, a->hdg_x) / DEG_TO_RAD;
+    if (hdg < 0.0f) {
+        hdg += 360.0f;
+    }
+    out->depth_dm = (uint16_t)fminf(((float)i + 0.5f) * pf->bin_m * 10.0f + 0.5f, 65535.0f);
+    out->n = (a->n > UINT16_MAX) ? UINT16_MAX : (uint16_t)a->n;
+    out->temp_cc = fix_i16(a->temp_c, 100.0f);
+    out->pitch_ddeg = fix_i16(a->pitch_deg, 10.0f);
+    out->roll_ddeg = fix_i16(a->roll_deg, 10.0f);
+    out->heading_ddeg = (uint16_t)((int)(hdg * 10.0f + 0.5f) % 3600);
+    return true;
+}
+
+unsigned int dive_profile_count(const struct dive_profile *pf, enum dive_profile_dir dir,
+                                uint32_t *samples)
+{
+    unsigned int bins = 0;
+    uint32_t n = 0;
+
+    for (int i = 0; i < DIVE_PROFILE_BINS; i++) {
+        if (pf->acc[dir][i].n != 0) {
+            bins++;
+            n += pf->acc[dir][i].n;
+        }
+    }
+    if (samples) {
+        *samples = n;
+    }
+    return bins;
+}
+
+int dive_profile_format_head(const struct dive_profile *pf, char *buf, size_t len)
+{
+    uint32_t down_n, up_n;
+    unsigned int down = dive_profile_count(pf, DIVE_PROF_DOWN, &down_n);
+    unsigned int up = dive_profile_count(pf, DIVE_PROF_UP, &up_n);
+
+    return snprintf(buf, len, "cycle %u: %.2fm bins, down %u bins %u samples, up %u bins %u samples",
+                    (unsigned)pf->cycle, (double)pf->bin_m, down, (unsigned)down_n,
+                    up, (unsigned)up_n);
+}
+
+int dive_profile_format_bin(enum dive_profile_dir dir, const struct dive_profile_bin *b,
+                            char *buf, size_t len)
+{
+    return snprintf(buf, len, "%s %.1fm n=%u T=%.2fC P=%.1f R=%.1f H=%.1f",
+                    dir_name[dir], b->depth_dm / 10.0, b->n, b->temp_cc / 100.0,
+                    b->pitch_ddeg / 10.0, b->roll_ddeg / 10.0, b->heading_ddeg / 10.0);
+}
@@ -0,0 +1,141 @@
+/* dive_stats.c - per-cycle dive statistics (no Zephyr dependencies) */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dive_stats.h"
+
+void dive_stat_reset(struct dive_stat *st)
+{
+    memset(st, 0, sizeof(*st));
+}
+
+void dive_stat_add(struct dive_stat *st, float x)
+{
+    if (st->n == 0) {
+        st->min = st->max = x;
+    } else {
+        if (x < st->min) st->min = x;
+        if (x > st->max) st->max = x;
+    }
+    st->n++;
+    float d = x - st->mean;
+    st->mean += d / (float)st->n;
+    st->m2 += d * (x - st->mean);
+}
+
+float dive_stat_sd(const struct dive_stat *st)
+{
+    if (st->n < 2) {
+        return 0.0f;
+    }
+    return sqrtf(st->m2 / (float)(st->n - 1));
+}
+
+void dive_stats_begin(struct dive_cycle_stats *cs, uint32_t cycle, int64_t now_ms)
+{
+    memset(cs, 0, sizeof(*cs));
+    cs->cycle = cycle;
+    cs->start_ms = now_ms;
+}
+
+void dive_stats_sample(struct dive_cycle_stats *cs, enum dive_state st,
+                       const struct dive_sample *s, const struct dive_vz *vz,
+                       const struct app_params *p)
+{
+    bool moving = (st == DIVE_ST_DESCEND || st == DIVE_ST_INFLECT || st == DIVE_ST_ASCEND ||
+                   st == DIVE_ST_ABORT);
+
+    if (!moving) {
+        return;
+    }
+    dive_stat_add(&cs->depth_m, s->depth_m);
+    if (st != DIVE_ST_INFLECT) {
+        dive_stat_add(&cs->heading_err_deg,
+                      dive_heading_delta(s->heading_deg, (float)p->desired_heading_deg));
+    }
+    if (st == DIVE_ST_DESCEND) {
+        dive_stat_add(&cs->dive_pitch_deg, fabsf(s->pitch_deg));
+    } else if (st == DIVE_ST_ASCEND) {
+        dive_stat_add(&cs->climb_pitch_deg, fabsf(s->pitch_deg));
+    }
+    if (vz == NULL || !vz->valid) {
+        return;
+    }
+    if (st == DIVE_ST_DESCEND) {
+        dive_stat_add(&cs->descent_m_s, vz->vz_m_s);
+    } else if (st == DIVE_ST_ASCEND || st == DIVE_ST_ABORT) {
+        dive_stat_add(&cs->ascent_m_s, -vz->vz_m_s);
+    }
+}
+
+void dive_stats_state_time(struct dive_cycle_stats *cs, enum dive_state st, uint32_t ms)
+{
+    if ((unsigned)st < DIVE_ST__COUNT) {
+        cs->state_ms[st] += ms;
+    }
+}
+
+/* Scale and clamp into a uint16 field */
+static uint16_t fix_u16(float v, float scale)
+{
+    float x = v * scale + 0.5f;
+    if (x < 0.0f) return 0;
+    if (x > 65535.0f) return 65535;
+    return (uint16_t)x;
+}
+
+static int16_t fix_i16(float v, float scale)
+{
+    float x = v * scale;
+    x += (x < 0.0f) ? -0.5f : 0.5f;
+    if (x < -32768.0f) return -32768;
+    if (x > 32767.0f) return 32767;
+    return (int16_t)x;
+}
+
+void dive_stats_summarize(const struct dive_cycle_stats *cs, int64_t now_ms,
+                          struct dive_summary *out)
+{
+    const struct dive_stat *h = &cs->heading_err_deg;
+
+    memset(out, 0, sizeof(*out));
+    out->cycle = cs->cycle;
+    out->duration_s = (uint32_t)((now_ms - cs->start_ms + 500) / 1000);
+    out->max_depth_cm = fix_u16(cs->depth_m.max, 100.0f);
+    out->descent_mm_s = fix_u16(cs->descent_m_s.mean, 1000.0f);
+    out->descent_sd_mm_s = fix_u16(dive_stat_sd(&cs->descent_m_s), 1000.0f);
+    out->ascent_mm_s = fix_u16(cs->ascent_m_s.mean, 1000.0f);
+    out->ascent_sd_mm_s = fix_u16(dive_stat_sd(&cs->ascent_m_s), 1000.0f);
+    out->hdg_err_ddeg = fix_i16(h->mean, 10.0f);
+    out->hdg_err_sd_ddeg = fix_u16(dive_stat_sd(h), 10.0f);
+    out->hdg_err_max_ddeg = fix_u16(fmaxf(fabsf(h->min), fabsf(h->max)), 10.0f);
+    for (int i = 0; i < DIVE_ST__COUNT; i++) {
+        out->state_s[i] = fix_u16((float)cs->state_ms[i], 0.001f);
+    }
+}
+
+int dive_summary_format(const struct dive_summary *r, char *buf, size_t len)
+{
+    int n = snprintf(buf, len,
+                    "cycle %u: max %.2fm in %us, down %.3f sd %.3fm/s, up %.3f sd %.3fm/s, "
+                    "hdg err %.1f sd %.1f max %.1fdeg, s: trim %u down %u infl %u up %u surf %u gps %u, "
+                    "roll %.1fs %ux %ur, pitch %.1fs %ux %ur, pump %.1fs %ux %ur, %umWh",
+                    (unsigned)r->cycle, r->max_depth_cm / 100.0, (unsigned)r->duration_s,
+                    r->descent_mm_s / 1000.0, r->descent_sd_mm_s / 1000.0,
+                    r->ascent_mm_s / 1000.0, r->ascent_sd_mm_s / 1000.0,
+                    r->hdg_err_ddeg / 10.0, r->hdg_err_sd_ddeg / 10.0, r->hdg_err_max_ddeg / 10.0,
+                    r->state_s[DIVE_ST_SURFACE_TRIM], r->state_s[DIVE_ST_DESCEND],
+                    r->state_s[DIVE_ST_INFLECT], r->state_s[DIVE_ST_ASCEND],
+                    r->state_s[DIVE_ST_SURFACE], r->state_s[DIVE_ST_GPS],
+                    r->act_on_ds[DIVE_ACT_ROLL] / 10.0, r->act_starts[DIVE_ACT_ROLL],
+                    r->act_reversals[DIVE_ACT_ROLL],
+                    r->act_on_ds[DIVE_ACT_PITCH] / 10.0, r->act_starts[DIVE_ACT_PITCH],
+                    r->act_reversals[DIVE_ACT_PITCH],
+                    r->act_on_ds[DIVE_ACT_PUMP] / 10.0, r->act_starts[DIVE_ACT_PUMP],
+                    r->act_reversals[DIVE_ACT_PUMP], r->energy_mwh);
+    if (r->state_s[DIVE_ST_ABORT] != 0 && n >= 0 && (size_t)n < len) {
+        n += snprintf(buf + n, len - (size_t)n, ", ABORT ascent %us", r->state_s[DIVE_ST_ABORT]);
+    }
+    return n;
+}
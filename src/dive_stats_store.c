@@ -0,0 +1,117 @@
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <string.h>
+
+#include "dive_stats.h"
+#include "app_print.h"
+
+#define DIVE_STATS_SETTINGS_KEY "stats/ring"
+#define DIVE_STATS_VERSION 3
+
+/* Last DIVE_STATS_KEEP summaries, oldest overwritten */
+struct dive_stats_ring {
+    uint8_t version;
+    uint8_t count;
+    uint8_t head;                  /* next slot to write */
+    uint8_t reserved;
+    struct dive_summary rec[DIVE_STATS_KEEP];
+};
+
+static struct dive_stats_ring g_ring;
+
+/* settings handler: load the ring from NVS */
+static int dive_stats_settings_set(const char *key, size_t len,
+                                   settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+
+    if (!settings_name_steq(key, "ring", &next) || next) {
+        return -ENOENT;
+    }
+    if (len != sizeof(g_ring)) {
+        app_printk("[STATS] stored ring size mismatch (%zu != %zu), discarding\r\n",
+                   len, sizeof(g_ring));
+        return -EINVAL;
+    }
+
+    struct dive_stats_ring r;
+    int rc = read_cb(cb_arg, &r, len);
+    if (rc < 0) {
+        app_printk("[STATS] read_cb failed: %d\r\n", rc);
+        return rc;
+    }
+    if (r.version != DIVE_STATS_VERSION || r.count > DIVE_STATS_KEEP || r.head >= DIVE_STATS_KEEP) {
+        app_printk("[STATS] stored ring invalid, discarding\r\n");
+        return -EINVAL;
+    }
+    g_ring = r;
+    return 0;
+}
+
+static int dive_stats_export(int (*cb)(const char *name,
+                                       const void *value, size_t val_len))
+{
+    return cb("ring", &g_ring, sizeof(g_ring));
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(dive_stats, "stats",
+                               NULL, dive_stats_settings_set,
+                               NULL, dive_stats_export);
+
+/* Call after app_params_init(), which brings up the settings subsystem */
+int dive_stats_init(void)
+{
+    memset(&g_ring, 0, sizeof(g_ring));
+    g_ring.version = DIVE_STATS_VERSION;
+
+    int rc = settings_load_subtree("stats");
+    if (rc != 0 && rc != -ENOENT) {
+        app_printk("[STATS] load failed: %d\r\n", rc);
+        memset(&g_ring, 0, sizeof(g_ring));
+        g_ring.version = DIVE_STATS_VERSION;
+    }
+    return 0;
+}
+
+int dive_stats_save(const struct dive_summary *r)
+{
+    g_ring.rec[g_ring.head] = *r;
+    g_ring.head = (uint8_t)((g_ring.head + 1U) % DIVE_STATS_KEEP);
+    if (g_ring.count < DIVE_STATS_KEEP) {
+        g_ring.count++;
+    }
+
+    int rc = settings_save_one(DIVE_STATS_SETTINGS_KEY, &g_ring, sizeof(g_ring));
+    if (rc != 0) {
+        app_printk("[STATS] save to NVS failed: %d\r\n", rc);
+    }
+    return rc;
+}
+
+bool dive_stats_get(unsigned int i, struct dive_summary *out)
+{
+    if (i >= g_ring.count) {
+        return false;
+    }
+    unsigned int slot = (g_ring.head + DIVE_STATS_KEEP - 1U - i) % DIVE_STATS_KEEP;
+    *out = g_ring.rec[slot];
+    return true;
+}
+
+void dive_stats_print(void)
+{
+    struct dive_summary r;
+    char line[384];
+
+    if (g_ring.count == 0) {
+        app_printk("[STATS] no cycles recorded\r\n");
+        return;
+    }
+    /* Oldest first so the newest ends up next to the prompt */
+    for (int i = (int)g_ring.count - 1; i >= 0; i--) {
+        if (dive_stats_get((unsigned int)i, &r)) {
+            dive_summary_format(&r, line, sizeof(line));
+            app_printk("[STATS] %s\r\n", line);
+        }
+    }
+}
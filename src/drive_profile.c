@@ -0,0 +1,103 @@
+/* drive_profile.c - soft-start / soft-stop speed profile (no Zephyr dependencies) */
+#include <math.h>
+
+#include "drive_profile.h"
+
+void drive_limits_full(struct drive_limits *lim)
+{
+    lim->duty_min_pm = DRIVE_DUTY_FULL;
+    lim->duty_max_pm = DRIVE_DUTY_FULL;
+    lim->ramp_ms = 0;
+}
+
+void drive_profile_plan(const struct drive_limits *lim, uint32_t distance_ms,
+                        struct drive_profile *out)
+{
+    uint32_t m = lim->duty_max_pm;
+    if (m == 0 || m > DRIVE_DUTY_FULL) {
+        m = DRIVE_DUTY_FULL;
+    }
+    uint32_t s = (lim->duty_min_pm < m) ? lim->duty_min_pm : m;
+    uint32_t r = lim->ramp_ms;
+
+    out->start_pm = (uint16_t)s;
+    out->peak_pm = (uint16_t)m;
+
+    if (r == 0 || s == m) {
+        /* No ramp: straight to the limit */
+        out->start_pm = (uint16_t)m;
+        out->ramp_ms = 0;
+        out->cruise_ms = (distance_ms == 0) ? DRIVE_CRUISE_FOREVER
+                                            : (uint32_t)(((uint64_t)distance_ms * DRIVE_DUTY_FULL + m / 2) / m);
+        return;
+    }
+    if (distance_ms == 0) {
+        out->ramp_ms = r;
+        out->cruise_ms = DRIVE_CRUISE_FOREVER;
+        return;
+    }
+
+    /* Travel in duty-ms (per mille x ms); one full ramp covers r*(s+m)/2 */
+    float d = (float)distance_ms * (float)DRIVE_DUTY_FULL;
+    float d_ramp = (float)r * (float)(s + m) * 0.5f;
+
+    if (d >= 2.0f * d_ramp) {
+        out->ramp_ms = r;
+        out->cruise_ms = (uint32_t)lroundf((d - 2.0f * d_ramp) / (float)m);
+        return;
+    }
+
+    /* Triangular: ramp for x ms to a lower peak, x from a*x^2 + 2*s*x = d */
+    float a = (float)(m - s) / (float)r;
+    float x = (-(float)s + sqrtf((float)s * (float)s + a * d)) / a;
+    out->ramp_ms = (uint32_t)lroundf(x);
+    out->peak_pm = (uint16_t)(s + (uint32_t)lroundf(a * x));
+    out->cruise_ms = 0;
+}
+
+uint32_t drive_profile_total_ms(const struct drive_profile *p)
+{
+    if (p->cruise_ms == DRIVE_CRUISE_FOREVER) {
+        return DRIVE_CRUISE_FOREVER;
+    }
+    return 2U * p->ramp_ms + p->cruise_ms;
+}
+
+uint16_t drive_profile_duty(const struct drive_profile *p, uint32_t t_ms)
+{
+    uint32_t span = (uint32_t)(p->peak_pm - p->start_pm);
+
+    if (t_ms < p->ramp_ms) {
+        return (uint16_t)(p->start_pm + span * t_ms / p->ramp_ms);
+    }
+    t_ms -= p->ramp_ms;
+    if (p->cruise_ms == DRIVE_CRUISE_FOREVER || t_ms < p->cruise_ms) {
+        return p->peak_pm;
+    }
+    t_ms -= p->cruise_ms;
+    if (t_ms < p->ramp_ms) {
+        return (uint16_t)(p->peak_pm - span * t_ms / p->ramp_ms);
+    }
+    return 0;
+}
+
+uint32_t drive_profile_next_ms(const struct drive_profile *p, uint32_t t_ms, uint32_t step_ms)
+{
+    uint32_t up_end = p->ramp_ms;
+
+    if (t_ms < up_end) {
+        return (t_ms + step_ms < up_end) ? t_ms + step_ms : up_end;
+    }
+    if (p->cruise_ms == DRIVE_CRUISE_FOREVER) {
+        return DRIVE_CRUISE_FOREVER;
+    }
+    uint32_t down_start = up_end + p->cruise_ms;
+    uint32_t end = down_start + p->ramp_ms;
+    if (t_ms < down_start) {
+        return down_start;
+    }
+    if (t_ms + step_ms < end) {
+        return t_ms + step_ms;
+    }
+    return DRIVE_CRUISE_FOREVER;   /* the stop timer ends the move */
+}
@@ -0,0 +1,348 @@
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <string.h>
+
+#include "flash_log.h"
+#include "dive_stats.h"
+#include "app_print.h"
+
+#define FLOG_SECTOR_SIZE    4096u
+#if FIXED_PARTITION_EXISTS(log_partition)
+#define FLOG_PARTITION      log_partition
+#define FLOG_OFFSET         0u
+#else
+/* NVS (settings) keeps the bottom of the storage partition */
+#define FLOG_PARTITION      storage_partition
+#define FLOG_OFFSET         ((uint32_t)CONFIG_SETTINGS_NVS_SECTOR_COUNT * FLOG_SECTOR_SIZE)
+#endif
+#define FLOG_MIN_SECTORS    3u
+#define FLOG_PER_SECTOR     (FLOG_SECTOR_SIZE / LOG_BLOCK_SIZE)
+#define FLOG_QUEUE_DEPTH    32
+#define FLOG_STACK_SIZE     1536
+#define FLOG_PRIO           10      /* below the deploy worker */
+#define FLOG_FLUSH_POLL_MS  500
+
+K_MSGQ_DEFINE(flog_q, sizeof(struct log_rec), FLOG_QUEUE_DEPTH, 4);
+
+/* Ring state; the writer thread, flushes and the console commands hold
+ * flog_lock */
+static K_MUTEX_DEFINE(flog_lock);
+static const struct flash_area *fa;
+static uint32_t n_sectors;
+static uint32_t head;               /* slot the next block goes to, next_seq % slots */
+static uint32_t first_seq;          /* block numbers */
+static uint32_t next_seq;
+static uint32_t next_sample;        /* sample number of the next record */
+static struct log_enc enc;          /* block being filled */
+static struct log_block scratch;    /* scan and print */
+static struct dive_stat write_us;
+static struct dive_stat erase_us;
+static struct dive_stat encode_us;
+static uint32_t coded_bytes;        /* payload and samples written since boot */
+static uint32_t coded_samples;
+
+static atomic_t ready;
+static atomic_t dropped;
+static atomic_t flush_req;
+
+static uint32_t slot_offset(uint32_t slot)
+{
+    return FLOG_OFFSET + slot * LOG_BLOCK_SIZE;
+}
+
+static int erase_sector(uint32_t sector)
+{
+    int64_t t0 = k_uptime_ticks();
+    int rc = flash_area_erase(fa, FLOG_OFFSET + sector * FLOG_SECTOR_SIZE, FLOG_SECTOR_SIZE);
+
+    dive_stat_add(&erase_us, (float)k_ticks_to_us_floor64(k_uptime_ticks() - t0));
+    return rc;
+}
+
+/* All 0xFF from slot to the end of its sector */
+static bool blank_from(uint32_t slot)
+{
+    uint32_t end = (slot / FLOG_PER_SECTOR + 1) * FLOG_PER_SECTOR;
+
+    for (; slot < end; slot++) {
+        const uint8_t *b = (const uint8_t *)&scratch;
+        if (flash_area_read(fa, slot_offset(slot), &scratch, sizeof(scratch)) != 0) {
+            return false;
+        }
+        for (size_t i = 0; i < sizeof(scratch); i++) {
+            if (b[i] != 0xFF) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* Oldest block still in flash. The sector ahead of the head is kept
+ * erased, the others are full once the ring has wrapped. */
+static void recount_first(void)
+{
+    uint32_t n = (n_sectors - 2U) * FLOG_PER_SECTOR + head % FLOG_PER_SECTOR;
+    first_seq = (next_seq > n) ? next_seq - n : 0;
+}
+
+/* Find the newest valid block; continue after it */
+static void scan(void)
+{
+    uint32_t slots = n_sectors * FLOG_PER_SECTOR;
+    bool found = false;
+
+    head = 0;
+    next_seq = 0;
+    next_sample = 0;
+    for (uint32_t slot = 0; slot < slots; slot++) {
+        if (flash_area_read(fa, slot_offset(slot), &scratch, sizeof(scratch)) != 0 ||
+            !log_block_valid(&scratch)) {
+            continue;
+        }
+        if (!found || scratch.h.seq >= next_seq) {
+            next_seq = scratch.h.seq + 1U;
+            next_sample = scratch.h.first + scratch.h.count;
+            head = (slot + 1U) % slots;
+            found = true;
+        }
+    }
+
+    /* A block torn by a reset: start on a fresh sector, skipping the
+     * sequence numbers of the slots left behind */
+    if (!blank_from(head)) {
+        uint32_t skip = FLOG_PER_SECTOR - head % FLOG_PER_SECTOR;
+        head = (head + skip) % slots;
+        next_seq += skip;
+        (void)erase_sector(head / FLOG_PER_SECTOR);
+    }
+    uint32_t ahead = (head / FLOG_PER_SECTOR + 1U) % n_sectors;
+    if (!blank_from(ahead * FLOG_PER_SECTOR)) {
+        (void)erase_sector(ahead);
+    }
+    recount_first();
+    log_enc_begin(&enc, next_sample);
+}
+
+/* Write the open block and start the next one */
+static void write_block(void)
+{
+    log_enc_seal(&enc, next_seq);
+    int64_t t0 = k_uptime_ticks();
+    int rc = flash_area_write(fa, slot_offset(head), &enc.blk, sizeof(enc.blk));
+    dive_stat_add(&write_us, (float)k_ticks_to_us_floor64(k_uptime_ticks() - t0));
+    if (rc != 0) {
+        atomic_add(&dropped, enc.blk.h.count);  /* the slot is skipped; the scan ignores it */
+    } else {
+        coded_bytes += enc.blk.h.len;
+        coded_samples += enc.blk.h.count;
+    }
+    next_seq++;
+    head = (head + 1U) % (n_sectors * FLOG_PER_SECTOR);
+
+    /* Into a new (already erased) sector: erase the next one now, dropping
+     * the oldest data, so the following writes never wait for it */
+    if (head % FLOG_PER_SECTOR == 0 &&
+        erase_sector((head / FLOG_PER_SECTOR + 1U) % n_sectors) != 0) {
+        app_printk("[FLOG] erase ahead of slot %u failed\r\n", head);
+    }
+    recount_first();
+    log_enc_begin(&enc, next_sample);
+}
+
+static void append(const struct log_rec *r)
+{
+    int64_t t0 = k_uptime_ticks();
+    bool added = log_enc_add(&enc, r);
+    dive_stat_add(&encode_us, (float)k_ticks_to_us_floor64(k_uptime_ticks() - t0));
+
+    if (!added) {
+        write_block();
+        (void)log_enc_add(&enc, r);    /* always fits a fresh block */
+    }
+    next_sample++;
+}
+
+static void flog_writer(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+    struct log_rec r;
+
+    for (;;) {
+        if (k_msgq_get(&flog_q, &r, K_MSEC(FLOG_FLUSH_POLL_MS)) == 0) {
+            k_mutex_lock(&flog_lock, K_FOREVER);
+            append(&r);
+            k_mutex_unlock(&flog_lock);
+        }
+        if (atomic_clear(&flush_req) != 0) {
+            flash_log_sync();
+        }
+    }
+}
+
+K_THREAD_DEFINE(flog_tx, FLOG_STACK_SIZE, flog_writer, NULL, NULL, NULL, FLOG_PRIO, 0, 0);
+
+int flash_log_init(void)
+{
+    int rc = flash_area_open(FIXED_PARTITION_ID(FLOG_PARTITION), &fa);
+    if (rc != 0) {
+        app_printk("[FLOG] cannot open log partition: %d\r\n", rc);
+        return rc;
+    }
+    if (fa->fa_size < FLOG_OFFSET + FLOG_MIN_SECTORS * FLOG_SECTOR_SIZE) {
+        app_printk("[FLOG] partition too small (%u bytes)\r\n", (uint32_t)fa->fa_size);
+        return -ENOSPC;
+    }
+    n_sectors = (uint32_t)(fa->fa_size - FLOG_OFFSET) / FLOG_SECTOR_SIZE;
+
+    k_mutex_lock(&flog_lock, K_FOREVER);
+    dive_stat_reset(&write_us);
+    dive_stat_reset(&erase_us);
+    dive_stat_reset(&encode_us);
+    scan();
+    k_mutex_unlock(&flog_lock);
+    atomic_set(&ready, 1);
+
+    app_printk("[FLOG] %u sectors, %u blocks logged, next sample %u\r\n",
+               n_sectors, next_seq - first_seq, next_sample);
+    return 0;
+}
+
+bool flash_log_put(const struct log_rec *r)
+{
+    if (!atomic_get(&ready) || k_msgq_put(&flog_q, r, K_NO_WAIT) != 0) {
+        atomic_inc(&dropped);
+        return false;
+    }
+    return true;
+}
+
+void flash_log_flush(void)
+{
+    atomic_set(&flush_req, 1);
+}
+
+void flash_log_sync(void)
+{
+    if (!atomic_get(&ready)) {
+        return;
+    }
+    k_mutex_lock(&flog_lock, K_FOREVER);
+    if (enc.blk.h.count > 0) {
+        write_block();
+    }
+    k_mutex_unlock(&flog_lock);
+}
+
+void flash_log_get_info(struct flash_log_info *out)
+{
+    k_mutex_lock(&flog_lock, K_FOREVER);
+    out->ready = atomic_get(&ready) != 0;
+    /* The sector ahead of the head is always erased */
+    out->capacity = (n_sectors > 0) ? (n_sectors - 1U) * FLOG_PER_SECTOR - 1U : 0;
+    out->first_seq = first_seq;
+    out->next_seq = next_seq;
+    out->next_sample = next_sample;
+    out->pending = enc.blk.h.count;
+    out->dropped = (uint32_t)atomic_get(&dropped);
+    k_mutex_unlock(&flog_lock);
+}
+
+void flash_log_print(void)
+{
+    struct flash_log_info info;
+    struct dive_stat w, e, c;
+    uint32_t bytes, samples;
+    struct log_rec last;
+    bool have_last = false;
+
+    flash_log_get_info(&info);
+    if (!info.ready) {
+        app_printk("[FLOG] not available\r\n");
+        return;
+    }
+
+    k_mutex_lock(&flog_lock, K_FOREVER);
+    w = write_us;
+    e = erase_us;
+    c = encode_us;
+    bytes = coded_bytes;
+    samples = coded_samples;
+    /* Newest sample on flash, through the same decoder the host uses */
+    if (next_seq > first_seq &&
+        flash_area_read(fa, slot_offset((next_seq - 1U) % (n_sectors * FLOG_PER_SECTOR)),
+                        &scratch, sizeof(scratch)) == 0 &&
+        log_block_valid(&scratch)) {
+        struct log_dec d;
+        log_dec_begin(&d, &scratch);
+        while (log_dec_next(&d, &last)) {
+            have_last = true;
+        }
+    }
+    k_mutex_unlock(&flog_lock);
+
+    app_printk("[FLOG] %u/%u blocks, oldest %u, next %u; next sample %u (%u unwritten), "
+               "%u dropped, %u queued\r\n",
+               info.next_seq - info.first_seq, info.capacity, info.first_seq, info.next_seq,
+               info.next_sample, info.pending, info.dropped, k_msgq_num_used_get(&flog_q));
+    if (samples > 0) {
+        app_printk("[FLOG] %.1f bytes/sample since boot (raw %u)\r\n",
+                   (double)bytes / (double)samples, LOG_REC_SIZE);
+    }
+    app_printk("[FLOG] encode n=%u mean %.0fus max %.0fus; write n=%u mean %.0fus max %.0fus; "
+               "erase n=%u mean %.0fus max %.0fus\r\n",
+               c.n, (double)c.mean, (double)c.max, w.n, (double)w.mean, (double)w.max,
+               e.n, (double)e.mean, (double)e.max);
+    if (have_last) {
+        app_printk("[FLOG] last: sample %u t=%u depth=%.3fm T=%.2fC H=%.2f P=%.2f R=%.2f %s\r\n",
+                   last.seq, last.t_ms, (double)last.depth_mm / 1000.0,
+                   (double)last.temp_cc / 100.0, (double)last.heading_cdeg / 100.0,
+                   (double)last.pitch_cdeg / 100.0, (double)last.roll_cdeg / 100.0,
+                   dive_state_name((enum dive_state)last.state));
+    }
+}
+
+int flash_log_read(uint32_t *seq, struct log_block *buf, uint32_t max)
+{
+    uint32_t slots = n_sectors * FLOG_PER_SECTOR;
+    int rc;
+
+    if (!atomic_get(&ready)) {
+        return -ENODEV;
+    }
+    k_mutex_lock(&flog_lock, K_FOREVER);
+    if (*seq < first_seq) {
+        *seq = first_seq;
+    }
+    uint32_t slot = *seq % slots;
+    uint32_t n = (*seq < next_seq) ? next_seq - *seq : 0;
+    n = MIN(n, max);
+    n = MIN(n, slots - slot);
+    rc = (n == 0) ? 0 : flash_area_read(fa, slot_offset(slot), buf, n * LOG_BLOCK_SIZE);
+    k_mutex_unlock(&flog_lock);
+    return (rc != 0) ? rc : (int)n;
+}
+
+int flash_log_erase(void)
+{
+    int rc = 0;
+
+    if (!atomic_get(&ready)) {
+        return -ENODEV;
+    }
+    k_mutex_lock(&flog_lock, K_FOREVER);
+    k_msgq_purge(&flog_q);
+    for (uint32_t s = 0; s < n_sectors && rc == 0; s++) {
+        rc = erase_sector(s);
+    }
+    head = 0;
+    next_seq = 0;
+    first_seq = 0;
+    next_sample = 0;
+    log_enc_begin(&enc, 0);
+    atomic_clear(&dropped);
+    k_mutex_unlock(&flog_lock);
+
+    app_printk("[FLOG] erased (%d)\r\n", rc);
+    return rc;
+}
@@ -24,6 +24,32 @@
 /* I2C (optional; guard at runtime) */
 static const struct device *i2c_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(i2c0));
 
+/* Last valid fix; written by whichever thread runs the fix wait */
+static struct gps_fix last_fix;
+static bool have_fix;
+static struct k_spinlock fix_lock;
+
+static void gps_store_fix(double lat, double lon)
+{
+    k_spinlock_key_t key = k_spin_lock(&fix_lock);
+    last_fix.lat_deg = lat;
+    last_fix.lon_deg = lon;
+    last_fix.t_ms = k_uptime_get();
+    have_fix = true;
+    k_spin_unlock(&fix_lock, key);
+}
+
+bool gps_last_fix(struct gps_fix *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&fix_lock);
+    bool ok = have_fix;
+    if (ok) {
+        *out = last_fix;
+    }
+    k_spin_unlock(&fix_lock, key);
+    return ok;
+}
+
 /* Console UART for nonblocking keypress checks */
 static const struct device *const uart_console = DEVICE_DT_GET_OR_NULL(DT_CHOSEN(zephyr_console));
 
@@ -188,6 +214,7 @@ void gps_fix_interactive(void)
                             if (status == 'A' && has_coords &&
                                 lat >= -90.0 && lat <= 90.0 &&
                                 lon >= -180.0 && lon <= 180.0) {
+                                gps_store_fix(lat, lon);
                                 app_printk("A %.6f %.6f\r\n", lat, lon);
                                 return;
                             }
@@ -219,6 +246,11 @@ void gps_fix_interactive(void)
  * Returns true if fix acquired, false on timeout.
  */
 bool gps_fix_wait(int timeout_sec)
+{
+    return gps_fix_wait_cancel(timeout_sec, NULL);
+}
+
+bool gps_fix_wait_cancel(int timeout_sec, bool (*cancel)(void))
 {
     if (i2c_dev == NULL || !device_is_ready(i2c_dev)) {
         k_sleep(K_MSEC(200));
@@ -242,6 +274,10 @@ bool gps_fix_wait(int timeout_sec)
             app_printk(" timeout\r\n");
             return false;  /* Timeout */
         }
+        if (cancel && cancel()) {
+            app_printk(" cancelled\r\n");
+            return false;
+        }
 
         uint16_t avail = 0;
         if (ublox_len(&avail) != 0) {
@@ -265,6 +301,7 @@ bool gps_fix_wait(int timeout_sec)
                             if (status == 'A' && has_coords &&
                                 lat >= -90.0 && lat <= 90.0 &&
                                 lon >= -180.0 && lon <= 180.0) {
+                                gps_store_fix(lat, lon);
                                 app_printk(" acquired (%.6f, %.6f)\r\n", lat, lon);
                                 return true;  /* Fix acquired */
                             }
@@ -0,0 +1,78 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/pwm.h>
+
+#include "hw_hbridge.h"
+#include "drive_profile.h"
+
+bool hbridge_has_pwm(const struct hbridge *hb)
+{
+    return hb->pwm1 && hb->pwm2;
+}
+
+bool hbridge_ready(const struct hbridge *hb)
+{
+    return hbridge_has_pwm(hb) || (hb->in1.port && hb->in2.port);
+}
+
+static int hbridge_pwm_set(const struct pwm_dt_spec *spec, uint16_t duty_pm)
+{
+    uint32_t pulse = (uint32_t)(((uint64_t)spec->period * duty_pm) / DRIVE_DUTY_FULL);
+    return pwm_set_pulse_dt(spec, pulse);
+}
+
+int hbridge_drive(const struct hbridge *hb, int dir, uint16_t duty_pm)
+{
+    uint16_t a = (dir > 0) ? duty_pm : 0;
+    uint16_t b = (dir < 0) ? duty_pm : 0;
+    int err;
+
+    if (hbridge_has_pwm(hb)) {
+        /* Drop the side going off first so the two never overlap */
+        if (a == 0) {
+            err = hbridge_pwm_set(hb->pwm1, 0);
+            int r = hbridge_pwm_set(hb->pwm2, b);
+            return err ? err : r;
+        }
+        err = hbridge_pwm_set(hb->pwm2, 0);
+        int r = hbridge_pwm_set(hb->pwm1, a);
+        return err ? err : r;
+    }
+
+    err = 0;
+    if (hb->in1.port && a == 0) {
+        err = gpio_pin_set_dt(&hb->in1, 0);
+    }
+    if (hb->in2.port) {
+        int r = gpio_pin_set_dt(&hb->in2, b ? 1 : 0);
+        if (r && !err) { err = r; }
+    }
+    if (hb->in1.port && a != 0) {
+        int r = gpio_pin_set_dt(&hb->in1, 1);
+        if (r && !err) { err = r; }
+    }
+    return err;
+}
+
+int hbridge_configure(const struct hbridge *hb)
+{
+    int err;
+
+    if (hbridge_has_pwm(hb)) {
+        if (!pwm_is_ready_dt(hb->pwm1) || !pwm_is_ready_dt(hb->pwm2)) {
+            return -ENODEV;
+        }
+        return hbridge_drive(hb, 0, 0);
+    }
+    if (hb->in1.port) {
+        if (!gpio_is_ready_dt(&hb->in1)) { return -ENODEV; }
+        err = gpio_pin_configure_dt(&hb->in1, GPIO_OUTPUT_INACTIVE);
+        if (err) { return err; }
+    }
+    if (hb->in2.port) {
+        if (!gpio_is_ready_dt(&hb->in2)) { return -ENODEV; }
+        err = gpio_pin_configure_dt(&hb->in2, GPIO_OUTPUT_INACTIVE);
+        if (err) { return err; }
+    }
+    return 0;
+}
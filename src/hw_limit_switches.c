@@ -6,6 +6,8 @@
 
 #include "hw_limit_switches.h"
 #include "hw_motors.h"
+#include "act_sched.h"
+#include "pitch_home.h"
 #include "app_print.h"
 #include "net_console.h"
 
@@ -18,29 +20,110 @@
 /* GPIO specs for limit switches - direct GPIO definitions
    GPIO32 = Pitch Limit UP (input-only pin, safe from boot strapping)
    GPIO33 = Pitch Limit DOWN (input-only pin, safe from boot strapping)
+   Zephyr numbers GPIO32-39 as pins 0-7 of the gpio1 bank; gpio0 only has
+   0-31, so interrupts must be set up on gpio1.
 */
 static struct device *gpio_dev = NULL;
 
+/* Contact bounce settles well within this */
+#define LIMIT_DEBOUNCE_MS 20
+/* Back-off run away from a hit switch, full-speed ms */
+#define LIMIT_BACKOFF_MS  1000
+
 struct limit_switch_state {
-    uint32_t pin;
+    uint32_t pin;                  /* ESP32 GPIO number, for messages */
+    gpio_pin_t bank_pin;           /* pin on gpio1 */
+    int toward;                    /* pitch direction that drives into this switch */
+    const char *name;
     struct gpio_callback callback;
+    struct k_work_delayable debounce_work;
     volatile bool triggered;
     volatile int64_t last_trigger_time;
-    volatile bool ignore_switches;  /* Flag to disable switch checking during reverse */
+    volatile bool cut;             /* the ISR stopped the pitch motor */
 };
 
 static struct limit_switch_state g_limit_switches[2] = {
-    {.pin = 32, .last_trigger_time = 0, .ignore_switches = false},   /* LIMIT_PITCH_UP */
-    {.pin = 33, .last_trigger_time = 0, .ignore_switches = false}    /* LIMIT_PITCH_DOWN */
+    {.pin = 32, .bank_pin = 0, .toward = +1, .name = "UP"},     /* LIMIT_PITCH_UP: FWD runs into it */
+    {.pin = 33, .bank_pin = 1, .toward = -1, .name = "DOWN"}    /* LIMIT_PITCH_DOWN: AFT runs into it */
 };
 
+/* Switch-to-motor-off latency of the hits so far, microseconds */
+static uint32_t cut_n;
+static uint32_t cut_max_us;
+static uint64_t cut_sum_us;
+
+/* The pitch run is cut here, in the ISR, but only when it is heading into
+ * this switch: edges while backing off (release bounce) are ignored. GPIO
+ * drive is off before the ISR returns; with PWM drive the LEDC write is
+ * not ISR-safe and follows on actuator_wq, and the reported latency
+ * includes that. Confirmation, logging and the back-off run follow on the
+ * system work queue once the contact has been quiet for LIMIT_DEBOUNCE_MS. */
 static void limit_switch_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
 {
+    uint32_t t0 = k_cycle_get_32();
     struct limit_switch_state *sw = CONTAINER_OF(cb, struct limit_switch_state, callback);
-    
+
+    ARG_UNUSED(dev);
+    ARG_UNUSED(pins);
+    if (motor_cut(MOTOR_PITCH, sw->toward, t0)) {
+        sw->cut = true;
+    }
+
     /* Record when the interrupt fired */
     sw->last_trigger_time = k_uptime_get();
     sw->triggered = true;
+    (void)k_work_reschedule(&sw->debounce_work, K_MSEC(LIMIT_DEBOUNCE_MS));
+}
+
+static void limit_debounce_work(struct k_work *work)
+{
+    struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
+    struct limit_switch_state *sw = CONTAINER_OF(dwork, struct limit_switch_state, debounce_work);
+    int id = (int)(sw - g_limit_switches);
+
+    if (!sw->cut) {
+        return;             /* bounce, or pressed while pitch was not heading into it */
+    }
+    sw->cut = false;
+
+    uint32_t us = motor_cut_us(MOTOR_PITCH);
+    cut_n++;
+    cut_sum_us += us;
+    if (us > cut_max_us) {
+        cut_max_us = us;
+    }
+
+    if (!limit_switch_is_pressed(id)) {
+        app_printk("[LIMIT] Pitch LIMIT %s (GPIO%u) glitch: pitch off in %uus, not pressed after %ums\r\n",
+                   sw->name, sw->pin, us, LIMIT_DEBOUNCE_MS);
+        return;
+    }
+    app_printk("[LIMIT] Pitch LIMIT %s (GPIO%u) hit: pitch off in %uus (n=%u mean %uus max %uus), backing off\r\n",
+               sw->name, sw->pin, us, cut_n, (uint32_t)(cut_sum_us / cut_n), cut_max_us);
+    pitch_home_switch_hit(id);
+
+    /* Through the scheduler, so it counts against the current budget and
+     * replaces whatever pitch move is queued */
+    struct act_move mv = {
+        .act = DIVE_ACT_PITCH,
+        .dir = -sw->toward,
+        .duration_ms = LIMIT_BACKOFF_MS,
+        .prio = ACT_PRIO_HIGH,
+    };
+    (void)act_sched_submit(&mv);
+}
+
+/* motor_cmd_ms guard: no pitch run further into a pressed switch. Covers
+ * starts while already pressed, which raise no edge. */
+static bool limit_pitch_guard(int dir)
+{
+    for (int i = 0; i < 2; i++) {
+        if (dir == g_limit_switches[i].toward && limit_switch_is_pressed(i)) {
+            app_printk("[LIMIT] Pitch LIMIT %s pressed\r\n", g_limit_switches[i].name);
+            return false;
+        }
+    }
+    return true;
 }
 
 bool limit_switch_is_pressed(int switch_id)
@@ -67,8 +150,7 @@ bool limit_switch_is_pressed(int switch_id)
     /* For non-ESP32 platforms, use Zephyr GPIO API */
     if (gpio_dev == NULL) return false;
     
-    int pin_num = (switch_id == LIMIT_PITCH_UP) ? 32 : 33;
-    int val = gpio_pin_get(gpio_dev, pin_num);
+    int val = gpio_pin_get_raw(gpio_dev, g_limit_switches[switch_id].bank_pin);
     return (val == 0);  /* Active low */
 #endif
 }
@@ -78,77 +160,46 @@ void limit_switch_callback(int switch_id)
     if (switch_id < 0 || switch_id >= 2) return;
 
     app_printk("[LIMIT] Manual callback for switch %d\r\n", switch_id);
-    motor_run(MOTOR_PITCH, 0, 0);
-}
-
-/* Called from main loop to handle triggered limit switches safely */
-void limit_switches_check_and_stop(void)
-{
-    /* Skip if we're in the middle of a reverse procedure */
-    if (g_limit_switches[0].ignore_switches) {
-        return;
-    }
-    
-    /* Check if either limit switch is currently pressed */
-    bool up_pressed = limit_switch_is_pressed(LIMIT_PITCH_UP);
-    bool down_pressed = limit_switch_is_pressed(LIMIT_PITCH_DOWN);
-    
-    if (up_pressed) {
-        app_printk("[LIMIT] Pitch LIMIT UP (GPIO32) triggered, stopping then reversing\r\n");
-        motor_run(MOTOR_PITCH, 0, 0);  /* Stop motor immediately */
-        k_sleep(K_MSEC(100));           /* Brief pause */
-        
-        /* Ignore switches during reverse to prevent immediate re-trigger */
-        g_limit_switches[0].ignore_switches = true;
-        motor_run(MOTOR_PITCH, -1, 1);  /* Reverse (AFT) for 1 second to release switch */
-        k_sleep(K_SECONDS(1));
-        g_limit_switches[0].ignore_switches = false;
-    }
-    
-    if (down_pressed) {
-        app_printk("[LIMIT] Pitch LIMIT DOWN (GPIO33) triggered, stopping then reversing\r\n");
-        motor_run(MOTOR_PITCH, 0, 0);  /* Stop motor immediately */
-        k_sleep(K_MSEC(100));           /* Brief pause */
-        
-        /* Ignore switches during reverse to prevent immediate re-trigger */
-        g_limit_switches[0].ignore_switches = true;
-        motor_run(MOTOR_PITCH, +1, 1);  /* Reverse (FWD) for 1 second to release switch */
-        k_sleep(K_SECONDS(1));
-        g_limit_switches[0].ignore_switches = false;
-    }
+    motor_stop(MOTOR_PITCH);
 }
 
 int limit_switches_init(void)
 {
     int err = 0;
 
-    /* Get GPIO0 device using device tree */
-    gpio_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(gpio0));
+    /* GPIO32/33 live on the gpio1 bank */
+    gpio_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(gpio1));
     if (!gpio_dev) {
-        app_printk("[LIMIT] GPIO_0 device not found\r\n");
+        app_printk("[LIMIT] GPIO_1 device not found\r\n");
         return -ENODEV;
     }
 
     if (!device_is_ready(gpio_dev)) {
-        app_printk("[LIMIT] GPIO_0 device not ready\r\n");
+        app_printk("[LIMIT] GPIO_1 device not ready\r\n");
         return -ENODEV;
     }
 
+    k_work_init_delayable(&g_limit_switches[LIMIT_PITCH_UP].debounce_work, limit_debounce_work);
+    k_work_init_delayable(&g_limit_switches[LIMIT_PITCH_DOWN].debounce_work, limit_debounce_work);
+
     /* Initialize pitch limit up (GPIO32) */
-    err = gpio_pin_configure(gpio_dev, 32, GPIO_INPUT | GPIO_PULL_UP);
+    err = gpio_pin_configure(gpio_dev, g_limit_switches[LIMIT_PITCH_UP].bank_pin,
+                             GPIO_INPUT | GPIO_PULL_UP | GPIO_ACTIVE_LOW);
     if (err) {
         app_printk("[LIMIT] Failed to configure GPIO32: %d\r\n", err);
         return err;
     }
 
-    gpio_init_callback(&g_limit_switches[LIMIT_PITCH_UP].callback, limit_switch_isr, 1ULL << 32);
+    gpio_init_callback(&g_limit_switches[LIMIT_PITCH_UP].callback, limit_switch_isr,
+                       BIT(g_limit_switches[LIMIT_PITCH_UP].bank_pin));
     err = gpio_add_callback(gpio_dev, &g_limit_switches[LIMIT_PITCH_UP].callback);
     if (err) {
         app_printk("[LIMIT] Failed to add GPIO32 callback: %d\r\n", err);
         return err;
     }
 
-    err = gpio_pin_interrupt_configure(gpio_dev, 32, GPIO_INT_EDGE_TO_ACTIVE);
+    err = gpio_pin_interrupt_configure(gpio_dev, g_limit_switches[LIMIT_PITCH_UP].bank_pin,
+                                       GPIO_INT_EDGE_TO_ACTIVE);
     if (err) {
         app_printk("[LIMIT] Failed to configure GPIO32 interrupt: %d\r\n", err);
         return err;
@@ -157,20 +208,23 @@ int limit_switches_init(void)
     app_printk("[LIMIT] Pitch limit UP (GPIO32) initialized\r\n");
 
     /* Initialize pitch limit down (GPIO33) */
-    err = gpio_pin_configure(gpio_dev, 33, GPIO_INPUT | GPIO_PULL_UP);
+    err = gpio_pin_configure(gpio_dev, g_limit_switches[LIMIT_PITCH_DOWN].bank_pin,
+                             GPIO_INPUT | GPIO_PULL_UP | GPIO_ACTIVE_LOW);
     if (err) {
         app_printk("[LIMIT] Failed to configure GPIO33: %d\r\n", err);
         return err;
     }
 
-    gpio_init_callback(&g_limit_switches[LIMIT_PITCH_DOWN].callback, limit_switch_isr, 1ULL << 33);
+    gpio_init_callback(&g_limit_switches[LIMIT_PITCH_DOWN].callback, limit_switch_isr,
+                       BIT(g_limit_switches[LIMIT_PITCH_DOWN].bank_pin));
     err = gpio_add_callback(gpio_dev, &g_limit_switches[LIMIT_PITCH_DOWN].callback);
     if (err) {
         app_printk("[LIMIT] Failed to add GPIO33 callback: %d\r\n", err);
         return err;
     }
 
-    err = gpio_pin_interrupt_configure(gpio_dev, 33, GPIO_INT_EDGE_TO_ACTIVE);
+    err = gpio_pin_interrupt_configure(gpio_dev, g_limit_switches[LIMIT_PITCH_DOWN].bank_pin,
+                                       GPIO_INT_EDGE_TO_ACTIVE);
     if (err) {
         app_printk("[LIMIT] Failed to configure GPIO33 interrupt: %d\r\n", err);
         return err;
@@ -178,6 +232,7 @@ int limit_switches_init(void)
 
     app_printk("[LIMIT] Pitch limit DOWN (GPIO33) initialized\r\n");
 
+    motor_set_guard(MOTOR_PITCH, limit_pitch_guard);
     return 0;
 }
 
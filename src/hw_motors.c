@@ -1,24 +1,39 @@
-
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/pwm.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/sys/atomic.h>
 
 #include "hw_motors.h"
-
-/* Devicetree aliases expected:
- *   roll-in1, roll-in2
- *   pitch-in1, pitch-in2
- * No enable pins required; H-bridges are always enabled via external pull-ups.
+#include "hw_hbridge.h"
+#include "drive_profile.h"
+#include "app_params.h"
+#include "actuator_acct.h"
+#include "actuator_wq.h"
+#include "app_logd.h"
+
+/* Devicetree aliases expected, either
+ *   roll-in-1, roll-in-2, pitch-in-1, pitch-in-2      (GPIO levels)
+ * or
+ *   roll-pwm-1, roll-pwm-2, pitch-pwm-1, pitch-pwm-2  (PWM, pwm-leds children)
+ * PWM wins when both are present. No enable pins; the H-bridges are always
+ * enabled via external pull-ups.
  */
 
 #define HAVE_ROLL_IN1  DT_NODE_HAS_STATUS(DT_ALIAS(roll_in_1), okay)
 #define HAVE_ROLL_IN2  DT_NODE_HAS_STATUS(DT_ALIAS(roll_in_2), okay)
 #define HAVE_PITCH_IN1 DT_NODE_HAS_STATUS(DT_ALIAS(pitch_in_1), okay)
 #define HAVE_PITCH_IN2 DT_NODE_HAS_STATUS(DT_ALIAS(pitch_in_2), okay)
+#define HAVE_ROLL_PWM  (DT_NODE_HAS_STATUS(DT_ALIAS(roll_pwm_1), okay) && \
+                        DT_NODE_HAS_STATUS(DT_ALIAS(roll_pwm_2), okay))
+#define HAVE_PITCH_PWM (DT_NODE_HAS_STATUS(DT_ALIAS(pitch_pwm_1), okay) && \
+                        DT_NODE_HAS_STATUS(DT_ALIAS(pitch_pwm_2), okay))
 
-#if !HAVE_ROLL_IN1 || !HAVE_ROLL_IN2 || !HAVE_PITCH_IN1 || !HAVE_PITCH_IN2
-#warning "One or more motor GPIO aliases are missing in the devicetree"
+#if !HAVE_ROLL_PWM && (!HAVE_ROLL_IN1 || !HAVE_ROLL_IN2)
+#warning "Roll motor GPIO/PWM aliases are missing in the devicetree"
+#endif
+#if !HAVE_PITCH_PWM && (!HAVE_PITCH_IN1 || !HAVE_PITCH_IN2)
+#warning "Pitch motor GPIO/PWM aliases are missing in the devicetree"
 #endif
 
 #if HAVE_ROLL_IN1
@@ -43,17 +58,47 @@ static const struct gpio_dt_spec PITCH_IN2 = GPIO_DT_SPEC_GET(DT_ALIAS(pitch_in_
 static const struct gpio_dt_spec PITCH_IN2 = {0};
 #endif
 
-struct motor_gpio {
-    struct gpio_dt_spec in1;
-    struct gpio_dt_spec in2;
-};
+#if HAVE_ROLL_PWM
+static const struct pwm_dt_spec ROLL_PWM1 = PWM_DT_SPEC_GET(DT_ALIAS(roll_pwm_1));
+static const struct pwm_dt_spec ROLL_PWM2 = PWM_DT_SPEC_GET(DT_ALIAS(roll_pwm_2));
+#define ROLL_PWM1_P (&ROLL_PWM1)
+#define ROLL_PWM2_P (&ROLL_PWM2)
+#else
+#define ROLL_PWM1_P NULL
+#define ROLL_PWM2_P NULL
+#endif
+#if HAVE_PITCH_PWM
+static const struct pwm_dt_spec PITCH_PWM1 = PWM_DT_SPEC_GET(DT_ALIAS(pitch_pwm_1));
+static const struct pwm_dt_spec PITCH_PWM2 = PWM_DT_SPEC_GET(DT_ALIAS(pitch_pwm_2));
+#define PITCH_PWM1_P (&PITCH_PWM1)
+#define PITCH_PWM2_P (&PITCH_PWM2)
+#else
+#define PITCH_PWM1_P NULL
+#define PITCH_PWM2_P NULL
+#endif
+
+/* Duty updates during a ramp */
+#define MOTOR_RAMP_STEP_MS 10
 
 struct motor_state {
-    struct motor_gpio io;
+    struct hbridge hb;
     struct k_work_delayable stop_work;
+    struct k_work_delayable ramp_work;
+    struct k_work cut_work;        /* PWM: bridge off after motor_cut() */
+    struct k_mutex drive_lock;     /* orders H-bridge writes from threads */
+    uint32_t cut_cycles;           /* t0 given to the last motor_cut() */
+    atomic_t cuts;                 /* motor_cut() stops so far */
+    volatile uint32_t cut_us;      /* ... to bridge off */
+    struct k_spinlock lock;        /* everything below */
     atomic_t running;
-    int32_t position_sec;
-    bool use_slow_timing;  /* For ROLL motor: use slower timing for reduced speed */
+    int dir;                       /* direction of the run in progress, 0 = stopped */
+    uint16_t duty_pm;              /* duty it is running at now */
+    struct drive_profile profile;
+    int64_t start_ticks;           /* uptime ticks when that run started */
+    int64_t seg_ticks;             /* ... and when duty_pm was last changed */
+    uint32_t requested_ms;         /* planned wall time of that run, 0 = open-ended */
+    int64_t position_us;           /* full-speed us, excluding the current segment */
+    motor_guard_fn guard;
 };
 
 static struct motor_state g_motors[2];
@@ -63,114 +108,245 @@ static inline struct motor_state *get_motor(enum motor_id id)
     return (id == MOTOR_ROLL) ? &g_motors[0] : &g_motors[1];
 }
 
-static int motor_all_low(struct motor_state *m)
+static inline enum dive_actuator motor_act(const struct motor_state *m)
+{
+    return (m == &g_motors[0]) ? DIVE_ACT_ROLL : DIVE_ACT_PITCH;
+}
+
+static inline const char *motor_tag(const struct motor_state *m)
+{
+    return (m == &g_motors[0]) ? "[ROLL]" : "[PITCH]";
+}
+
+/* Speed limit and ramps; GPIO drive is always full speed. The roll motor
+ * runs slower than pitch by default (roll_duty_pct) for finer heading
+ * corrections. */
+static void motor_limits(const struct motor_state *m, struct drive_limits *lim)
+{
+    if (!hbridge_has_pwm(&m->hb)) {
+        drive_limits_full(lim);
+        return;
+    }
+    const struct app_params *p = app_params_get();
+    uint16_t pct = (m == &g_motors[0]) ? p->roll_duty_pct : p->pitch_duty_pct;
+    lim->duty_max_pm = (uint16_t)(MIN(pct, 100U) * 10U);
+    lim->duty_min_pm = (uint16_t)(MIN(p->drive_min_duty_pct, 100U) * 10U);
+    lim->ramp_ms = p->drive_ramp_ms;
+}
+
+/* Signed full-speed travel of the current segment up to now_ticks; lock held */
+static int64_t motor_run_us(const struct motor_state *m, int64_t now_ticks)
+{
+    if (m->dir == 0) {
+        return 0;
+    }
+    int64_t us = (int64_t)k_ticks_to_us_floor64((uint64_t)(now_ticks - m->seg_ticks));
+    us = us * m->duty_pm / DRIVE_DUTY_FULL;
+    return (m->dir > 0) ? us : -us;
+}
+
+/* Fold the current segment into position_us and start a new one at duty_pm
+ * (0 = stopped); lock held. Returns how long the run has been going. */
+static uint32_t motor_settle(struct motor_state *m, int64_t now_ticks, uint16_t duty_pm)
 {
-    int err = 0;
-    if (m->io.in1.port) {
-        int r = gpio_pin_set_dt(&m->io.in1, 0);
-        if (r && !err) { err = r; }
+    uint32_t ran_us = 0;
+
+    if (m->dir != 0) {
+        m->position_us += motor_run_us(m, now_ticks);
+        ran_us = (uint32_t)k_ticks_to_us_floor64((uint64_t)(now_ticks - m->start_ticks));
+    }
+    m->seg_ticks = now_ticks;
+    m->duty_pm = duty_pm;
+    if (duty_pm == 0) {
+        m->dir = 0;
+    }
+    return ran_us;
+}
+
+/* Drive the bridge to the state just set; lock held. GPIO writes are
+ * plain register writes, so they are made here, under the same lock as
+ * the limit ISR's cut. */
+static void motor_out_gpio(struct motor_state *m)
+{
+    if (!hbridge_has_pwm(&m->hb)) {
+        (void)hbridge_drive(&m->hb, m->dir, m->duty_pm);
     }
-    if (m->io.in2.port) {
-        int r = gpio_pin_set_dt(&m->io.in2, 0);
-        if (r && !err) { err = r; }
+}
+
+/* Same for PWM; drive_lock held, lock not. The LEDC driver takes a
+ * semaphore and may block, so this runs after the spinlock, reading the
+ * state again so that a stop in between is not undone. */
+static void motor_out_pwm(struct motor_state *m)
+{
+    if (!hbridge_has_pwm(&m->hb)) {
+        return;
     }
-    return err;
+    k_spinlock_key_t key = k_spin_lock(&m->lock);
+    int dir = m->dir;
+    uint16_t duty = m->duty_pm;
+    k_spin_unlock(&m->lock, key);
+    (void)hbridge_drive(&m->hb, dir, duty);
+}
+
+/* Outputs off and position settled at the same instant */
+static uint32_t motor_halt(struct motor_state *m, uint32_t *requested_ms)
+{
+    k_mutex_lock(&m->drive_lock, K_FOREVER);
+    k_spinlock_key_t key = k_spin_lock(&m->lock);
+    uint32_t ran_us = motor_settle(m, k_uptime_ticks(), 0);
+    motor_out_gpio(m);
+    *requested_ms = m->requested_ms;
+    atomic_clear(&m->running);
+    k_spin_unlock(&m->lock, key);
+    motor_out_pwm(m);
+    k_mutex_unlock(&m->drive_lock);
+    actuator_acct_off(motor_act(m));
+    return ran_us;
 }
 
+/* Actuator work queue: no logging here, actuator_wq prints it later */
 static void motor_stop_work(struct k_work *work)
 {
     struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
     struct motor_state *m = CONTAINER_OF(dwork, struct motor_state, stop_work);
-    (void)motor_all_low(m);
-    atomic_clear(&m->running);
-    
-    /* Determine which motor this is */
-    const char *tag = (m == &g_motors[0]) ? "[ROLL]" : "[PITCH]";
-    app_printk("%s timed stop\r\n", tag);
+    uint32_t requested_ms;
+    uint32_t ran_us = motor_halt(m, &requested_ms);
+
+    (void)k_work_cancel_delayable(&m->ramp_work);
+    actuator_wq_stopped(motor_act(m), requested_ms, ran_us);
 }
 
-static int motor_configure(struct motor_state *m, const struct motor_gpio *io)
+/* Actuator work queue: the LEDC write motor_cut() could not make */
+static void motor_cut_work(struct k_work *work)
 {
-    int err;
+    struct motor_state *m = CONTAINER_OF(work, struct motor_state, cut_work);
 
-    m->io = *io;
-    m->position_sec = 0;
-    m->use_slow_timing = false;
+    k_mutex_lock(&m->drive_lock, K_FOREVER);
+    motor_out_pwm(m);
+    m->cut_us = k_cyc_to_us_floor32(k_cycle_get_32() - m->cut_cycles);
+    k_mutex_unlock(&m->drive_lock);
+}
+
+/* Actuator work queue: step the duty along the profile */
+static void motor_ramp_work(struct k_work *work)
+{
+    struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
+    struct motor_state *m = CONTAINER_OF(dwork, struct motor_state, ramp_work);
+    uint32_t next = DRIVE_CRUISE_FOREVER;
+    uint32_t t_ms = 0;
+
+    bool changed = false;
+
+    k_mutex_lock(&m->drive_lock, K_FOREVER);
+    k_spinlock_key_t key = k_spin_lock(&m->lock);
+    if (m->dir != 0) {
+        int64_t now = k_uptime_ticks();
+        t_ms = (uint32_t)k_ticks_to_ms_floor64((uint64_t)(now - m->start_ticks));
+        uint16_t duty = drive_profile_duty(&m->profile, t_ms);
+        if (duty != 0 && duty != m->duty_pm) {
+            (void)motor_settle(m, now, duty);
+            motor_out_gpio(m);
+            changed = true;
+        }
+        next = drive_profile_next_ms(&m->profile, t_ms, MOTOR_RAMP_STEP_MS);
+    }
+    k_spin_unlock(&m->lock, key);
+    if (changed) {
+        motor_out_pwm(m);
+    }
+    k_mutex_unlock(&m->drive_lock);
 
-    if (m->io.in1.port) {
-        if (!gpio_is_ready_dt(&m->io.in1)) { return -ENODEV; }
-        err = gpio_pin_configure_dt(&m->io.in1, GPIO_OUTPUT_INACTIVE);
-        if (err) { return err; }
+    if (next != DRIVE_CRUISE_FOREVER) {
+        k_work_schedule_for_queue(actuator_wq(), &m->ramp_work, K_MSEC(next - t_ms));
     }
-    if (m->io.in2.port) {
-        if (!gpio_is_ready_dt(&m->io.in2)) { return -ENODEV; }
-        err = gpio_pin_configure_dt(&m->io.in2, GPIO_OUTPUT_INACTIVE);
-        if (err) { return err; }
+}
+
+static int motor_configure(struct motor_state *m, const struct hbridge *hb)
+{
+    m->hb = *hb;
+    m->position_us = 0;
+    m->dir = 0;
+    m->duty_pm = 0;
+
+    int err = hbridge_configure(&m->hb);
+    if (err) {
+        return err;
     }
 
+    k_mutex_init(&m->drive_lock);
     k_work_init_delayable(&m->stop_work, motor_stop_work);
+    k_work_init_delayable(&m->ramp_work, motor_ramp_work);
+    k_work_init(&m->cut_work, motor_cut_work);
     atomic_clear(&m->running);
-    
-    /* For ROLL motor, slow timing is NOT currently implemented */
-    if (m == &g_motors[0]) {  /* MOTOR_ROLL */
-        m->use_slow_timing = false;  /* Disabled for now */
-    }
-    
     return 0;
 }
 
-void motor_cmd(enum motor_id id, int dir, uint32_t duration_s)
+void motor_cmd_ms(enum motor_id id, int dir, uint32_t duration_ms)
 {
     struct motor_state *m = get_motor(id);
 
     k_work_cancel_delayable(&m->stop_work);
+    k_work_cancel_delayable(&m->ramp_work);
 
     if (dir == 0) {
-        (void)motor_all_low(m);
-        atomic_clear(&m->running);
-        const char *tag = (id == MOTOR_ROLL ? "[ROLL]" : "[PITCH]");
-        app_printk("%s stop\r\n", tag);
+        uint32_t requested_ms;
+        uint32_t ran_us = motor_halt(m, &requested_ms);
+        actuator_wq_notify_stop(motor_act(m));
+        app_printk("%s stop (ran %ums)\r\n", motor_tag(m), ran_us / 1000U);
         return;
     }
 
-    /* Guard: ensure GPIOs were configured */
-    if (!m->io.in1.port || !m->io.in2.port) {
-        app_printk("[MOTOR] GPIO not configured for %s\r\n",
+    /* Guard: ensure the outputs were configured */
+    if (!hbridge_ready(&m->hb)) {
+        app_printk("[MOTOR] outputs not configured for %s\r\n",
                (id == MOTOR_ROLL ? "ROLL" : "PITCH"));
         return;
     }
-
-    /* H-bridge (no EN pins):
-     * IN1 IN2
-     *  1   0  -> direction A
-     *  0   1  -> direction B
-     *  0   0  -> coast
-     *  1   1  -> brake (avoid unless desired)
-     */
-    if (dir > 0) {
-        (void)gpio_pin_set_dt(&m->io.in1, 1);
-        (void)gpio_pin_set_dt(&m->io.in2, 0);
-    } else {
-        (void)gpio_pin_set_dt(&m->io.in1, 0);
-        (void)gpio_pin_set_dt(&m->io.in2, 1);
+    if (m->guard && !m->guard(dir)) {
+        uint32_t requested_ms;
+        (void)motor_halt(m, &requested_ms);
+        actuator_wq_notify_stop(motor_act(m));
+        app_printk("%s run %s refused by guard\r\n", motor_tag(m), dir > 0 ? "+" : "-");
+        return;
     }
+
+    /* duration_ms is travel at full speed; the profile stretches it to
+     * cover the same travel at the duty limit, ramps included. A run
+     * already in progress is settled and replaced. */
+    struct drive_limits lim;
+    struct drive_profile prof;
+    motor_limits(m, &lim);
+    drive_profile_plan(&lim, duration_ms, &prof);
+    uint32_t wall_ms = drive_profile_total_ms(&prof);
+    uint16_t duty = drive_profile_duty(&prof, 0);
+
+    k_mutex_lock(&m->drive_lock, K_FOREVER);
+    k_spinlock_key_t key = k_spin_lock(&m->lock);
+    int64_t now = k_uptime_ticks();
+    (void)motor_settle(m, now, duty);
+    m->dir = (dir > 0) ? +1 : -1;
+    motor_out_gpio(m);
+    m->profile = prof;
+    m->start_ticks = now;
+    m->requested_ms = (duration_ms == 0) ? 0 : wall_ms;
     atomic_set(&m->running, 1);
+    k_spin_unlock(&m->lock, key);
+    motor_out_pwm(m);
+    k_mutex_unlock(&m->drive_lock);
+    actuator_acct_on(motor_act(m), dir);
+
+    uint32_t next = drive_profile_next_ms(&prof, 0, MOTOR_RAMP_STEP_MS);
+    if (next != DRIVE_CRUISE_FOREVER) {
+        k_work_schedule_for_queue(actuator_wq(), &m->ramp_work, K_MSEC(next));
+    }
 
-    if (duration_s == 0) {
-        const char *tag = (id == MOTOR_ROLL ? "[ROLL]" : "[PITCH]");
-        app_printk("%s start (continuous)\r\n", tag);
+    if (duration_ms == 0) {
+        app_printk("%s start (continuous)\r\n", motor_tag(m));
         return;
     }
 
-    int32_t delta = (int32_t)duration_s;
-    if (dir < 0) {
-        delta = -delta;
-    }
-    m->position_sec += delta;
+    k_work_schedule_for_queue(actuator_wq(), &m->stop_work, K_MSEC(wall_ms));
     
-    k_work_schedule(&m->stop_work, K_SECONDS(duration_s));
-    
-    const char *tag = (id == MOTOR_ROLL ? "[ROLL]" : "[PITCH]");
     const char *motor_name = (id == MOTOR_ROLL ? "ROLL" : "PITCH");
     const char *direction;
     if (id == MOTOR_ROLL) {
@@ -178,17 +354,17 @@ void motor_cmd(enum motor_id id, int dir, uint32_t duration_s)
     } else {
         direction = (dir > 0 ? "FWD" : "AFT");
     }
-    app_printk("%s %s run %s for %us\r\n",
-           tag,
-           motor_name,
-           direction,
-           (unsigned)duration_s);
+    if (wall_ms != duration_ms) {
+        APP_LOGD(MOTOR_RAMP, motor_tag(m), motor_name, direction, (unsigned)duration_ms,
+                 (unsigned)wall_ms, (unsigned)(prof.peak_pm / 10U));
+        return;
+    }
+    APP_LOGD(MOTOR_RUN, motor_tag(m), motor_name, direction, (unsigned)duration_ms);
 }
 
-/* Backward compatibility: old code calls motor_run(). */
-void motor_run(enum motor_id id, int dir, uint32_t duration_s)
+void motor_stop(enum motor_id id)
 {
-    motor_cmd(id, dir, duration_s);
+    motor_cmd_ms(id, 0, 0);
 }
 
 bool motor_is_running(enum motor_id id)
@@ -196,48 +372,116 @@ bool motor_is_running(enum motor_id id)
     return atomic_get(&get_motor(id)->running);
 }
 
-int32_t motor_get_position_sec(enum motor_id id)
+bool motor_cut(enum motor_id id, int dir, uint32_t t0_cycles)
+{
+    struct motor_state *m = get_motor(id);
+    int want = (dir > 0) ? +1 : -1;
+
+    k_spinlock_key_t key = k_spin_lock(&m->lock);
+    if (m->dir != want) {
+        k_spin_unlock(&m->lock, key);
+        return false;
+    }
+    uint32_t ran_us = motor_settle(m, k_uptime_ticks(), 0);
+    motor_out_gpio(m);
+    atomic_clear(&m->running);
+    m->cut_cycles = t0_cycles;
+    atomic_inc(&m->cuts);
+    k_spin_unlock(&m->lock, key);
+
+    if (hbridge_has_pwm(&m->hb)) {
+        (void)k_work_submit_to_queue(actuator_wq(), &m->cut_work);
+    } else {
+        m->cut_us = k_cyc_to_us_floor32(k_cycle_get_32() - t0_cycles);
+    }
+    (void)k_work_cancel_delayable(&m->stop_work);
+    (void)k_work_cancel_delayable(&m->ramp_work);
+    actuator_acct_off(motor_act(m));
+    actuator_wq_stopped(motor_act(m), 0, ran_us);
+    return true;
+}
+
+uint32_t motor_cut_us(enum motor_id id)
+{
+    return get_motor(id)->cut_us;
+}
+
+uint32_t motor_cut_count(enum motor_id id)
+{
+    return (uint32_t)atomic_get(&get_motor(id)->cuts);
+}
+
+void motor_set_guard(enum motor_id id, motor_guard_fn guard)
+{
+    get_motor(id)->guard = guard;
+}
+
+int32_t motor_get_position_ms(enum motor_id id)
 {
     struct motor_state *m = get_motor(id);
-    return m->position_sec;
+    k_spinlock_key_t key = k_spin_lock(&m->lock);
+    int64_t pos_us = m->position_us + motor_run_us(m, k_uptime_ticks());
+    k_spin_unlock(&m->lock, key);
+    return (int32_t)(pos_us / 1000);
 }
 
-void motor_reset_position(enum motor_id id)
+void motor_set_position_ms(enum motor_id id, int32_t position_ms)
+{
+    struct motor_state *m = get_motor(id);
+    k_spinlock_key_t key = k_spin_lock(&m->lock);
+    m->position_us = (int64_t)position_ms * 1000;
+    m->seg_ticks = k_uptime_ticks();     /* a run in progress counts from here */
+    k_spin_unlock(&m->lock, key);
+}
+
+void motor_shift_position_ms(enum motor_id id, int32_t delta_ms)
 {
     struct motor_state *m = get_motor(id);
-    m->position_sec = 0;
+    k_spinlock_key_t key = k_spin_lock(&m->lock);
+    m->position_us += (int64_t)delta_ms * 1000;
+    k_spin_unlock(&m->lock, key);
+}
+
+void motor_reset_position(enum motor_id id)
+{
+    motor_set_position_ms(id, 0);
 }
 
 void motors_reset_all_positions(void)
 {
-    for (int i = 0; i < 2; i++) {
-        g_motors[i].position_sec = 0;
-    }
+    motor_reset_position(MOTOR_ROLL);
+    motor_reset_position(MOTOR_PITCH);
 }
+
 int motors_init(void)
 {
     int err;
 
-    const struct motor_gpio roll_io = {
+    const struct hbridge roll_hb = {
         .in1 = ROLL_IN1,
         .in2 = ROLL_IN2,
+        .pwm1 = ROLL_PWM1_P,
+        .pwm2 = ROLL_PWM2_P,
     };
-    const struct motor_gpio pitch_io = {
+    const struct hbridge pitch_hb = {
         .in1 = PITCH_IN1,
         .in2 = PITCH_IN2,
+        .pwm1 = PITCH_PWM1_P,
+        .pwm2 = PITCH_PWM2_P,
     };
 
-    err = motor_configure(&g_motors[0], &roll_io);
+    err = motor_configure(&g_motors[0], &roll_hb);
     if (err) {
         app_printk("[MOTOR] roll configuration failed: %d\r\n", err);
         return err;
     }
-    err = motor_configure(&g_motors[1], &pitch_io);
+    err = motor_configure(&g_motors[1], &pitch_hb);
     if (err) {
         app_printk("[MOTOR] pitch configuration failed: %d\r\n", err);
         return err;
     }
 
-    app_printk("[MOTOR] init OK (EN pins not used)\r\n");
+    app_printk("[MOTOR] init OK (%s drive, EN pins not used)\r\n",
+               hbridge_has_pwm(&g_motors[1].hb) ? "PWM" : "GPIO");
     return 0;
 }
\ No newline at end of file
@@ -1,60 +1,181 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/pwm.h>
 #include <zephyr/sys/printk.h>
 
 #include "hw_pump.h"
+#include "hw_hbridge.h"
+#include "drive_profile.h"
+#include "app_params.h"
+#include "actuator_acct.h"
+#include "actuator_wq.h"
+#include "app_logd.h"
 
-/* --- Devicetree bindings for Pump --- */
+/* --- Devicetree bindings for Pump: pump-in-1/2 (GPIO) or pump-pwm-1/2 --- */
 #define HAVE_PUMP_IN1 DT_NODE_HAS_STATUS(DT_ALIAS(pump_in_1), okay)
 #define HAVE_PUMP_IN2 DT_NODE_HAS_STATUS(DT_ALIAS(pump_in_2), okay)
-#define PUMP_SUPPORTED (HAVE_PUMP_IN1 && HAVE_PUMP_IN2)
+#define HAVE_PUMP_PWM (DT_NODE_HAS_STATUS(DT_ALIAS(pump_pwm_1), okay) && \
+                       DT_NODE_HAS_STATUS(DT_ALIAS(pump_pwm_2), okay))
+#define PUMP_SUPPORTED (HAVE_PUMP_PWM || (HAVE_PUMP_IN1 && HAVE_PUMP_IN2))
 
 #if PUMP_SUPPORTED
-static const struct gpio_dt_spec gpio_pump_in1 = GPIO_DT_SPEC_GET(DT_ALIAS(pump_in_1), gpios);
-static const struct gpio_dt_spec gpio_pump_in2 = GPIO_DT_SPEC_GET(DT_ALIAS(pump_in_2), gpios);
+#if HAVE_PUMP_PWM
+static const struct pwm_dt_spec pwm_pump_1 = PWM_DT_SPEC_GET(DT_ALIAS(pump_pwm_1));
+static const struct pwm_dt_spec pwm_pump_2 = PWM_DT_SPEC_GET(DT_ALIAS(pump_pwm_2));
+#define PUMP_HBRIDGE { .pwm1 = &pwm_pump_1, .pwm2 = &pwm_pump_2 }
+#else
+#define PUMP_HBRIDGE { .in1 = GPIO_DT_SPEC_GET(DT_ALIAS(pump_in_1), gpios), \
+                       .in2 = GPIO_DT_SPEC_GET(DT_ALIAS(pump_in_2), gpios) }
+#endif
+
+/* Duty updates during a ramp */
+#define PUMP_RAMP_STEP_MS 10
 
 struct pump_ctx {
-    const struct gpio_dt_spec *in1;
-    const struct gpio_dt_spec *in2;
+    struct hbridge hb;
     struct k_work_delayable stop_work;
+    struct k_work_delayable ramp_work;
+    struct k_mutex drive_lock;     /* orders H-bridge writes */
+    struct k_spinlock lock;        /* everything below */
     volatile bool running;
-    int32_t position_sec;
+    int dir;                       /* direction of the run in progress, 0 = stopped */
+    uint16_t duty_pm;              /* duty it is running at now */
+    struct drive_profile profile;
+    int64_t start_ticks;           /* uptime ticks when that run started */
+    int64_t seg_ticks;             /* ... and when duty_pm was last changed */
+    uint32_t requested_ms;         /* planned wall time of that run, 0 = open-ended */
+    int64_t position_us;           /* full-speed us, excluding the current segment */
 };
 
 static struct pump_ctx pump = {
-    .in1 = &gpio_pump_in1,
-    .in2 = &gpio_pump_in2,
+    .hb = PUMP_HBRIDGE,
     .running = false,
-    .position_sec = 0,
+    .position_us = 0,
 };
 
 /* --- Helpers (only defined when PUMP_SUPPORTED) --- */
-static void pump_all_low(const struct pump_ctx *p)
+static void pump_limits(const struct pump_ctx *p, struct drive_limits *lim)
+{
+    if (!hbridge_has_pwm(&p->hb)) {
+        drive_limits_full(lim);
+        return;
+    }
+    const struct app_params *prm = app_params_get();
+    lim->duty_max_pm = (uint16_t)(MIN(prm->pump_duty_pct, 100U) * 10U);
+    lim->duty_min_pm = (uint16_t)(MIN(prm->drive_min_duty_pct, 100U) * 10U);
+    lim->ramp_ms = prm->drive_ramp_ms;
+}
+
+/* Signed full-speed travel of the current segment up to now_ticks; lock held */
+static int64_t pump_run_us(const struct pump_ctx *p, int64_t now_ticks)
+{
+    if (p->dir == 0) {
+        return 0;
+    }
+    int64_t us = (int64_t)k_ticks_to_us_floor64((uint64_t)(now_ticks - p->seg_ticks));
+    us = us * p->duty_pm / DRIVE_DUTY_FULL;
+    return (p->dir > 0) ? us : -us;
+}
+
+/* Fold the current segment into position_us and start a new one at duty_pm
+ * (0 = stopped); lock held. Returns how long the run has been going. */
+static uint32_t pump_settle(struct pump_ctx *p, int64_t now_ticks, uint16_t duty_pm)
+{
+    uint32_t ran_us = 0;
+
+    if (p->dir != 0) {
+        p->position_us += pump_run_us(p, now_ticks);
+        ran_us = (uint32_t)k_ticks_to_us_floor64((uint64_t)(now_ticks - p->start_ticks));
+    }
+    p->seg_ticks = now_ticks;
+    p->duty_pm = duty_pm;
+    if (duty_pm == 0) {
+        p->dir = 0;
+    }
+    return ran_us;
+}
+
+/* Drive the bridge to the state just set; drive_lock held, lock not. The
+ * LEDC driver may block, so bridge writes never happen under the
+ * spinlock; drive_lock keeps them in the same order as the state changes. */
+static void pump_out(struct pump_ctx *p)
+{
+    k_spinlock_key_t key = k_spin_lock(&p->lock);
+    int dir = p->dir;
+    uint16_t duty = p->duty_pm;
+    k_spin_unlock(&p->lock, key);
+    (void)hbridge_drive(&p->hb, dir, duty);
+}
+
+/* Outputs off and position settled together */
+static uint32_t pump_halt(struct pump_ctx *p, uint32_t *requested_ms)
 {
-    if (!p || !p->in1 || !p->in2) return;
-    gpio_pin_set_dt(p->in1, 0);
-    gpio_pin_set_dt(p->in2, 0);
+    k_mutex_lock(&p->drive_lock, K_FOREVER);
+    k_spinlock_key_t key = k_spin_lock(&p->lock);
+    uint32_t ran_us = pump_settle(p, k_uptime_ticks(), 0);
+    *requested_ms = p->requested_ms;
+    p->running = false;
+    k_spin_unlock(&p->lock, key);
+    pump_out(p);
+    k_mutex_unlock(&p->drive_lock);
+    actuator_acct_off(DIVE_ACT_PUMP);
+    return ran_us;
 }
 
+/* Actuator work queue: no logging here, actuator_wq prints it later */
 static void pump_stop_work_handler(struct k_work *work)
 {
     struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
     struct pump_ctx *p = CONTAINER_OF(dwork, struct pump_ctx, stop_work);
-    pump_all_low(p);
-    p->running = false;
-    app_printk("[PUMP] stopped\r\n");
+    uint32_t requested_ms;
+    uint32_t ran_us = pump_halt(p, &requested_ms);
+
+    (void)k_work_cancel_delayable(&p->ramp_work);
+    actuator_wq_stopped(DIVE_ACT_PUMP, requested_ms, ran_us);
+}
+
+/* Actuator work queue: step the duty along the profile */
+static void pump_ramp_work_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
+    struct pump_ctx *p = CONTAINER_OF(dwork, struct pump_ctx, ramp_work);
+    uint32_t next = DRIVE_CRUISE_FOREVER;
+    uint32_t t_ms = 0;
+
+    bool changed = false;
+
+    k_mutex_lock(&p->drive_lock, K_FOREVER);
+    k_spinlock_key_t key = k_spin_lock(&p->lock);
+    if (p->dir != 0) {
+        int64_t now = k_uptime_ticks();
+        t_ms = (uint32_t)k_ticks_to_ms_floor64((uint64_t)(now - p->start_ticks));
+        uint16_t duty = drive_profile_duty(&p->profile, t_ms);
+        if (duty != 0 && duty != p->duty_pm) {
+            (void)pump_settle(p, now, duty);
+            changed = true;
+        }
+        next = drive_profile_next_ms(&p->profile, t_ms, PUMP_RAMP_STEP_MS);
+    }
+    k_spin_unlock(&p->lock, key);
+    if (changed) {
+        pump_out(p);
+    }
+    k_mutex_unlock(&p->drive_lock);
+
+    if (next != DRIVE_CRUISE_FOREVER) {
+        k_work_schedule_for_queue(actuator_wq(), &p->ramp_work, K_MSEC(next - t_ms));
+    }
 }
 
 static int pump_init_one(struct pump_ctx *p)
 {
-    if (!p || !p->in1 || !p->in2) return -EINVAL;
-    if (!device_is_ready(p->in1->port) || !device_is_ready(p->in2->port)) return -ENODEV;
+    if (!p || !hbridge_ready(&p->hb)) return -EINVAL;
 
-    int r = 0;
-    r |= gpio_pin_configure_dt(p->in1, GPIO_OUTPUT_INACTIVE);
-    r |= gpio_pin_configure_dt(p->in2, GPIO_OUTPUT_INACTIVE);
+    int r = hbridge_configure(&p->hb);
 
+    k_mutex_init(&p->drive_lock);
     k_work_init_delayable(&p->stop_work, pump_stop_work_handler);
+    k_work_init_delayable(&p->ramp_work, pump_ramp_work_handler);
     return r;
 }
 
@@ -63,56 +184,101 @@ int pump_init(void)
 {
     int r = pump_init_one(&pump);
     if (r == 0) {
-        app_printk("[PUMP] initialized\r\n");
+        app_printk("[PUMP] initialized (%s drive)\r\n",
+                   hbridge_has_pwm(&pump.hb) ? "PWM" : "GPIO");
     } else {
         app_printk("[PUMP] init failed: %d\r\n", r);
     }
     return r;
 }
 
-void pump_run(int dir, uint32_t duration_s)
+void pump_cmd_ms(int dir, uint32_t duration_ms)
 {
     k_work_cancel_delayable(&pump.stop_work);
-    pump_all_low(&pump);
+    k_work_cancel_delayable(&pump.ramp_work);
 
     if (dir == 0) {
-        app_printk("[PUMP] stopped\r\n");
-        pump.running = false;
+        uint32_t requested_ms;
+        uint32_t ran_us = pump_halt(&pump, &requested_ms);
+        actuator_wq_notify_stop(DIVE_ACT_PUMP);
+        app_printk("[PUMP] stopped (ran %ums)\r\n", ran_us / 1000U);
         return;
     }
 
-    app_printk("[PUMP] run %s for %us\r\n",
-               dir > 0 ? "OUT" : "IN",
-               duration_s);
+    /* duration_ms is travel at full speed; see drive_profile.h */
+    struct drive_limits lim;
+    struct drive_profile prof;
+    pump_limits(&pump, &lim);
+    drive_profile_plan(&lim, duration_ms, &prof);
+    uint32_t wall_ms = drive_profile_total_ms(&prof);
+    uint16_t duty = drive_profile_duty(&prof, 0);
 
-    if (dir > 0) {  /* PUMP_DIR_OUT */
-        gpio_pin_set_dt(pump.in1, 1);
-        gpio_pin_set_dt(pump.in2, 0);
-    } else {  /* PUMP_DIR_IN */
-        gpio_pin_set_dt(pump.in1, 0);
-        gpio_pin_set_dt(pump.in2, 1);
+    if (duration_ms > 0 && wall_ms != duration_ms) {
+        APP_LOGD(PUMP_RAMP, dir > 0 ? "OUT" : "IN", (unsigned)duration_ms,
+                 (unsigned)wall_ms, (unsigned)(prof.peak_pm / 10U));
+    } else {
+        APP_LOGD(PUMP_RUN, dir > 0 ? "OUT" : "IN", (unsigned)duration_ms);
     }
 
+    /* A run already in progress is settled and replaced */
+    k_mutex_lock(&pump.drive_lock, K_FOREVER);
+    k_spinlock_key_t key = k_spin_lock(&pump.lock);
+    int64_t now = k_uptime_ticks();
+    (void)pump_settle(&pump, now, duty);
+    /* dir > 0 = PUMP_DIR_OUT, dir < 0 = PUMP_DIR_IN */
+    pump.dir = (dir > 0) ? +1 : -1;
+    pump.profile = prof;
+    pump.start_ticks = now;
+    pump.requested_ms = (duration_ms == 0) ? 0 : wall_ms;
     pump.running = true;
-    pump.position_sec += (dir > 0) ? (int32_t)duration_s : -(int32_t)duration_s;
+    k_spin_unlock(&pump.lock, key);
+    pump_out(&pump);
+    k_mutex_unlock(&pump.drive_lock);
+    actuator_acct_on(DIVE_ACT_PUMP, dir);
 
-    if (duration_s > 0) {
-        k_work_schedule(&pump.stop_work, K_SECONDS(duration_s));
-        app_printk("[PUMP] will auto-stop in %us\r\n", duration_s);
+    uint32_t next = drive_profile_next_ms(&prof, 0, PUMP_RAMP_STEP_MS);
+    if (next != DRIVE_CRUISE_FOREVER) {
+        k_work_schedule_for_queue(actuator_wq(), &pump.ramp_work, K_MSEC(next));
     }
+    if (duration_ms > 0) {
+        k_work_schedule_for_queue(actuator_wq(), &pump.stop_work, K_MSEC(wall_ms));
+    }
+}
+
+void pump_stop(void)
+{
+    pump_cmd_ms(0, 0);
+}
+
+bool pump_is_running(void)
+{
+    return pump.running;
 }
 
-int32_t pump_get_position_sec(void)
+int32_t pump_get_position_ms(void)
 {
-    return pump.position_sec;
+    k_spinlock_key_t key = k_spin_lock(&pump.lock);
+    int64_t pos_us = pump.position_us + pump_run_us(&pump, k_uptime_ticks());
+    k_spin_unlock(&pump.lock, key);
+    return (int32_t)(pos_us / 1000);
+}
+
+void pump_set_position_ms(int32_t position_ms)
+{
+    k_spinlock_key_t key = k_spin_lock(&pump.lock);
+    pump.position_us = (int64_t)position_ms * 1000;
+    pump.seg_ticks = k_uptime_ticks();     /* a run in progress counts from here */
+    k_spin_unlock(&pump.lock, key);
 }
 
 void pump_reset_position(void)
 {
-    pump_all_low(&pump);
-    pump.running = false;
-    pump.position_sec = 0;
+    uint32_t requested_ms;
+
     k_work_cancel_delayable(&pump.stop_work);
+    k_work_cancel_delayable(&pump.ramp_work);
+    (void)pump_halt(&pump, &requested_ms);
+    pump_set_position_ms(0);
 }
 
 #else
@@ -129,13 +295,22 @@ int pump_init(void)
     return 0;
 }
 
-void pump_run(int dir, uint32_t duration_s)
+void pump_cmd_ms(int dir, uint32_t duration_ms)
 {
     (void)dir;
-    (void)duration_s;
+    (void)duration_ms;
+}
+
+void pump_stop(void)
+{
 }
 
-int32_t pump_get_position_sec(void)
+bool pump_is_running(void)
+{
+    return false;
+}
+
+int32_t pump_get_position_ms(void)
 {
     return 0;
 }
@@ -144,5 +319,10 @@ void pump_reset_position(void)
 {
 }
 
+void pump_set_position_ms(int32_t position_ms)
+{
+    (void)position_ms;
+}
+
 #endif
 
@@ -0,0 +1,258 @@
+/* log_codec.c - compressed blocks for the flash sample log (no Zephyr dependencies) */
+#include <stddef.h>
+#include <string.h>
+
+#include "log_codec.h"
+
+#define HEADING_WRAP 36000         /* centidegrees */
+
+/* Channels predicted from the previous step as well as the previous value */
+static bool second_order(int ch)
+{
+    return ch == LOG_CH_T || ch == LOG_CH_DEPTH;
+}
+
+static int32_t get_ch(const struct log_rec *r, int ch)
+{
+    switch (ch) {
+    case LOG_CH_T:           return (int32_t)r->t_ms;
+    case LOG_CH_DEPTH:       return r->depth_mm;
+    case LOG_CH_HEADING:     return r->heading_cdeg;
+    case LOG_CH_PITCH:       return r->pitch_cdeg;
+    case LOG_CH_ROLL:        return r->roll_cdeg;
+    case LOG_CH_INTERNAL_PA: return r->internal_pa;
+    case LOG_CH_TEMP:        return r->temp_cc;
+    case LOG_CH_POS_ROLL:    return r->pos_10ms[DIVE_ACT_ROLL];
+    case LOG_CH_POS_PITCH:   return r->pos_10ms[DIVE_ACT_PITCH];
+    case LOG_CH_POS_PUMP:    return r->pos_10ms[DIVE_ACT_PUMP];
+    case LOG_CH_STATE:       return r->state;
+    default:                 return 0;
+    }
+}
+
+static void set_ch(struct log_rec *r, int ch, int32_t v)
+{
+    switch (ch) {
+    case LOG_CH_T:           r->t_ms = (uint32_t)v; break;
+    case LOG_CH_DEPTH:       r->depth_mm = v; break;
+    case LOG_CH_HEADING:     r->heading_cdeg = (uint16_t)v; break;
+    case LOG_CH_PITCH:       r->pitch_cdeg = (int16_t)v; break;
+    case LOG_CH_ROLL:        r->roll_cdeg = (int16_t)v; break;
+    case LOG_CH_INTERNAL_PA: r->internal_pa = v; break;
+    case LOG_CH_TEMP:        r->temp_cc = (int16_t)v; break;
+    case LOG_CH_POS_ROLL:    r->pos_10ms[DIVE_ACT_ROLL] = (int16_t)v; break;
+    case LOG_CH_POS_PITCH:   r->pos_10ms[DIVE_ACT_PITCH] = (int16_t)v; break;
+    case LOG_CH_POS_PUMP:    r->pos_10ms[DIVE_ACT_PUMP] = (int16_t)v; break;
+    case LOG_CH_STATE:       r->state = (uint8_t)v; break;
+    default:                 break;
+    }
+}
+
+/* Prediction for the next value; a keyframe predicts 0 everywhere */
+static int32_t predict(const int32_t *prev, const int32_t *step, int ch)
+{
+    uint32_t p = (uint32_t)prev[ch];
+    if (second_order(ch)) {
+        p += (uint32_t)step[ch];
+    }
+    return (int32_t)p;
+}
+
+/* Error of v against the prediction; wraps like the channel does */
+static int32_t residual(int ch, int32_t v, int32_t pred)
+{
+    int32_t e = (int32_t)((uint32_t)v - (uint32_t)pred);
+    if (ch == LOG_CH_HEADING) {
+        e %= HEADING_WRAP;
+        if (e >= HEADING_WRAP / 2) {
+            e -= HEADING_WRAP;
+        } else if (e < -HEADING_WRAP / 2) {
+            e += HEADING_WRAP;
+        }
+    }
+    return e;
+}
+
+static int32_t apply(int ch, int32_t pred, int32_t e)
+{
+    int32_t v = (int32_t)((uint32_t)pred + (uint32_t)e);
+    if (ch == LOG_CH_HEADING) {
+        v %= HEADING_WRAP;
+        if (v < 0) {
+            v += HEADING_WRAP;
+        }
+    }
+    return v;
+}
+
+/* Advance the predictor; the step is not carried out of a keyframe */
+static void update(int32_t *prev, int32_t *step, int ch, int32_t v, bool key)
+{
+    step[ch] = key ? 0 : (int32_t)((uint32_t)v - (uint32_t)prev[ch]);
+    prev[ch] = v;
+}
+
+static uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t u)
+{
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1U);
+}
+
+/* Varint (7 bits per byte, low first); 0 when it does not fit */
+static size_t put_varint(uint8_t *p, size_t room, uint32_t v)
+{
+    size_t n = 0;
+    do {
+        if (n == room) {
+            return 0;
+        }
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        p[n++] = b | (v ? 0x80 : 0);
+    } while (v);
+    return n;
+}
+
+/* 0 on a truncated or over-long varint */
+static size_t get_varint(const uint8_t *p, size_t room, uint32_t *v)
+{
+    uint32_t x = 0;
+    for (size_t n = 0; n < room && n < 5; n++) {
+        x |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *v = x;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+/* CRC-16/CCITT-FALSE */
+static uint16_t crc16(uint16_t crc, const uint8_t *p, size_t len)
+{
+    while (len--) {
+        crc ^= (uint16_t)(*p++ << 8);
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t block_crc(const struct log_block *b)
+{
+    uint16_t crc = crc16(0xFFFF, (const uint8_t *)&b->h, offsetof(struct log_block_hdr, crc));
+    crc = crc16(crc, (const uint8_t *)&b->h.count,
+                sizeof(b->h) - offsetof(struct log_block_hdr, count));
+    return crc16(crc, b->data, b->h.len);
+}
+
+void log_enc_begin(struct log_enc *e, uint32_t first)
+{
+    memset(&e->blk.h, 0, sizeof(e->blk.h));
+    e->blk.h.first = first;
+    e->blk.h.version = LOG_BLOCK_VERSION;
+    memset(e->prev, 0, sizeof(e->prev));
+    memset(e->step, 0, sizeof(e->step));
+}
+
+bool log_enc_add(struct log_enc *e, const struct log_rec *r)
+{
+    struct log_block *b = &e->blk;
+    bool key = (b->h.count == 0);
+    uint32_t zz[LOG_CH__COUNT];
+    uint32_t mask = 0;
+    uint8_t buf[5 * (LOG_CH__COUNT + 1)];
+    size_t n = 0;
+
+    if (b->h.count == UINT8_MAX) {
+        return false;
+    }
+    for (int ch = 0; ch < LOG_CH__COUNT; ch++) {
+        zz[ch] = zigzag(residual(ch, get_ch(r, ch), predict(e->prev, e->step, ch)));
+        if (zz[ch] != 0) {
+            mask |= 1U << ch;
+        }
+    }
+    n += put_varint(buf + n, sizeof(buf) - n, mask);
+    for (int ch = 0; ch < LOG_CH__COUNT; ch++) {
+        if (mask & (1U << ch)) {
+            n += put_varint(buf + n, sizeof(buf) - n, zz[ch]);
+        }
+    }
+    if (n > (size_t)LOG_BLOCK_PAYLOAD - b->h.len) {
+        return false;
+    }
+
+    memcpy(b->data + b->h.len, buf, n);
+    b->h.len += (uint16_t)n;
+    b->h.count++;
+    for (int ch = 0; ch < LOG_CH__COUNT; ch++) {
+        update(e->prev, e->step, ch, get_ch(r, ch), key);
+    }
+    return true;
+}
+
+void log_enc_seal(struct log_enc *e, uint32_t seq)
+{
+    struct log_block *b = &e->blk;
+
+    b->h.seq = seq;
+    memset(b->data + b->h.len, 0xFF, (size_t)LOG_BLOCK_PAYLOAD - b->h.len);
+    b->h.crc = block_crc(b);
+}
+
+bool log_block_valid(const struct log_block *b)
+{
+    return b->h.seq != LOG_REC_NO_SEQ && b->h.version == LOG_BLOCK_VERSION &&
+           b->h.len <= LOG_BLOCK_PAYLOAD && b->h.crc == block_crc(b);
+}
+
+void log_dec_begin(struct log_dec *d, const struct log_block *b)
+{
+    d->b = b;
+    d->pos = 0;
+    d->n = 0;
+    memset(d->prev, 0, sizeof(d->prev));
+    memset(d->step, 0, sizeof(d->step));
+}
+
+bool log_dec_next(struct log_dec *d, struct log_rec *out)
+{
+    const struct log_block *b = d->b;
+    bool key = (d->n == 0);
+    uint32_t mask, zz;
+    size_t k;
+
+    if (d->n >= b->h.count) {
+        return false;
+    }
+    k = get_varint(b->data + d->pos, b->h.len - d->pos, &mask);
+    if (k == 0) {
+        return false;
+    }
+    d->pos += (uint16_t)k;
+
+    memset(out, 0, sizeof(*out));
+    for (int ch = 0; ch < LOG_CH__COUNT; ch++) {
+        int32_t e = 0;
+        if (mask & (1U << ch)) {
+            k = get_varint(b->data + d->pos, b->h.len - d->pos, &zz);
+            if (k == 0) {
+                return false;
+            }
+            d->pos += (uint16_t)k;
+            e = unzigzag(zz);
+        }
+        int32_t v = apply(ch, predict(d->prev, d->step, ch), e);
+        set_ch(out, ch, v);
+        update(d->prev, d->step, ch, v, key);
+    }
+    log_rec_seal(out, b->h.first + d->n);
+    d->n++;
+    return true;
+}
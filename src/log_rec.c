@@ -0,0 +1,74 @@
+/* log_rec.c - fixed-point sample record for the flash log (no Zephyr dependencies) */
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "log_rec.h"
+
+/* Round and clamp to a signed 16-bit field */
+static int16_t to_i16(float v)
+{
+    v = roundf(v);
+    if (v > 32767.0f) {
+        return 32767;
+    }
+    if (v < -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)v;
+}
+
+/* CRC-8, polynomial 0x07 */
+static uint8_t crc8(const uint8_t *p, size_t len)
+{
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void log_rec_pack(struct log_rec *r, const struct dive_sample *s, enum dive_state st,
+                  const int32_t pos_ms[DIVE_ACT__COUNT])
+{
+    float heading = fmodf(s->heading_deg, 360.0f);
+
+    memset(r, 0, sizeof(*r));
+    r->t_ms = (uint32_t)s->t_ms;
+    r->depth_mm = (int32_t)lroundf(s->depth_m * 1000.0f);
+    r->internal_pa = s->internal_pa;
+    r->temp_cc = to_i16(s->temp_c * 100.0f);
+    r->heading_cdeg = (uint16_t)lroundf(((heading < 0.0f) ? heading + 360.0f : heading) * 100.0f);
+    r->pitch_cdeg = to_i16(s->pitch_deg * 100.0f);
+    r->roll_cdeg = to_i16(s->roll_deg * 100.0f);
+    for (int i = 0; i < DIVE_ACT__COUNT; i++) {
+        r->pos_10ms[i] = to_i16((float)pos_ms[i] / 10.0f);
+    }
+    r->state = (uint8_t)st;
+}
+
+void log_rec_unpack(const struct log_rec *r, struct dive_sample *s)
+{
+    s->t_ms = r->t_ms;
+    s->internal_pa = r->internal_pa;
+    s->depth_m = (float)r->depth_mm / 1000.0f;
+    s->temp_c = (float)r->temp_cc / 100.0f;
+    s->heading_deg = (float)r->heading_cdeg / 100.0f;
+    s->pitch_deg = (float)r->pitch_cdeg / 100.0f;
+    s->roll_deg = (float)r->roll_cdeg / 100.0f;
+}
+
+void log_rec_seal(struct log_rec *r, uint32_t seq)
+{
+    r->seq = seq;
+    r->crc = crc8((const uint8_t *)r, offsetof(struct log_rec, crc));
+}
+
+bool log_rec_valid(const struct log_rec *r)
+{
+    return r->seq != LOG_REC_NO_SEQ &&
+           r->crc == crc8((const uint8_t *)r, offsetof(struct log_rec, crc));
+}
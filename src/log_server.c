@@ -0,0 +1,228 @@
+#include <zephyr/kernel.h>
+#include <zephyr/net/socket.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_server.h"
+#include "flash_log.h"
+#include "app_print.h"
+
+#define LOGSRV_CHUNK_BLOCKS 8       /* 2 KB per flash read and send */
+#define LOGSRV_LINE_MAX     48
+#define LOGSRV_RX_TIMEOUT_S 60      /* drop a client idle this long */
+
+static struct log_block chunk[LOGSRV_CHUNK_BLOCKS];
+
+/* Wait until fd is ready for events; false after LOGSRV_RX_TIMEOUT_S or an
+ * error. A half-open client (WiFi lost at the surface) sends no RST, and
+ * the server takes one client at a time, so every blocking call is
+ * bounded here rather than by SO_RCVTIMEO. */
+static bool wait_ready(int fd, short events)
+{
+    struct zsock_pollfd pfd = { .fd = fd, .events = events };
+
+    int n = zsock_poll(&pfd, 1, LOGSRV_RX_TIMEOUT_S * MSEC_PER_SEC);
+    if (n <= 0) {
+        if (n == 0) {
+            app_printk("[LOGSRV] client idle for %ds, dropped\r\n", LOGSRV_RX_TIMEOUT_S);
+        }
+        return false;
+    }
+    return (pfd.revents & (ZSOCK_POLLERR | ZSOCK_POLLNVAL)) == 0;
+}
+
+/* Send all of buf; false once the client is gone */
+static bool send_all(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+
+    while (len > 0) {
+        if (!wait_ready(fd, ZSOCK_POLLOUT)) {
+            return false;
+        }
+        ssize_t n = zsock_send(fd, p, len, ZSOCK_MSG_DONTWAIT);
+        if (n < 0 && errno == EAGAIN) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool send_line(int fd, const char *line)
+{
+    return send_all(fd, line, strlen(line));
+}
+
+/* One request line, without the terminator; false on disconnect */
+static bool recv_line(int fd, char *line, size_t max)
+{
+    size_t len = 0;
+
+    for (;;) {
+        char c;
+        if (!wait_ready(fd, ZSOCK_POLLIN)) {
+            return false;
+        }
+        ssize_t n = zsock_recv(fd, &c, 1, 0);
+        if (n <= 0) {
+            return false;
+        }
+        if (c == '\n') {
+            break;
+        }
+        if (c != '\r' && len + 1 < max) {
+            line[len++] = c;
+        }
+    }
+    line[len] = '\0';
+    return true;
+}
+
+/* Stream [off, off + len) of the block stream, straight from flash */
+static bool serve_get(int fd, uint64_t off, uint64_t len)
+{
+    struct flash_log_info info;
+    char hdr[LOGSRV_LINE_MAX];
+
+    flash_log_get_info(&info);
+    uint64_t first = (uint64_t)info.first_seq * LOG_BLOCK_SIZE;
+    uint64_t end = (uint64_t)info.next_seq * LOG_BLOCK_SIZE;
+    if (off < first) {
+        off = first;
+    }
+    if (off > end) {
+        off = end;
+    }
+    if (len == 0 || len > end - off) {
+        len = end - off;
+    }
+    snprintf(hdr, sizeof(hdr), "DATA %llu %llu\n", (unsigned long long)off,
+             (unsigned long long)len);
+    if (!send_line(fd, hdr)) {
+        return false;
+    }
+
+    int64_t t0 = k_uptime_get();
+    uint64_t sent = 0;
+    uint32_t seq = (uint32_t)(off / LOG_BLOCK_SIZE);
+    size_t skip = (size_t)(off % LOG_BLOCK_SIZE);   /* into the first block */
+
+    while (sent < len) {
+        uint32_t want = seq;
+        int n = flash_log_read(&seq, chunk, LOGSRV_CHUNK_BLOCKS);
+        if (n <= 0 || seq != want) {
+            /* The ring wrapped past us mid-transfer: the client sees a
+             * short read and asks again */
+            app_printk("[LOGSRV] log moved under the transfer at seq %u\r\n", want);
+            return false;
+        }
+        size_t bytes = (size_t)n * LOG_BLOCK_SIZE - skip;
+        if (bytes > len - sent) {
+            bytes = (size_t)(len - sent);
+        }
+        if (!send_all(fd, (const uint8_t *)chunk + skip, bytes)) {
+            app_printk("[LOGSRV] client gone after %llu of %llu bytes\r\n",
+                       (unsigned long long)sent, (unsigned long long)len);
+            return false;
+        }
+        sent += bytes;
+        seq += (uint32_t)n;
+        skip = 0;
+    }
+
+    uint32_t ms = (uint32_t)(k_uptime_get() - t0);
+    app_printk("[LOGSRV] sent %llu bytes from %llu in %ums (%.1f kB/s)\r\n",
+               (unsigned long long)sent, (unsigned long long)off, ms,
+               (ms > 0) ? (double)sent / (double)ms : 0.0);
+    return true;
+}
+
+static void serve_client(int fd)
+{
+    char line[LOGSRV_LINE_MAX];
+    char reply[LOGSRV_LINE_MAX];
+
+    while (recv_line(fd, line, sizeof(line))) {
+        if (strcmp(line, "INFO") == 0) {
+            /* Sealed blocks only: sealing here would burn a partial block
+             * (and maybe an erase) on every poll; deploy flushes the open
+             * block at surfacing */
+            struct flash_log_info info;
+            flash_log_get_info(&info);
+            snprintf(reply, sizeof(reply), "FLOG %llu %llu %u\n",
+                     (unsigned long long)info.first_seq * LOG_BLOCK_SIZE,
+                     (unsigned long long)info.next_seq * LOG_BLOCK_SIZE, LOG_BLOCK_SIZE);
+            if (!send_line(fd, reply)) {
+                return;
+            }
+        } else if (strncmp(line, "GET ", 4) == 0) {
+            char *end = NULL;
+            unsigned long long off = strtoull(line + 4, &end, 10);
+            unsigned long long len = strtoull(end, NULL, 10);
+            if (end == line + 4) {
+                if (!send_line(fd, "ERR offset\n")) {
+                    return;
+                }
+            } else if (!serve_get(fd, off, len)) {
+                return;
+            }
+        } else if (strcmp(line, "QUIT") == 0) {
+            return;
+        } else if (!send_line(fd, "ERR unknown request\n")) {
+            return;
+        }
+    }
+}
+
+static void log_server_task(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1); ARG_UNUSED(p2); ARG_UNUSED(p3);
+
+    /* Let the AP and its address come up first */
+    k_sleep(K_SECONDS(4));
+
+    int srv = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (srv < 0) {
+        app_printk("[LOGSRV] socket() failed: %d\r\n", srv);
+        return;
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(LOG_SERVER_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    int opt = 1;
+    (void)zsock_setsockopt(srv, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    while (zsock_bind(srv, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        k_sleep(K_SECONDS(2));
+    }
+    if (zsock_listen(srv, 1) != 0) {
+        app_printk("[LOGSRV] listen failed\r\n");
+        zsock_close(srv);
+        return;
+    }
+    app_printk("[LOGSRV] log download on port %d\r\n", LOG_SERVER_PORT);
+
+    while (1) {
+        struct sockaddr_in cli;
+        socklen_t clilen = sizeof(cli);
+        int fd = zsock_accept(srv, (struct sockaddr *)&cli, &clilen);
+        if (fd < 0) {
+            k_sleep(K_MSEC(200));
+            continue;
+        }
+        serve_client(fd);
+        zsock_close(fd);
+    }
+}
+
+/* Below the deploy worker: a download never delays the control loop */
+K_THREAD_DEFINE(log_srv, 2048, log_server_task, NULL, NULL, NULL, 9, 0, 0);
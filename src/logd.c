@@ -0,0 +1,242 @@
+/* logd.c - deferred (dictionary) log records (no Zephyr dependencies) */
+#include <stdio.h>
+#include <string.h>
+
+#include "logd.h"
+
+const struct logd_fmt logd_dict[LOGD__COUNT] = {
+#define LOGD_ENTRY(name, lvl) [LOGD_##name] = { (lvl), LOGD_FMT_##name },
+    LOGD_FORMATS(LOGD_ENTRY)
+#undef LOGD_ENTRY
+};
+
+/* Argument reader over a record */
+struct logd_args {
+    const uint8_t *p;
+    const uint8_t *end;
+};
+
+static bool take(struct logd_args *a, void *v, size_t n)
+{
+    if ((size_t)(a->end - a->p) < n) {
+        return false;
+    }
+    memcpy(v, a->p, n);
+    a->p += n;
+    return true;
+}
+
+/* Append one conversion; spec is the whole "%...c" */
+static bool format_arg(struct logd_args *a, const char *spec, char conv, int lmod,
+                       char *out, size_t len, int *n)
+{
+    int w = -1;
+
+    switch (conv) {
+    case 'd': case 'i': {
+        if (lmod == 2) {
+            int64_t v;
+            if (!take(a, &v, 8)) return false;
+            w = snprintf(out, len, spec, (long long)v);
+        } else {
+            int32_t v;
+            if (!take(a, &v, 4)) return false;
+            w = (lmod == 1) ? snprintf(out, len, spec, (long)v) : snprintf(out, len, spec, (int)v);
+        }
+        break;
+    }
+    case 'u': case 'x': case 'X': case 'o': {
+        if (lmod == 2) {
+            uint64_t v;
+            if (!take(a, &v, 8)) return false;
+            w = snprintf(out, len, spec, (unsigned long long)v);
+        } else {
+            uint32_t v;
+            if (!take(a, &v, 4)) return false;
+            w = (lmod == 1) ? snprintf(out, len, spec, (unsigned long)v)
+                            : snprintf(out, len, spec, (unsigned int)v);
+        }
+        break;
+    }
+    case 'c': {
+        int32_t v;
+        if (!take(a, &v, 4)) return false;
+        w = snprintf(out, len, spec, (int)v);
+        break;
+    }
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+        float v;
+        if (!take(a, &v, 4)) return false;
+        w = snprintf(out, len, spec, (double)v);
+        break;
+    }
+    case 's': {
+        uint8_t sl;
+        char s[LOGD_STR_MAX + 1];
+        if (!take(a, &sl, 1) || sl > LOGD_STR_MAX || !take(a, s, sl)) return false;
+        s[sl] = '\0';
+        w = snprintf(out, len, spec, s);
+        break;
+    }
+    default:
+        return false;
+    }
+    if (w < 0) {
+        return false;
+    }
+    *n = w;
+    return true;
+}
+
+int logd_format(const uint8_t *rec, size_t rec_len, char *out, size_t len)
+{
+    if (rec_len < 1 || rec[0] >= LOGD__COUNT || len == 0) {
+        return -1;
+    }
+
+    const char *f = logd_dict[rec[0]].fmt;
+    struct logd_args a = { rec + 1, rec + rec_len };
+    size_t o = 0;
+
+    out[0] = '\0';
+    while (*f) {
+        if (*f != '%' || f[1] == '%') {
+            if (o + 1 < len) {
+                out[o++] = *f;
+                out[o] = '\0';
+            }
+            f += (*f == '%') ? 2 : 1;
+            continue;
+        }
+
+        /* %[flags][width][.precision][length]conversion */
+        const char *start = f++;
+        while (*f && strchr("-+ #0", *f)) f++;
+        while (*f >= '0' && *f <= '9') f++;
+        if (*f == '.') {
+            f++;
+            while (*f >= '0' && *f <= '9') f++;
+        }
+        int lmod = 0;
+        while (*f == 'l' || *f == 'h' || *f == 'z') {
+            lmod += (*f == 'l');
+            f++;
+        }
+        char conv = *f;
+        if (conv == '\0') {
+            return -1;
+        }
+        f++;
+
+        char spec[16];
+        size_t sl = (size_t)(f - start);
+        if (sl >= sizeof(spec)) {
+            return -1;
+        }
+        memcpy(spec, start, sl);
+        spec[sl] = '\0';
+
+        int w;
+        if (!format_arg(&a, spec, conv, lmod, out + o, len - o, &w)) {
+            return -1;
+        }
+        o += (size_t)w;
+        if (o >= len) {
+            o = len - 1;
+        }
+    }
+    return (a.p == a.end) ? (int)o : -1;
+}
+
+/* --- Raw lines --- */
+
+static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static uint8_t crc8(const uint8_t *p, size_t n)
+{
+    uint8_t crc = 0;
+    while (n--) {
+        crc ^= *p++;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t logd_line_encode(const uint8_t *rec, size_t rec_len, char *out, size_t len)
+{
+    uint8_t buf[LOGD_REC_MAX + 1];
+    size_t o = 2;
+
+    if (rec_len > LOGD_REC_MAX || len < 2 + (rec_len + 3) / 3 * 4 + 3) {
+        return 0;
+    }
+    memcpy(buf, rec, rec_len);
+    buf[rec_len] = crc8(rec, rec_len);
+    rec_len++;
+
+    memcpy(out, LOGD_LINE_TAG, 2);
+    for (size_t i = 0; i < rec_len; i += 3) {
+        uint32_t v = (uint32_t)buf[i] << 16;
+        size_t k = rec_len - i;
+        if (k > 1) v |= (uint32_t)buf[i + 1] << 8;
+        if (k > 2) v |= buf[i + 2];
+        out[o++] = b64[(v >> 18) & 63];
+        out[o++] = b64[(v >> 12) & 63];
+        if (k > 1) out[o++] = b64[(v >> 6) & 63];
+        if (k > 2) out[o++] = b64[v & 63];
+    }
+    out[o++] = '\r';
+    out[o++] = '\n';
+    out[o] = '\0';
+    return o;
+}
+
+size_t logd_line_decode(const char *line, uint8_t *rec, size_t max)
+{
+    uint32_t v = 0;
+    int bits = 0;
+    size_t n = 0;
+
+    if (strncmp(line, LOGD_LINE_TAG, 2) != 0) {
+        return 0;
+    }
+    for (const char *c = line + 2; *c && *c != '\r' && *c != '\n'; c++) {
+        const char *d = strchr(b64, *c);
+        if (!d) {
+            return 0;
+        }
+        v = (v << 6) | (uint32_t)(d - b64);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (n >= max) {
+                return 0;
+            }
+            rec[n++] = (uint8_t)(v >> bits);
+        }
+    }
+    if (n < 2 || crc8(rec, n - 1) != rec[n - 1]) {
+        return 0;
+    }
+    return n - 1;
+}
+
+uint32_t logd_dict_crc(void)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (int i = 0; i < LOGD__COUNT; i++) {
+        const uint8_t *p = (const uint8_t *)logd_dict[i].fmt;
+        size_t n = strlen(logd_dict[i].fmt) + 1;   /* NUL separates entries */
+        while (n--) {
+            crc ^= *p++;
+            for (int b = 0; b < 8; b++) {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+            }
+        }
+        crc ^= logd_dict[i].level;
+    }
+    return ~crc;
+}
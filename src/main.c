@@ -26,8 +26,15 @@
 #include "ui_menu.h"
 #include "hw_motors.h"
 #include "hw_pump.h"
+#include "actuator_wq.h"
+#include "act_sched.h"
 #include "hw_limit_switches.h"
 #include "app_params.h"
+#include "app_print.h"
+#include "mission.h"
+#include "dive_stats.h"
+#include "flash_log.h"
+#include "checkpoint.h"
 #include "ota_simple.h"
 #include "build_info.h"
 #include "version.h"
@@ -117,6 +124,12 @@ static bool uart_getch(uint8_t *out) {
     return (uart_poll_in(uart_console, (unsigned char *)out) == 0);
 }
 
+/* Echo typed input on UART0 only (telnet echoes its own), through the
+ * same ring as app_printk() so it stays in order with queued output */
+static void echo_uart0(const char *s, size_t len) {
+    app_print_write(APP_LVL_INF, APP_SINK_UART0, s, len);
+}
+
 /* Timers & events */
 static void timeout_cb(struct k_timer *tmr); K_TIMER_DEFINE(startup_timeout, timeout_cb, NULL);
 static void tick_cb(struct k_timer *tmr);    K_TIMER_DEFINE(ui_tick, tick_cb, NULL);
@@ -140,14 +153,15 @@ static bool read_line_nonblock(char *buf, size_t buflen, bool *enter_only) {
         if (n == 0) {
             *enter_only = true;
             /* Echo newline to UART for consistency */
-            printk("\r\n");
+            echo_uart0("\r\n", 2);
             return false;
         }
         if (n >= buflen) n = buflen-1;
         memcpy(buf, line_tmp, n);
         buf[n] = '\0';
         /* Echo line to UART console too */
-        printk("%s\r\n", buf);
+        echo_uart0(buf, n);
+        echo_uart0("\r\n", 2);
         return true;
     }
     return false;
@@ -158,18 +172,18 @@ static bool read_line_nonblock(char *buf, size_t buflen, bool *enter_only) {
     while (uart_getch(&ch)) {
         if (ch=='\r'||ch=='\n') {
             if (idx > 0) {
-                printk("\r\n");
+                echo_uart0("\r\n", 2);
                 buf[idx]='\0';
                 idx=0;
                 return true;
             } else {
-                printk("\r\n");
+                echo_uart0("\r\n", 2);
                 *enter_only = true;
                 return false;
             }
         } else if (idx<buflen-1) {
             buf[idx++]=(char)ch;
-            printk("%c", ch);
+            echo_uart0((const char *)&ch, 1);
         }
     }
     return false;
@@ -472,47 +486,62 @@ K_THREAD_DEFINE(tcp_echo, 4096, tcp_echo_server_task, NULL, NULL, NULL, 6, 0, 0)
 /* ------------------- Main loop ------------------- */
 void main(void) {
     /* Boot banner */
-    printk("=== ESP32 Boot ===\r\n");
+    app_printk("=== ESP32 Boot ===\r\n");
     k_sleep(K_MSEC(50));
 
     /* Init settings (NVS) and app params */
     int r = settings_subsys_init();
-    printk("Settings init: %d\r\n", r);
+    app_printk("Settings init: %d\r\n", r);
     (void)app_params_init();
     app_printk("Params: initialized and loaded\r\n");
+    (void)mission_init();
+    (void)dive_stats_init();
+    (void)flash_log_init();
 
 #if defined(CONFIG_I2C)
     app_printk("I2C: scanning buses...\r\n");
     scan_i2c_buses();
 #endif
 
-    /* Init motors & pump */
-    printk("Initializing pump...\r\n");
+    /* Init motors & pump; their stop timers run on the actuator queue */
+    (void)actuator_wq_init();
+    (void)act_sched_init();
+    app_printk("Initializing pump...\r\n");
     (void)pump_init();
-    printk("Pump initialized\r\n");
-    printk("Initializing motors...\r\n");
+    app_printk("Pump initialized\r\n");
+    app_printk("Initializing motors...\r\n");
     (void)motors_init();
-    printk("Motors initialized\r\n");
-    printk("Initializing limit switches...\r\n");
+    app_printk("Motors initialized\r\n");
+    app_printk("Initializing limit switches...\r\n");
     (void)limit_switches_init();
-    printk("Limit switches initialized\r\n");
+    app_printk("Limit switches initialized\r\n");
+
+    /* After the actuators: an interrupted deployment restores their positions */
+    (void)checkpoint_init();
 
     /* Init OTA subsystem */
-    printk("Initializing OTA subsystem...\r\n");
+    app_printk("Initializing OTA subsystem...\r\n");
     (void)ota_simple_init();
-    printk("OTA subsystem initialized\r\n");
+    app_printk("OTA subsystem initialized\r\n");
 
-    printk("Main loop starting...\r\n");
+    app_printk("Main loop starting...\r\n");
     k_sleep(K_MSEC(100));
 
     /* Start timers */
-    /* Match startup timeout to STARTUP_TIMEOUT_SEC (10 min now) */
-    k_timer_start(&startup_timeout, K_SECONDS(STARTUP_TIMEOUT_SEC), K_NO_WAIT);
     k_timer_start(&ui_tick, K_MSEC(50), K_MSEC(50));
 
-    /* Initialize state machine to POWERUP_WAIT */
+    /* Initialize state machine to POWERUP_WAIT, or straight back to
+     * DEPLOYED if a deployment was interrupted by a reset */
     state_id_t state = ST_POWERUP_WAIT;
-    on_entry_POWERUP_WAIT();
+    if (checkpoint_pending()) {
+        app_printk("[CKPT] resuming deployment, skipping startup wait\r\n");
+        state = ST_DEPLOYED;
+        on_entry_DEPLOYED();
+    } else {
+        /* Match startup timeout to STARTUP_TIMEOUT_SEC (10 min now) */
+        k_timer_start(&startup_timeout, K_SECONDS(STARTUP_TIMEOUT_SEC), K_NO_WAIT);
+        on_entry_POWERUP_WAIT();
+    }
 
     /* Main event loop */
     while (1) {
@@ -553,6 +582,9 @@ void main(void) {
                     case ST_COMPASS_MENU:
                         on_entry_COMPASS_MENU();
                         break;
+                    case ST_MISSION_MENU:
+                        on_entry_MISSION_MENU();
+                        break;
                     default:
                         break;
                 }
@@ -604,6 +636,9 @@ void main(void) {
                 case ST_SIMULATE:
                     new_state = on_event_SIMULATE(&event);
                     break;
+                case ST_MISSION_MENU:
+                    new_state = on_event_MISSION_MENU(&event);
+                    break;
                 case ST_COMPASS_MENU:
                     /* COMPASS_MENU not yet implemented; stay in current state */
                     new_state = state;
@@ -612,9 +647,6 @@ void main(void) {
                     break;
             }
             
-            /* SAFETY: Check and handle any triggered limit switches (motor stop) */
-            limit_switches_check_and_stop();
-            
             /* Transition to new state if needed */
             if (new_state != ST__COUNT && new_state != state) {
                 if (state == ST_POWERUP_WAIT) on_exit_POWERUP_WAIT();
@@ -646,6 +678,9 @@ void main(void) {
                     case ST_COMPASS_MENU:
                         on_entry_COMPASS_MENU();
                         break;
+                    case ST_MISSION_MENU:
+                        on_entry_MISSION_MENU();
+                        break;
                     default:
                         break;
                 }
@@ -0,0 +1,299 @@
+/* mission.c - mission table and interpreter (no Zephyr dependencies) */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mission.h"
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+static const char *const surface_names[MISSION_SURF__COUNT] = {
+    [MISSION_SURF_PROMPT] = "prompt",
+    [MISSION_SURF_GPS]    = "gps",
+    [MISSION_SURF_SKIP]   = "skip",
+};
+
+void mission_defaults(struct mission *m)
+{
+    memset(m, 0, sizeof(*m));
+    m->version = MISSION_VERSION;
+    m->count = 1;
+    m->flags = MISSION_F_REPEAT;
+
+    struct mission_step *s = &m->steps[0];
+    s->depth_dm = 0;
+    s->heading_deg = MISSION_HEADING_INHERIT;
+    s->dive_pitch_s = MISSION_INHERIT;
+    s->dive_pump_s = MISSION_INHERIT;
+    s->climb_pitch_s = MISSION_INHERIT;
+    s->climb_pump_s = MISSION_INHERIT;
+    s->yos = 0;
+    s->surface = MISSION_SURF_PROMPT;
+    s->min_depth_dm = MISSION_DEPTH_INHERIT;
+}
+
+const char *mission_surface_name(enum mission_surface pol)
+{
+    return ((unsigned)pol < MISSION_SURF__COUNT) ? surface_names[pol] : "?";
+}
+
+/* Next whitespace-separated token; NULL at end of line */
+static const char *next_token(const char **pp, size_t *len)
+{
+    const char *p = *pp;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '\0') {
+        return NULL;
+    }
+    const char *start = p;
+    while (*p != '\0' && *p != ' ' && *p != '\t') p++;
+    *len = (size_t)(p - start);
+    *pp = p;
+    return start;
+}
+
+static bool is_inherit(const char *tok, size_t len)
+{
+    return len == 1 && tok[0] == '-';
+}
+
+/* Integer token in [lo, hi] */
+static int parse_int(const char *tok, size_t len, long lo, long hi, long *out)
+{
+    char buf[16];
+    if (len >= sizeof(buf)) {
+        return -EINVAL;
+    }
+    memcpy(buf, tok, len);
+    buf[len] = '\0';
+    char *end = NULL;
+    long v = strtol(buf, &end, 10);
+    if (end == buf || *end != '\0' || v < lo || v > hi) {
+        return -EINVAL;
+    }
+    *out = v;
+    return 0;
+}
+
+/* Metres with one decimal, stored in decimetres */
+static int parse_depth_dm(const char *tok, size_t len, uint16_t *out)
+{
+    char buf[16];
+    if (len >= sizeof(buf)) {
+        return -EINVAL;
+    }
+    memcpy(buf, tok, len);
+    buf[len] = '\0';
+    char *end = NULL;
+    float m = strtof(buf, &end);
+    if (end == buf || *end != '\0' || m < 0.0f || m > 6553.4f) {
+        return -EINVAL;
+    }
+    *out = (uint16_t)(m * 10.0f + 0.5f);
+    return 0;
+}
+
+/* Set-point seconds, '-' for inherit */
+static int parse_setpoint(const char *tok, size_t len, uint8_t *out)
+{
+    long v;
+    if (is_inherit(tok, len)) {
+        *out = MISSION_INHERIT;
+        return 0;
+    }
+    if (parse_int(tok, len, 0, MISSION_INHERIT - 1, &v) != 0) {
+        return -EINVAL;
+    }
+    *out = (uint8_t)v;
+    return 0;
+}
+
+int mission_parse_step(const char *line, struct mission_step *out)
+{
+    const char *tok[9];
+    size_t len[9];
+    const char *p = line;
+    struct mission_step s;
+    long v;
+    int n = 0;
+
+    while (n < 9 && (tok[n] = next_token(&p, &len[n])) != NULL) {
+        n++;
+    }
+    size_t extra;
+    if (n < 8 || next_token(&p, &extra)) {
+        return -EINVAL;
+    }
+
+    memset(&s, 0, sizeof(s));
+
+    /* Depth in metres with one decimal */
+    if (is_inherit(tok[0], len[0])) {
+        s.depth_dm = 0;
+    } else if (parse_depth_dm(tok[0], len[0], &s.depth_dm) != 0 || s.depth_dm == 0) {
+        return -EINVAL;
+    }
+
+    if (parse_setpoint(tok[1], len[1], &s.dive_pitch_s) != 0 ||
+        parse_setpoint(tok[2], len[2], &s.dive_pump_s) != 0 ||
+        parse_setpoint(tok[3], len[3], &s.climb_pitch_s) != 0 ||
+        parse_setpoint(tok[4], len[4], &s.climb_pump_s) != 0) {
+        return -EINVAL;
+    }
+
+    if (is_inherit(tok[5], len[5])) {
+        s.heading_deg = MISSION_HEADING_INHERIT;
+    } else if (parse_int(tok[5], len[5], 0, 359, &v) == 0) {
+        s.heading_deg = (int16_t)v;
+    } else {
+        return -EINVAL;
+    }
+
+    if (is_inherit(tok[6], len[6])) {
+        s.yos = 0;
+    } else if (parse_int(tok[6], len[6], 1, 255, &v) == 0) {
+        s.yos = (uint8_t)v;
+    } else {
+        return -EINVAL;
+    }
+
+    s.surface = MISSION_SURF__COUNT;
+    for (int i = 0; i < MISSION_SURF__COUNT; i++) {
+        if (strlen(surface_names[i]) == len[7] &&
+            strncmp(surface_names[i], tok[7], len[7]) == 0) {
+            s.surface = (uint8_t)i;
+        }
+    }
+    if (s.surface == MISSION_SURF__COUNT) {
+        return -EINVAL;
+    }
+
+    /* Optional yo-yo turn depth */
+    s.min_depth_dm = 0;
+    if (n == 9) {
+        if (is_inherit(tok[8], len[8])) {
+            s.min_depth_dm = MISSION_DEPTH_INHERIT;
+        } else if (parse_depth_dm(tok[8], len[8], &s.min_depth_dm) != 0) {
+            return -EINVAL;
+        }
+    }
+
+    *out = s;
+    return 0;
+}
+
+static void format_setpoint(uint8_t v, char *buf, size_t len)
+{
+    if (v == MISSION_INHERIT) {
+        snprintf(buf, len, "-");
+    } else {
+        snprintf(buf, len, "%u", v);
+    }
+}
+
+int mission_format_step(const struct mission_step *s, char *buf, size_t len)
+{
+    char depth[12], dp[4], dq[4], cp[4], cq[4], hdg[8], yos[4], turn[12];
+
+    if (s->depth_dm == 0) {
+        snprintf(depth, sizeof(depth), "-");
+    } else {
+        snprintf(depth, sizeof(depth), "%u.%u", s->depth_dm / 10U, s->depth_dm % 10U);
+    }
+    if (s->min_depth_dm == MISSION_DEPTH_INHERIT) {
+        snprintf(turn, sizeof(turn), " -");
+    } else if (s->min_depth_dm == 0) {
+        turn[0] = '\0';
+    } else {
+        snprintf(turn, sizeof(turn), " %u.%u", s->min_depth_dm / 10U, s->min_depth_dm % 10U);
+    }
+    format_setpoint(s->yos ? s->yos : MISSION_INHERIT, yos, sizeof(yos));
+    format_setpoint(s->dive_pitch_s, dp, sizeof(dp));
+    format_setpoint(s->dive_pump_s, dq, sizeof(dq));
+    format_setpoint(s->climb_pitch_s, cp, sizeof(cp));
+    format_setpoint(s->climb_pump_s, cq, sizeof(cq));
+    if (s->heading_deg < 0) {
+        snprintf(hdg, sizeof(hdg), "-");
+    } else {
+        snprintf(hdg, sizeof(hdg), "%d", s->heading_deg);
+    }
+
+    return snprintf(buf, len, "%s %s %s %s %s %s %s %s%s", depth, dp, dq, cp, cq, hdg,
+                    yos, mission_surface_name((enum mission_surface)s->surface), turn);
+}
+
+static uint8_t step_yos(const struct mission_step *s, const struct app_params *base)
+{
+    if (s->yos != 0) {
+        return s->yos;
+    }
+    return (base->yoyo_dives > 0) ? (uint8_t)MIN(base->yoyo_dives, 255U) : 1;
+}
+
+void mission_begin(struct mission_cursor *c)
+{
+    c->step = 0;
+    c->yo = 0;
+    c->done = false;
+}
+
+bool mission_cycle_params(const struct mission *m, const struct mission_cursor *c,
+                          const struct app_params *base, struct app_params *out)
+{
+    if (c->done || c->step >= m->count) {
+        return false;
+    }
+    const struct mission_step *s = &m->steps[c->step];
+
+    *out = *base;
+    if (s->depth_dm != 0) {
+        out->dive_depth_m = (float)s->depth_dm / 10.0f;
+    }
+    if (s->dive_pitch_s != MISSION_INHERIT) out->dive_pitch_s = s->dive_pitch_s;
+    if (s->dive_pump_s != MISSION_INHERIT) out->dive_pump_s = s->dive_pump_s;
+    if (s->climb_pitch_s != MISSION_INHERIT) out->climb_pitch_s = s->climb_pitch_s;
+    if (s->climb_pump_s != MISSION_INHERIT) out->climb_pump_s = s->climb_pump_s;
+    if (s->heading_deg >= 0) out->desired_heading_deg = s->heading_deg;
+
+    /* Only the last yo of a step surfaces */
+    float turn_m = (s->min_depth_dm == MISSION_DEPTH_INHERIT)
+        ? base->yoyo_min_depth_m : (float)s->min_depth_dm / 10.0f;
+    out->yoyo_dives = step_yos(s, base);
+    if (c->yo + 1 >= out->yoyo_dives) {
+        turn_m = 0.0f;
+    }
+    out->yoyo_min_depth_m = turn_m;
+    return true;
+}
+
+enum mission_surface mission_cycle_surface(const struct mission *m,
+                                           const struct mission_cursor *c)
+{
+    if (c->step >= m->count || m->steps[c->step].surface >= MISSION_SURF__COUNT) {
+        return MISSION_SURF_PROMPT;
+    }
+    return (enum mission_surface)m->steps[c->step].surface;
+}
+
+void mission_advance(const struct mission *m, struct mission_cursor *c,
+                     const struct app_params *base)
+{
+    if (c->done || c->step >= m->count) {
+        c->done = true;
+        return;
+    }
+    if (++c->yo < step_yos(&m->steps[c->step], base)) {
+        return;
+    }
+    c->yo = 0;
+    if (++c->step >= m->count) {
+        if (m->flags & MISSION_F_REPEAT) {
+            c->step = 0;
+        } else {
+            c->done = true;
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <string.h>
+
+#include "mission.h"
+#include "trim_learn.h"
+#include "app_print.h"
+
+#define MISSION_SETTINGS_KEY "mission/table"
+#define MISSION_TRIM_KEY     "mission/trim"
+
+static struct mission g_mission;
+static struct trim_learn g_trim;
+
+static int trim_settings_set(size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    struct trim_learn t;
+
+    if (len != sizeof(t)) {
+        app_printk("[MISSION] stored trim size mismatch (%zu != %zu), ignoring\r\n",
+                   len, sizeof(t));
+        return -EINVAL;
+    }
+    int rc = read_cb(cb_arg, &t, len);
+    if (rc < 0) {
+        app_printk("[MISSION] trim read_cb failed: %d\r\n", rc);
+        return rc;
+    }
+    if (t.version != TRIM_LEARN_VERSION) {
+        app_printk("[MISSION] stored trim v%u unsupported, ignoring\r\n", t.version);
+        return -EINVAL;
+    }
+    g_trim = t;
+    app_printk("[MISSION] loaded learned trim (%u cycles)\r\n", (unsigned)g_trim.cycles);
+    return 0;
+}
+
+/* settings handler: load the table from NVS into g_mission */
+static int mission_settings_set(const char *key, size_t len,
+                                settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+
+    if (settings_name_steq(key, "trim", &next) && !next) {
+        return trim_settings_set(len, read_cb, cb_arg);
+    }
+    if (!settings_name_steq(key, "table", &next) || next) {
+        return -ENOENT;
+    }
+    if (len > sizeof(g_mission)) {
+        app_printk("[MISSION] stored table too large (%zu > %zu)\r\n", len, sizeof(g_mission));
+        return -EINVAL;
+    }
+
+    struct mission m;
+    memset(&m, 0, sizeof(m));
+    int rc = read_cb(cb_arg, &m, len);
+    if (rc < 0) {
+        app_printk("[MISSION] read_cb failed: %d\r\n", rc);
+        return rc;
+    }
+    if (m.version != MISSION_VERSION || m.count == 0 || m.count > MISSION_MAX_STEPS) {
+        app_printk("[MISSION] stored table invalid (v%u, %u steps), using default\r\n",
+                   m.version, m.count);
+        return -EINVAL;
+    }
+    g_mission = m;
+    app_printk("[MISSION] loaded %u step(s) from NVM\r\n", g_mission.count);
+    return 0;
+}
+
+static int mission_export(int (*cb)(const char *name,
+                                    const void *value, size_t val_len))
+{
+    int rc = cb("table", &g_mission, sizeof(g_mission));
+    if (rc == 0) {
+        rc = cb("trim", &g_trim, sizeof(g_trim));
+    }
+    return rc;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(mission, "mission",
+                               NULL, mission_settings_set,
+                               NULL, mission_export);
+
+/* Call after app_params_init(), which brings up the settings subsystem */
+int mission_init(void)
+{
+    mission_defaults(&g_mission);
+    trim_learn_reset(&g_trim);
+
+    int rc = settings_load_subtree("mission");
+    if (rc != 0 && rc != -ENOENT) {
+        app_printk("[MISSION] load failed: %d, using default\r\n", rc);
+        mission_defaults(&g_mission);
+    }
+    return 0;
+}
+
+int mission_save(void)
+{
+    int rc = settings_save_one(MISSION_SETTINGS_KEY, &g_mission, sizeof(g_mission));
+    if (rc == 0) {
+        app_printk("[MISSION] saved to NVS\r\n");
+    } else {
+        app_printk("[MISSION] save to NVS failed: %d\r\n", rc);
+    }
+    return rc;
+}
+
+void mission_reset_defaults(void)
+{
+    mission_defaults(&g_mission);
+    app_printk("[MISSION] reset to default (not yet saved)\r\n");
+}
+
+struct mission *mission_get(void)
+{
+    return &g_mission;
+}
+
+struct trim_learn *mission_trim_get(void)
+{
+    return &g_trim;
+}
+
+int mission_trim_save(void)
+{
+    int rc = settings_save_one(MISSION_TRIM_KEY, &g_trim, sizeof(g_trim));
+    if (rc != 0) {
+        app_printk("[MISSION] trim save to NVS failed: %d\r\n", rc);
+    }
+    return rc;
+}
+
+void mission_trim_reset(void)
+{
+    trim_learn_reset(&g_trim);
+    (void)mission_trim_save();
+    app_printk("[MISSION] learned trim cleared\r\n");
+}
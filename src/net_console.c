@@ -75,9 +75,9 @@ void net_console_remove(int fd)
     k_mutex_unlock(&mtx);
 }
 
-void net_console_write(const char *buf, size_t len)
+size_t net_console_write(const char *buf, size_t len)
 {
-    if (!initialized || !buf || len == 0) return;
+    if (!initialized || !buf || len == 0) return 0;
     /* Chunk into NET_CON_MSG_SIZE blocks to fit the msgq */
     size_t off = 0;
     while (off < len) {
@@ -86,10 +86,25 @@ void net_console_write(const char *buf, size_t len)
         if (chunk > NET_CON_MSG_SIZE) chunk = NET_CON_MSG_SIZE;
         memcpy(msg.data, buf + off, chunk);
         msg.len = chunk;
-        /* Prefer delivery: wait briefly if queue is full to avoid losing lines */
-        (void)k_msgq_put(&net_con_q, &msg, K_MSEC(50));
+        /* Never wait: a stalled client must not hold up the caller */
+        if (k_msgq_put(&net_con_q, &msg, K_NO_WAIT) != 0) {
+            break;
+        }
         off += chunk;
     }
+    return off;
+}
+
+int net_console_clients(void)
+{
+    int n = 0;
+    if (!initialized) return 0;
+    k_mutex_lock(&mtx, K_FOREVER);
+    for (int i = 0; i < NET_CON_MAX; i++) {
+        if (clients[i] >= 0) n++;
+    }
+    k_mutex_unlock(&mtx);
+    return n;
 }
 
 /* Called from tcp_echo server loop when receiving bytes */
@@ -0,0 +1,160 @@
+#include <zephyr/kernel.h>
+#include <errno.h>
+
+#include "pitch_home.h"
+#include "act_sched.h"
+#include "hw_motors.h"
+#include "hw_limit_switches.h"
+#include "app_params.h"
+#include "app_print.h"
+
+/* Poll period while waiting for the back-off to end */
+#define HOME_POLL_MS 10
+/* Debounce plus margin before the back-off run has started */
+#define HOME_BACKOFF_START_MS 100
+/* Allowance over a leg's run time for waiting on the current budget */
+#define HOME_SCHED_MARGIN_MS 2000
+
+static atomic_t homing;
+
+bool pitch_home_valid(void)
+{
+    return app_params_get()->pitch_travel_s > 0.0f;
+}
+
+/* Run pitch through the scheduler for at most duration_ms and wait for
+ * it to stop; the move's result (-EIO once a limit switch cut it) */
+static int home_move(int dir, uint32_t duration_ms)
+{
+    struct k_poll_signal sig;
+    struct k_poll_event evt = K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SIGNAL,
+                                                       K_POLL_MODE_NOTIFY_ONLY, &sig);
+    struct act_move mv = {
+        .act = DIVE_ACT_PITCH,
+        .dir = dir,
+        .duration_ms = duration_ms,
+        .prio = ACT_PRIO_HIGH,
+        .signal = &sig,
+    };
+    unsigned int signaled;
+    int result;
+
+    k_poll_signal_init(&sig);
+    if (act_sched_submit(&mv) != 0) {
+        return -EINVAL;
+    }
+    if (k_poll(&evt, 1, K_MSEC(duration_ms + HOME_SCHED_MARGIN_MS)) != 0) {
+        /* Reports -ECANCELED before returning, so sig is done with */
+        act_sched_cancel(ACT_MASK(DIVE_ACT_PITCH));
+        return -ETIMEDOUT;
+    }
+    k_poll_signal_check(&sig, &signaled, &result);
+    return result;
+}
+
+/* Wait for the back-off run the limit switch work starts after a hit */
+static void home_wait_backoff(void)
+{
+    k_sleep(K_MSEC(HOME_BACKOFF_START_MS));
+    while (!act_sched_idle(ACT_MASK(DIVE_ACT_PITCH))) {
+        k_sleep(K_MSEC(HOME_POLL_MS));
+    }
+}
+
+/* One leg onto a stop, run for at most timeout_ms; returns the position
+ * at the cut */
+static int home_leg(int dir, int switch_id, uint32_t timeout_ms, int32_t *pos_ms)
+{
+    int err = 0;
+
+    if (!limit_switch_is_pressed(switch_id)) {
+        int rc = home_move(dir, timeout_ms);
+        if (rc == 0 || rc == -ETIMEDOUT) {
+            err = -ETIMEDOUT;           /* ran its full time without a stop */
+        } else if (rc != -EIO || !limit_switch_is_pressed(switch_id)) {
+            err = -EIO;
+        }
+    }
+    *pos_ms = motor_get_position_ms(MOTOR_PITCH);
+    return err;
+}
+
+static int home_run(struct app_params *p)
+{
+    uint32_t timeout_ms = (uint32_t)p->pitch_home_timeout_s * 1000U;
+    int32_t down1, up, down2;
+    int err;
+
+    app_printk("[HOME] pitch: AFT to DOWN stop\r\n");
+    err = home_leg(-1, LIMIT_PITCH_DOWN, timeout_ms, &down1);
+    if (err) {
+        return err;
+    }
+    home_wait_backoff();
+
+    app_printk("[HOME] pitch: FWD to UP stop\r\n");
+    err = home_leg(+1, LIMIT_PITCH_UP, timeout_ms, &up);
+    if (err) {
+        return err;
+    }
+    home_wait_backoff();
+
+    app_printk("[HOME] pitch: AFT to DOWN stop\r\n");
+    err = home_leg(-1, LIMIT_PITCH_DOWN, timeout_ms, &down2);
+    if (err) {
+        return err;
+    }
+
+    /* A shift, not a set: the back-off may already be running */
+    int32_t aft_stop_ms = (int32_t)(p->pitch_aft_stop_s * 1000.0f);
+    int32_t fwd_ms = up - down1;
+    int32_t aft_ms = up - down2;
+    motor_shift_position_ms(MOTOR_PITCH, aft_stop_ms - down2);
+    home_wait_backoff();
+
+    app_printk("[HOME] pitch travel FWD %.3fs AFT %.3fs (%+.1f%%), DOWN stop = %.3fs\r\n",
+               fwd_ms / 1000.0, aft_ms / 1000.0,
+               (fwd_ms > 0) ? 100.0 * (aft_ms - fwd_ms) / fwd_ms : 0.0,
+               aft_stop_ms / 1000.0);
+    if (p->pitch_travel_s > 0.0f) {
+        app_printk("[HOME] previous travel %.3fs (%+.0fms)\r\n",
+                   (double)p->pitch_travel_s, fwd_ms - (double)p->pitch_travel_s * 1000.0);
+    }
+    p->pitch_travel_s = fwd_ms / 1000.0f;
+    (void)app_params_save();
+    return 0;
+}
+
+int pitch_home(void)
+{
+    struct app_params *p = app_params_get();
+
+    atomic_set(&homing, 1);
+    int err = home_run(p);
+    atomic_clear(&homing);
+
+    if (err) {
+        app_printk("[HOME] pitch homing failed: %s\r\n",
+                   (err == -ETIMEDOUT) ? "no stop reached" : "stopped off the switch");
+    }
+    return err;
+}
+
+void pitch_home_switch_hit(int switch_id)
+{
+    const struct app_params *p = app_params_get();
+
+    if (atomic_get(&homing) || !pitch_home_valid()) {
+        return;
+    }
+    float stop_s = p->pitch_aft_stop_s;
+    if (switch_id == LIMIT_PITCH_UP) {
+        stop_s += p->pitch_travel_s;
+    }
+    int32_t stop_ms = (int32_t)(stop_s * 1000.0f);
+    int32_t drift_ms = motor_get_position_ms(MOTOR_PITCH) - stop_ms;
+
+    motor_shift_position_ms(MOTOR_PITCH, -drift_ms);
+    app_printk("[HOME] pitch re-zeroed on %s stop (%.3fs), drift %+dms\r\n",
+               (switch_id == LIMIT_PITCH_UP) ? "UP" : "DOWN", stop_ms / 1000.0, drift_ms);
+}
@@ -0,0 +1,68 @@
+/* pump_model.c - pressure-dependent pump displacement (no Zephyr dependencies) */
+#include <math.h>
+
+#include "pump_model.h"
+
+bool pump_model_enabled(const struct app_params *p)
+{
+    return p->pump_in_ml_s > 0.0f && p->pump_out_ml_s > 0.0f;
+}
+
+float pump_model_gauge_bar(float depth_m)
+{
+    if (depth_m <= 0.0f) {
+        return 0.0f;
+    }
+    return depth_m * (float)(SEA_WATER_DENSITY_KG_M3 * GRAVITY_M_S2 / 1e5);
+}
+
+float pump_model_flow_ml_s(const struct app_params *p, int dir, float gauge_bar)
+{
+    float q0 = (dir > 0) ? p->pump_out_ml_s : p->pump_in_ml_s;
+    float k = (dir > 0) ? p->pump_out_loss_ml_s_bar : p->pump_in_loss_ml_s_bar;
+    float q = q0 - k * gauge_bar;
+    float floor_q = q0 * PUMP_MODEL_MIN_FLOW_FRAC;
+
+    return (q < floor_q) ? floor_q : q;
+}
+
+float pump_model_setpoint_ml(const struct app_params *p, float setpoint_s)
+{
+    return setpoint_s * p->pump_out_ml_s;
+}
+
+void pump_volume_reset(struct pump_volume *v, const struct app_params *p, int32_t pos_ms)
+{
+    v->ml = pump_model_setpoint_ml(p, (float)pos_ms / 1000.0f);
+    v->ref_ms = pos_ms;
+}
+
+void pump_volume_track(struct pump_volume *v, const struct app_params *p, int32_t pos_ms,
+                       float gauge_bar)
+{
+    int32_t delta = pos_ms - v->ref_ms;
+    if (delta == 0) {
+        return;
+    }
+    int dir = (delta > 0) ? +1 : -1;
+    v->ml += (float)delta / 1000.0f * pump_model_flow_ml_s(p, dir, gauge_bar);
+    v->ref_ms = pos_ms;
+}
+
+bool pump_model_move_to(const struct app_params *p, const struct pump_volume *v,
+                        float target_s, float gauge_bar, struct dive_cmd *out)
+{
+    float delta_ml = pump_model_setpoint_ml(p, target_s) - v->ml;
+    if (fabsf(delta_ml) <= pump_model_setpoint_ml(p, DIVE_TRIM_TOLERANCE_S)) {
+        return false;
+    }
+    int dir = (delta_ml > 0.0f) ? +1 : -1;
+    float run_s = fabsf(delta_ml) / pump_model_flow_ml_s(p, dir, gauge_bar);
+
+    out->act = DIVE_ACT_PUMP;
+    out->reason = DIVE_CMD_TRIM;
+    out->dir = dir;
+    out->duration_ms = (uint32_t)(run_s * 1000.0f + 0.5f);
+    out->target_s = target_s;
+    return true;
+}
@@ -0,0 +1,129 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <errno.h>
+#include <stdio.h>
+
+#include "surface_ops.h"
+#include "app_print.h"
+
+#define SURF_STACK_SIZE 3072
+#define SURF_PRIO       9       /* just below the deploy worker */
+
+struct surface_job {
+    struct k_work_q q;
+    struct k_work work;
+    surface_task_fn fn;
+    void *arg;
+    bool started;
+    bool ok;
+    int64_t start_ms;
+    int64_t end_ms;
+};
+
+static K_THREAD_STACK_ARRAY_DEFINE(surf_stacks, SURF_TASK__COUNT, SURF_STACK_SIZE);
+static struct surface_job jobs[SURF_TASK__COUNT];
+static K_EVENT_DEFINE(surf_evt);
+static atomic_t surf_cancel;
+static bool surf_ready;
+static int64_t interval_ms;
+
+static const char *const task_names[SURF_TASK__COUNT] = {
+    [SURF_TASK_GPS]       = "gps",
+    [SURF_TASK_TELEMETRY] = "telemetry",
+    [SURF_TASK_SYNC]      = "sync",
+};
+
+const char *surface_task_name(enum surface_task t)
+{
+    return (t < SURF_TASK__COUNT) ? task_names[t] : "?";
+}
+
+static void surface_job_handler(struct k_work *work)
+{
+    struct surface_job *j = CONTAINER_OF(work, struct surface_job, work);
+
+    j->ok = j->fn(j->arg);
+    j->end_ms = k_uptime_get();
+    k_event_post(&surf_evt, SURF_TASK_BIT(j - jobs));
+}
+
+static void surface_ops_init(void)
+{
+    for (int i = 0; i < SURF_TASK__COUNT; i++) {
+        struct k_work_queue_config cfg = { .name = task_names[i] };
+
+        k_work_queue_start(&jobs[i].q, surf_stacks[i], K_THREAD_STACK_SIZEOF(surf_stacks[i]),
+                           SURF_PRIO, &cfg);
+        k_work_init(&jobs[i].work, surface_job_handler);
+    }
+    surf_ready = true;
+}
+
+void surface_ops_begin(void)
+{
+    if (!surf_ready) {
+        surface_ops_init();
+    }
+    for (int i = 0; i < SURF_TASK__COUNT; i++) {
+        jobs[i].started = false;
+        jobs[i].ok = false;
+    }
+    k_event_clear(&surf_evt, SURF_TASK_BIT(SURF_TASK__COUNT) - 1U);
+    atomic_clear(&surf_cancel);
+    interval_ms = k_uptime_get();
+}
+
+int surface_ops_start(enum surface_task t, surface_task_fn fn, void *arg)
+{
+    struct surface_job *j = &jobs[t];
+
+    if (k_work_busy_get(&j->work) != 0) {
+        return -EBUSY;
+    }
+    j->fn = fn;
+    j->arg = arg;
+    j->started = true;
+    j->start_ms = k_uptime_get();
+    j->end_ms = j->start_ms;
+    return (k_work_submit_to_queue(&j->q, &j->work) >= 0) ? 0 : -EIO;
+}
+
+uint32_t surface_ops_done(void)
+{
+    return k_event_test(&surf_evt, SURF_TASK_BIT(SURF_TASK__COUNT) - 1U);
+}
+
+bool surface_ops_cancelled(void)
+{
+    return atomic_get(&surf_cancel) != 0;
+}
+
+void surface_ops_finish(void)
+{
+    struct k_work_sync sync;
+
+    atomic_set(&surf_cancel, 1);
+    for (int i = 0; i < SURF_TASK__COUNT; i++) {
+        if (jobs[i].started) {
+            (void)k_work_flush(&jobs[i].work, &sync);
+        }
+    }
+}
+
+void surface_ops_report(const char *tag)
+{
+    char line[160];
+    int n = 0;
+
+    for (int i = 0; i < SURF_TASK__COUNT && n < (int)sizeof(line); i++) {
+        const struct surface_job *j = &jobs[i];
+        if (!j->started) {
+            continue;
+        }
+        n += snprintf(line + n, sizeof(line) - (size_t)n, "%s%s %ums %s",
+                      (n > 0) ? ", " : "", task_names[i],
+                      (uint32_t)(j->end_ms - j->start_ms), j->ok ? "ok" : "failed");
+    }
+    app_printk("[%s] surface interval %ums: %s\r\n", tag,
+               (uint32_t)(k_uptime_get() - interval_ms), (n > 0) ? line : "no tasks");
+}
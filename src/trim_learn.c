@@ -0,0 +1,80 @@
+/* trim_learn.c - adaptive buoyancy and pitch trim (no Zephyr dependencies) */
+#include <math.h>
+#include <string.h>
+
+#include "trim_learn.h"
+
+/* Gains: set-point seconds per unit of error */
+#define TRIM_PUMP_GAIN_S_PER_M_S   5.0f    /* 0.1 m/s slow -> 0.5 s more pump */
+#define TRIM_PITCH_GAIN_S_PER_DEG  0.1f
+#define TRIM_STEP_MAX_S            0.5f    /* per cycle */
+#define TRIM_MIN_SAMPLES           5
+
+void trim_learn_reset(struct trim_learn *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->version = TRIM_LEARN_VERSION;
+}
+
+static float clampf(float v, float lo, float hi)
+{
+    return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+/* Move *offset by gain * err (sign picks the direction), bounded per step
+ * and in total; returns true if it moved */
+static bool nudge(float *offset, float err, float gain, float sign, float max_s)
+{
+    float step = clampf(sign * gain * err, -TRIM_STEP_MAX_S, TRIM_STEP_MAX_S);
+    float next = clampf(*offset + step, -max_s, max_s);
+    if (fabsf(next - *offset) < 0.01f) {
+        return false;
+    }
+    *offset = next;
+    return true;
+}
+
+bool trim_learn_update(struct trim_learn *t, const struct dive_cycle_stats *cs,
+                       const struct app_params *p)
+{
+    float max_s = p->trim_learn_max_s;
+    bool moved = false;
+
+    if (max_s <= 0.0f) {
+        return false;
+    }
+    /* Heavier dive trim (more pump, more nose-down pitch) when too slow or
+     * too shallow going down; lighter climb trim when too slow going up */
+    if (p->target_descent_mm_s != 0 && cs->descent_m_s.n >= TRIM_MIN_SAMPLES) {
+        float err = (float)p->target_descent_mm_s / 1000.0f - cs->descent_m_s.mean;
+        moved |= nudge(&t->dive_pump_s, err, TRIM_PUMP_GAIN_S_PER_M_S, +1.0f, max_s);
+    }
+    if (p->target_ascent_mm_s != 0 && cs->ascent_m_s.n >= TRIM_MIN_SAMPLES) {
+        float err = (float)p->target_ascent_mm_s / 1000.0f - cs->ascent_m_s.mean;
+        moved |= nudge(&t->climb_pump_s, err, TRIM_PUMP_GAIN_S_PER_M_S, -1.0f, max_s);
+    }
+    if (p->target_dive_pitch_deg != 0 && cs->dive_pitch_deg.n >= TRIM_MIN_SAMPLES) {
+        float err = (float)p->target_dive_pitch_deg - cs->dive_pitch_deg.mean;
+        moved |= nudge(&t->dive_pitch_s, err, TRIM_PITCH_GAIN_S_PER_DEG, +1.0f, max_s);
+    }
+    if (p->target_climb_pitch_deg != 0 && cs->climb_pitch_deg.n >= TRIM_MIN_SAMPLES) {
+        float err = (float)p->target_climb_pitch_deg - cs->climb_pitch_deg.mean;
+        moved |= nudge(&t->climb_pitch_s, err, TRIM_PITCH_GAIN_S_PER_DEG, -1.0f, max_s);
+    }
+    if (moved) {
+        t->cycles++;
+    }
+    return moved;
+}
+
+void trim_learn_setpoints(const struct trim_learn *t, const struct app_params *p,
+                          struct dive_trim *out)
+{
+    /* The bound may have been lowered since the offsets were learned */
+    float max_s = (p->trim_learn_max_s > 0.0f) ? p->trim_learn_max_s : 0.0f;
+
+    out->dive_pitch_s = fmaxf(0.0f, (float)p->dive_pitch_s + clampf(t->dive_pitch_s, -max_s, max_s));
+    out->dive_pump_s = fmaxf(0.0f, (float)p->dive_pump_s + clampf(t->dive_pump_s, -max_s, max_s));
+    out->climb_pitch_s = fmaxf(0.0f, (float)p->climb_pitch_s + clampf(t->climb_pitch_s, -max_s, max_s));
+    out->climb_pump_s = fmaxf(0.0f, (float)p->climb_pump_s + clampf(t->climb_pump_s, -max_s, max_s));
+}
@@ -2,6 +2,7 @@
 #include <zephyr/sys/printk.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 
 #include "app_events.h"
 #include "app_limits.h"
@@ -9,21 +10,37 @@
 #include "ui_menu.h"
 #include "hw_motors.h"
 #include "hw_pump.h"
+#include "hw_ms5837.h"
+#include "pump_model.h"
+#include "actuator_wq.h"
+#include "act_sched.h"
 #include "hw_bmp180.h"
 #include "hw_gps.h"
 #include "hw_hmc6343.h"
 #include "hw_limit_switches.h"
+#include "pitch_home.h"
 #include "hw_hmc6343.h"
 #include "deploy.h"
+#include "mission.h"
+#include "trim_learn.h"
+#include "dive_stats.h"
+#include "flash_log.h"
+#include "app_logd.h"
 #include "ota_simple.h"
 
-/* MS5837 external pressure */
-void ms5837_stream_interactive(void);
 
 /* Extern from main.c */
 extern enum motor_id current_motor;
 static int current_param_index = 0;
 
+/* Last pump test run, for "ml <measured>" calibration entries */
+static struct {
+    bool valid;
+    int dir;
+    int32_t start_ms;              /* pump position when it was started */
+    float bar;                     /* MS5837 gauge pressure at the start */
+} pump_cal_run;
+
 /* POWERUP countdown */
 static int32_t remaining_sec = STARTUP_TIMEOUT_SEC;
 static int32_t tick_counter = 0;  /* Counter to track seconds for EVT_TICK */
@@ -43,13 +60,15 @@ void on_entry_MENU(void){
     app_printk("3) simulate\r\n");
     app_printk("4) deploy\r\n");
     app_printk("5) OTA firmware update\r\n");
-    app_printk("Select [1-5]: ");
+    app_printk("6) mission\r\n");
+    app_printk("7) cycle stats\r\n");
+    app_printk("Select [1-7]: ");
 }
 
 void on_entry_PARAMS_MENU(void){
     struct app_params *p = app_params_get();
     app_printk("\r\n-- PARAMETERS --\r\n");
-    app_printk("1) Dive depth [m]: %d\r\n", (int)p->dive_depth_m);
+    app_printk("1) Dive depth [m]: %.1f\r\n", p->dive_depth_m);
     app_printk("2) Wait before dive [s]: %u\r\n", p->deploy_wait_s);
     app_printk("3) Dive timeout [min]: %u\r\n", p->dive_timeout_min);
     app_printk("4) Dive pump [s]: %u\r\n", p->dive_pump_s);
@@ -63,10 +82,47 @@ void on_entry_PARAMS_MENU(void){
     app_printk("c) Max roll [s]: %u\r\n", p->max_roll_s);
     app_printk("d) Roll time [s]: %u\r\n", p->roll_time_s);
     app_printk("e) Desired heading [deg]: %d\r\n", p->desired_heading_deg);
+    app_printk("f) Heading Kp [s/deg]: %.3f\r\n", p->heading_kp);
+    app_printk("g) Heading Ki [s/deg/s]: %.4f\r\n", p->heading_ki);
+    app_printk("h) Heading period [s]: %u\r\n", p->heading_period_s);
+    app_printk("i) Roll deadband [ms]: %u\r\n", p->roll_deadband_ms);
+    app_printk("j) Inflect lead [ms] (0=off): %u\r\n", p->inflect_lead_ms);
+    app_printk("k) Yo-yo dives per surfacing: %u\r\n", p->yoyo_dives);
+    app_printk("l) Yo-yo turn depth [m]: %.1f\r\n", p->yoyo_min_depth_m);
+    app_printk("m) Trim timeout [s]: %u\r\n", p->trim_timeout_s);
+    app_printk("n) Climb timeout [min]: %u\r\n", p->climb_timeout_min);
+    app_printk("o) Surface dwell [s]: %u\r\n", p->surface_dwell_s);
+    app_printk("p) GPS timeout [s]: %u\r\n", p->gps_timeout_s);
+    app_printk("q) Comms window [s]: %u\r\n", p->comms_window_s);
+    app_printk("t) Roll current [mA]: %u\r\n", p->roll_current_ma);
+    app_printk("u) Pitch current [mA]: %u\r\n", p->pitch_current_ma);
+    app_printk("v) Pump current [mA]: %u\r\n", p->pump_current_ma);
+    app_printk("w) Supply voltage [mV]: %u\r\n", p->supply_mv);
+    app_printk("y) All parameters by name (set with name=value)\r\n");
     app_printk("s) Save parameters\r\n");
     app_printk("r) Reset defaults\r\n");
     app_printk("x) Back\r\n");
-    app_printk("Select [1-9,a-e,s,r,x]: ");
+    app_printk("Select [1-9,a-q,t-w,y,s,r,x] or name=value: ");
+}
+
+void on_entry_MISSION_MENU(void){
+    struct mission *m = mission_get();
+    char buf[64];
+    app_printk("\r\n-- MISSION (%u/%u steps, %s) --\r\n", m->count, MISSION_MAX_STEPS,
+               (m->flags & MISSION_F_REPEAT) ? "repeat" : "once");
+    app_printk("#  depth dpitch dpump cpitch cpump heading yos surface [turn]\r\n");
+    for (uint8_t i = 0; i < m->count; i++) {
+        mission_format_step(&m->steps[i], buf, sizeof(buf));
+        app_printk("%u) %s\r\n", i + 1, buf);
+    }
+    app_printk("('-' = use parameter; surface: prompt|gps|skip; turn: yo-yo depth)\r\n");
+    const struct trim_learn *t = mission_trim_get();
+    app_printk("learned trim (%u cycles): dive pitch %+.1fs pump %+.1fs, climb pitch %+.1fs pump %+.1fs\r\n",
+               (unsigned)t->cycles, (double)t->dive_pitch_s, (double)t->dive_pump_s,
+               (double)t->climb_pitch_s, (double)t->climb_pump_s);
+    app_printk("add <step> | set <n> <step> | del <n> | repeat on|off | trim reset\r\n");
+    app_printk("s) Save  r) Reset default  x) Back\r\n");
+    app_printk("> ");
 }
 
 void on_entry_HWTEST_MENU(void){
@@ -78,8 +134,11 @@ void on_entry_HWTEST_MENU(void){
     app_printk("5) External Pressure\r\n");
     app_printk("6) GPS\r\n");
     app_printk("7) Compass\r\n");
+    app_printk("8) actuator timing and scheduling\r\n");
+    app_printk("9) flash log ('9e' erases it)\r\n");
+    app_printk("l) console output sinks\r\n");
     app_printk("x) back\r\n");
-    app_printk("Select [1-7,x]: ");
+    app_printk("Select [1-9,l,x]: ");
 }
 
 
@@ -106,8 +165,9 @@ void on_entry_PR_MENU(void){
     app_printk("1) roll\r\n");
     app_printk("2) pitch\r\n");
     app_printk("3) pitch limit switches (test)\r\n");
+    app_printk("4) home pitch (calibrate travel)\r\n");
     app_printk("x) back\r\n");
-    app_printk("Select [1-3,x]: ");
+    app_printk("Select [1-4,x]: ");
 }
 
 void on_entry_RECOVERY(void){
@@ -116,12 +176,16 @@ void on_entry_RECOVERY(void){
 }
 void on_entry_DEPLOYED(void){
     app_printk("\r\n== DEPLOYED state ==\r\n");
+    app_printk("Type 'abort' for an emergency ascent; name=value or 'mission set <n> <step>'\r\n");
+    app_printk("is applied at the next surfacing.\r\n");
     /* Run deploy asynchronously to keep UI and networking responsive */
     deploy_start_async();
 }
 
 void on_entry_SIMULATE(void){
     app_printk("\r\n== SIMULATE state (lab testing with simulated pressure) ==\r\n");
+    app_printk("Type 'abort' for an emergency ascent; name=value or 'mission set <n> <step>'\r\n");
+    app_printk("is applied at the next surfacing.\r\n");
     /* Run simulate asynchronously to keep UI and networking responsive */
     simulate_start_async();
 }
@@ -160,6 +224,7 @@ state_id_t on_event_LIMIT_TEST(const event_t *e){ return ST_LIMIT_TEST; }
 state_id_t on_event_RECOVERY(const event_t *e){ return ST_RECOVERY; }
 state_id_t on_event_COMPASS_MENU(const event_t *e){ return ST_COMPASS_MENU; }
 state_id_t on_event_OTA_MENU(const event_t *e){ return ST_OTA_MENU; }
+state_id_t on_event_MISSION_MENU(const event_t *e){ return ST_MISSION_MENU; }
 state_id_t on_event_DEPLOYED(const event_t *e){
     /* Check if deploy has completed (thread no longer running) */
     if (!deploy_is_running()) {
@@ -175,6 +240,57 @@ state_id_t on_event_SIMULATE(const event_t *e){
     return ST_SIMULATE;
 }
 
+/* --- Pump calibration --- */
+
+/* Note where a test run starts and at what pressure (gauge against a
+ * standard atmosphere; a pressure pot gives the points at depth) */
+static void pump_cal_start(int dir)
+{
+    double temp_c = 0.0, press_kpa = 0.0;
+
+    pump_cal_run.valid = true;
+    pump_cal_run.dir = dir;
+    pump_cal_run.start_ms = pump_get_position_ms();
+    pump_cal_run.bar = 0.0f;
+    if (ms5837_read(&temp_c, &press_kpa) == 0) {
+        pump_cal_run.bar = (float)((press_kpa - 101.325) / 100.0);
+    }
+}
+
+/* One calibration point: the volume measured for the last run. The
+ * [PUMPCAL] lines are what tools/pump_cal fits. */
+static void pump_cal_entry(const char *arg)
+{
+    char *endp = NULL;
+    double ml = strtod(arg, &endp);
+
+    if (endp == arg || *endp != '\0' || ml <= 0.0) {
+        app_printk("Usage: ml <measured volume>\r\n");
+        return;
+    }
+    if (!pump_cal_run.valid || pump_is_running()) {
+        app_printk("Run the pump first and let it stop\r\n");
+        return;
+    }
+    int32_t ran = pump_get_position_ms() - pump_cal_run.start_ms;
+    uint32_t ran_ms = (uint32_t)((ran < 0) ? -ran : ran);
+    if (ran_ms == 0) {
+        app_printk("No pump travel recorded\r\n");
+        return;
+    }
+    pump_cal_run.valid = false;
+
+    struct app_params *p = app_params_get();
+    double flow = ml * 1000.0 / (double)ran_ms;
+    app_printk("[PUMPCAL] dir=%+d ms=%u bar=%.3f ml=%.1f flow=%.3f",
+               pump_cal_run.dir, ran_ms, (double)pump_cal_run.bar, ml, flow);
+    if (pump_model_enabled(p)) {
+        app_printk(" model=%.3f",
+                   (double)pump_model_flow_ml_s(p, pump_cal_run.dir, pump_cal_run.bar));
+    }
+    app_printk("\r\n");
+}
+
 /* --- Line handler --- */
 state_id_t ui_handle_line(state_id_t state, const char *line){
     /* Ignore empty lines */
@@ -189,6 +305,20 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
     if (state == ST_SIMULATE && !simulate_is_running()) {
         return ST_MENU;
     }
+    if ((state == ST_DEPLOYED || state == ST_SIMULATE) && strcmp(line, "abort") == 0) {
+        deploy_abort("operator");
+        return ST__COUNT;
+    }
+    if ((state == ST_DEPLOYED || state == ST_SIMULATE) &&
+        (strchr(line, '=') || strncmp(line, "mission set ", 12) == 0)) {
+        int rc = deploy_queue_update(line);
+        if (rc == 0) {
+            app_printk("Queued for the next surfacing: %s\r\n", line);
+        } else {
+            app_printk("Not queued (%s): %s\r\n", rc == -ENOSPC ? "queue full" : "too long", line);
+        }
+        return ST__COUNT;
+    }
     
     if (state==ST_MENU){
         if(line[0]=='1') return ST_PARAMS_MENU;
@@ -205,6 +335,8 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
             return ST_DEPLOYED;
         }
         if(line[0]=='5') return ST_OTA_MENU;
+        if(line[0]=='6') return ST_MISSION_MENU;
+        if(line[0]=='7') { dive_stats_print(); on_entry_MENU(); return ST_MENU; }
         /* Invalid input - stay in same state, print error, no state entry call */
         app_printk("Invalid.\r\n");
         return ST_MENU;
@@ -212,12 +344,15 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
     }
     if (state==ST_HWTEST_MENU){
         if(line[0]=='1') return ST_PR_MENU;
-        if(line[0]=='2') { app_printk("[PUMP] Enter seconds [-10,10], q to quit\r\n> "); return ST_PUMP_INPUT; }
+        if(line[0]=='2') {
+            app_printk("[PUMP] Enter seconds [-10,10], 'ml <measured>' after a run, q to quit\r\n> ");
+            return ST_PUMP_INPUT;
+        }
         if(line[0]=='3') {
-            long roll  = (long)motor_get_position_sec(MOTOR_ROLL);
-            long pitch = (long)motor_get_position_sec(MOTOR_PITCH);
-            long pump  = (long)pump_get_position_sec();
-            app_printk("\r\n[POSITION] roll=%lds, pitch=%lds, pump=%lds\r\n",
+            double roll  = motor_get_position_ms(MOTOR_ROLL) / 1000.0;
+            double pitch = motor_get_position_ms(MOTOR_PITCH) / 1000.0;
+            double pump  = pump_get_position_ms() / 1000.0;
+            app_printk("\r\n[POSITION] roll=%.3fs, pitch=%.3fs, pump=%.3fs\r\n",
                        roll, pitch, pump);
             on_entry_HWTEST_MENU();
             return ST_HWTEST_MENU;
@@ -236,6 +371,30 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
         }
         if(line[0]=='6') { gps_fix_interactive(); on_entry_HWTEST_MENU(); return ST_HWTEST_MENU; }
         if(line[0]=='7') { return ST_COMPASS_MENU; }
+        if(line[0]=='8') {
+            actuator_wq_print_timing();
+            act_sched_print_stats();
+            if (line[1] == 'r' || line[1] == 'R') {
+                actuator_wq_reset_timing();
+                app_printk("[ACT] timing reset\r\n");
+            }
+            on_entry_HWTEST_MENU();
+            return ST_HWTEST_MENU;
+        }
+        if(line[0]=='9') {
+            if (line[1] == 'e' || line[1] == 'E') {
+                (void)flash_log_erase();
+            }
+            flash_log_print();
+            on_entry_HWTEST_MENU();
+            return ST_HWTEST_MENU;
+        }
+        if(line[0]=='l' || line[0]=='L') {
+            app_print_stats();
+            app_logd_print_stats();
+            on_entry_HWTEST_MENU();
+            return ST_HWTEST_MENU;
+        }
         if(line[0]=='x' || line[0]=='X') { return ST_MENU; }
         app_printk("Invalid.\r\n");
         return ST_HWTEST_MENU;
@@ -245,6 +404,7 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
         if(line[0]=='1'){ current_motor=MOTOR_ROLL;  app_printk("[ROLL] Enter seconds [-10,10], q to quit\r\n> ");  return ST_PR_INPUT; }
         if(line[0]=='2'){ current_motor=MOTOR_PITCH; app_printk("[PITCH] Enter seconds [-10,10], q to quit\r\n> "); return ST_PR_INPUT; }
         if(line[0]=='3'){ limit_switches_test_interactive(); on_entry_PR_MENU(); return ST_PR_MENU; }
+        if(line[0]=='4'){ (void)pitch_home(); on_entry_PR_MENU(); return ST_PR_MENU; }
         if(line[0]=='x' || line[0]=='X'){ return ST_HWTEST_MENU; }
         app_printk("Invalid.\r\n");
         return ST_PR_MENU;
@@ -256,16 +416,18 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
         if(endp==line||*endp!='\0'){ app_printk("Not a valid integer: '%s'\r\n> ", line); return ST_PR_INPUT; }
         if(val<TEST_MIN_SEC||val>TEST_MAX_SEC){ app_printk("Range -10..10 only\r\n> ");     return ST_PR_INPUT; }
         int dir=(val>=0)?+1:-1; uint32_t dur=(val>=0)?(uint32_t)val:(uint32_t)(-val);
-        motor_run(current_motor,dir,dur); app_printk("> "); return ST_PR_INPUT;
+        motor_cmd_ms(current_motor,dir,dur*1000U); app_printk("> "); return ST_PR_INPUT;
     }
 
     if (state==ST_PUMP_INPUT){
         if((line[0]=='q'||line[0]=='Q') && line[1]=='\0'){ return ST_HWTEST_MENU; }
+        if(strncmp(line,"ml ",3)==0){ pump_cal_entry(line+3); app_printk("> "); return ST_PUMP_INPUT; }
         char *endp=NULL; long val=strtol(line,&endp,10);
         if(endp==line||*endp!='\0'){ app_printk("Not a valid integer: '%s'\r\n> ", line); return ST_PUMP_INPUT; }
         if(val<TEST_MIN_SEC||val>TEST_MAX_SEC){ app_printk("Range -10..10 only\r\n> ");     return ST_PUMP_INPUT; }
         int dir=(val>=0)?+1:-1; uint32_t dur=(val>=0)?(uint32_t)val:(uint32_t)(-val);
-        pump_run(dir,dur); app_printk("> "); return ST_PUMP_INPUT;
+        pump_cal_start(dir);
+        pump_cmd_ms(dir,dur*1000U); app_printk("> "); return ST_PUMP_INPUT;
     }
 
     if (state==ST_LIMIT_TEST){
@@ -318,8 +480,65 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
         return ST_OTA_MENU;
     }
 
+    if (state==ST_MISSION_MENU){
+        struct mission *m = mission_get();
+        struct mission_step step;
+        char *endp = NULL;
+        if((line[0]=='x' || line[0]=='X') && line[1]=='\0'){ return ST_MENU; }
+        if((line[0]=='s' || line[0]=='S') && line[1]=='\0'){ mission_save(); on_entry_MISSION_MENU(); return ST_MISSION_MENU; }
+        if((line[0]=='r' || line[0]=='R') && line[1]=='\0'){ mission_reset_defaults(); on_entry_MISSION_MENU(); return ST_MISSION_MENU; }
+        if(strncmp(line,"add ",4)==0){
+            if(m->count >= MISSION_MAX_STEPS){ app_printk("Table full.\r\n> "); return ST_MISSION_MENU; }
+            if(mission_parse_step(line+4,&step)!=0){ app_printk("Bad step: '%s'\r\n> ", line+4); return ST_MISSION_MENU; }
+            m->steps[m->count++] = step;
+            on_entry_MISSION_MENU();
+            return ST_MISSION_MENU;
+        }
+        if(strncmp(line,"set ",4)==0){
+            long n = strtol(line+4,&endp,10);
+            if(endp==line+4 || n<1 || n>m->count){ app_printk("No such step.\r\n> "); return ST_MISSION_MENU; }
+            if(mission_parse_step(endp,&step)!=0){ app_printk("Bad step: '%s'\r\n> ", endp); return ST_MISSION_MENU; }
+            m->steps[n-1] = step;
+            on_entry_MISSION_MENU();
+            return ST_MISSION_MENU;
+        }
+        if(strncmp(line,"del ",4)==0){
+            long n = strtol(line+4,&endp,10);
+            if(endp==line+4 || *endp!='\0' || n<1 || n>m->count){ app_printk("No such step.\r\n> "); return ST_MISSION_MENU; }
+            if(m->count == 1){ app_printk("Mission needs at least one step.\r\n> "); return ST_MISSION_MENU; }
+            memmove(&m->steps[n-1], &m->steps[n], (size_t)(m->count - n) * sizeof(m->steps[0]));
+            m->count--;
+            on_entry_MISSION_MENU();
+            return ST_MISSION_MENU;
+        }
+        if(strcmp(line,"repeat on")==0){ m->flags |= MISSION_F_REPEAT; on_entry_MISSION_MENU(); return ST_MISSION_MENU; }
+        if(strcmp(line,"repeat off")==0){ m->flags &= (uint8_t)~MISSION_F_REPEAT; on_entry_MISSION_MENU(); return ST_MISSION_MENU; }
+        if(strcmp(line,"trim reset")==0){ mission_trim_reset(); on_entry_MISSION_MENU(); return ST_MISSION_MENU; }
+        app_printk("Invalid.\r\n> ");
+        return ST_MISSION_MENU;
+    }
+
     if (state==ST_PARAMS_MENU){
         /* navigation */
+        const char *eq = strchr(line, '=');
+        if (eq) {
+            int rc = app_params_set_named(app_params_get(), line, (size_t)(eq - line), eq + 1);
+            if (rc == 0) {
+                app_printk("Value updated (not yet saved).\r\n");
+            } else {
+                app_printk(rc == -ENOENT ? "Unknown parameter.\r\n" : "Bad value.\r\n");
+            }
+            on_entry_PARAMS_MENU();
+            return ST_PARAMS_MENU;
+        }
+        if(line[0]=='y' || line[0]=='Y'){
+            char buf[64];
+            for (unsigned int i = 0; app_params_format_named(app_params_get(), i, buf, sizeof(buf)) >= 0; i++) {
+                app_printk("  %s\r\n", buf);
+            }
+            app_printk("Select [1-9,a-q,t-w,y,s,r,x] or name=value: ");
+            return ST_PARAMS_MENU;
+        }
         if(line[0]=='x' || line[0]=='X'){ return ST_MENU; }
         if(line[0]=='s' || line[0]=='S'){ app_params_save(); on_entry_PARAMS_MENU(); return ST_PARAMS_MENU; }
         if(line[0]=='r' || line[0]=='R'){ app_params_reset_defaults(); on_entry_PARAMS_MENU(); return ST_PARAMS_MENU; }
@@ -338,6 +557,22 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
         if(line[0]=='c' || line[0]=='C'){ current_param_index = 12; app_printk("Enter Max roll [s]: "); return ST_PARAM_INPUT; }
         if(line[0]=='d' || line[0]=='D'){ current_param_index = 13; app_printk("Enter Roll time [s]: "); return ST_PARAM_INPUT; }
         if(line[0]=='e' || line[0]=='E'){ current_param_index = 14; app_printk("Enter Desired heading [deg]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='f' || line[0]=='F'){ current_param_index = 15; app_printk("Enter Heading Kp [s/deg]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='g' || line[0]=='G'){ current_param_index = 16; app_printk("Enter Heading Ki [s/deg/s]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='h' || line[0]=='H'){ current_param_index = 17; app_printk("Enter Heading period [s]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='i' || line[0]=='I'){ current_param_index = 18; app_printk("Enter Roll deadband [ms]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='j' || line[0]=='J'){ current_param_index = 19; app_printk("Enter Inflect lead [ms] (0=off): "); return ST_PARAM_INPUT; }
+        if(line[0]=='k' || line[0]=='K'){ current_param_index = 20; app_printk("Enter Yo-yo dives per surfacing: "); return ST_PARAM_INPUT; }
+        if(line[0]=='l' || line[0]=='L'){ current_param_index = 21; app_printk("Enter Yo-yo turn depth [m]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='m' || line[0]=='M'){ current_param_index = 22; app_printk("Enter Trim timeout [s]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='n' || line[0]=='N'){ current_param_index = 23; app_printk("Enter Climb timeout [min]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='o' || line[0]=='O'){ current_param_index = 24; app_printk("Enter Surface dwell [s]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='p' || line[0]=='P'){ current_param_index = 25; app_printk("Enter GPS timeout [s]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='q' || line[0]=='Q'){ current_param_index = 26; app_printk("Enter Comms window [s]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='t' || line[0]=='T'){ current_param_index = 27; app_printk("Enter Roll current [mA]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='u' || line[0]=='U'){ current_param_index = 28; app_printk("Enter Pitch current [mA]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='v' || line[0]=='V'){ current_param_index = 29; app_printk("Enter Pump current [mA]: "); return ST_PARAM_INPUT; }
+        if(line[0]=='w' || line[0]=='W'){ current_param_index = 30; app_printk("Enter Supply voltage [mV]: "); return ST_PARAM_INPUT; }
         app_printk("Invalid.\r\n");
         return ST_PARAMS_MENU;
     }
@@ -345,10 +580,19 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
     if (state==ST_PARAM_INPUT){
         struct app_params *p = app_params_get();
         char *endp = NULL;
-        long val = strtol(line,&endp,10);
-        if(endp==line||*endp!='\0'){ app_printk("Not a valid integer: '%s'\r\n", line); return ST_PARAMS_MENU; }
+        bool is_float = (current_param_index == 1 || current_param_index == 15 ||
+                         current_param_index == 16 || current_param_index == 21);
+        long val = 0;
+        float fval = 0.0f;
+        if (is_float) {
+            fval = strtof(line,&endp);
+            if(endp==line||*endp!='\0'){ app_printk("Not a valid number: '%s'\r\n", line); return ST_PARAMS_MENU; }
+        } else {
+            val = strtol(line,&endp,10);
+            if(endp==line||*endp!='\0'){ app_printk("Not a valid integer: '%s'\r\n", line); return ST_PARAMS_MENU; }
+        }
     switch(current_param_index){
-    case 1:  p->dive_depth_m = (float)val; break;
+    case 1:  p->dive_depth_m = fval; break;
     case 2:  p->deploy_wait_s = (uint16_t)val; break;
     case 3:  p->dive_timeout_min = (uint16_t)val; break;
     case 4:  p->dive_pump_s = (uint16_t)val; break;
@@ -362,6 +606,22 @@ state_id_t ui_handle_line(state_id_t state, const char *line){
     case 12: p->max_roll_s = (uint16_t)val; break;
     case 13: p->roll_time_s = (uint16_t)val; break;
     case 14: p->desired_heading_deg = (int16_t)val; break;
+    case 15: p->heading_kp = fval; break;
+    case 16: p->heading_ki = fval; break;
+    case 17: p->heading_period_s = (uint16_t)val; break;
+    case 18: p->roll_deadband_ms = (uint16_t)val; break;
+    case 19: p->inflect_lead_ms = (uint16_t)val; break;
+    case 20: p->yoyo_dives = (uint16_t)(val < 1 ? 1 : val); break;
+    case 21: p->yoyo_min_depth_m = fval; break;
+    case 22: p->trim_timeout_s = (uint16_t)val; break;
+    case 23: p->climb_timeout_min = (uint16_t)val; break;
+    case 24: p->surface_dwell_s = (uint16_t)val; break;
+    case 25: p->gps_timeout_s = (uint16_t)val; break;
+    case 26: p->comms_window_s = (uint16_t)val; break;
+    case 27: p->roll_current_ma = (uint16_t)val; break;
+    case 28: p->pitch_current_ma = (uint16_t)val; break;
+    case 29: p->pump_current_ma = (uint16_t)val; break;
+    case 30: p->supply_mv = (uint16_t)val; break;
     default: break;
     }
         app_printk("Value updated (not yet saved).\r\n");
@@ -0,0 +1,206 @@
+/* codec_bench.c - flash log compression benchmark
+ *
+ * Encodes a sample stream with the firmware's log codec (src/log_codec.c),
+ * decodes it again and checks every sample survives, then reports the
+ * compression against raw 32-byte records and the encode/decode time per
+ * sample on this machine:
+ *
+ *   ./codec_bench                  synthetic 1 Hz dives with sensor noise
+ *   ./codec_bench -r 4 -n 20000    4 Hz, 20000 samples
+ *   ./codec_bench dive.log         the [SENS] lines of a console log
+ *
+ * Positions and state are held constant for long stretches, as on a real
+ * dive; only the synthetic stream moves them.
+ */
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime under -std=c11 */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log_rec.h"
+#include "log_codec.h"
+
+static uint32_t rng = 12345;
+
+/* Uniform in [-1, 1) */
+static float noise(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return (float)(rng >> 8) / (float)(1u << 23) - 1.0f;
+}
+
+/* Yo-yo between the surface and 30 m at 0.15 m/s, one dive every ~7 min */
+static void synth(struct log_rec *recs, int n, float rate_hz)
+{
+    float heading = 90.0f;
+    int32_t pos_ms[DIVE_ACT__COUNT] = { 0, 0, 0 };
+
+    for (int i = 0; i < n; i++) {
+        float t = (float)i / rate_hz;
+        float ph = fmodf(t, 420.0f);
+        bool down = ph < 200.0f;
+        float depth = down ? ph * 0.15f : fmaxf(0.0f, 30.0f - (ph - 200.0f) * 0.15f);
+        enum dive_state st = down ? DIVE_ST_DESCEND : (depth > 0.0f ? DIVE_ST_ASCEND : DIVE_ST_COMMS);
+
+        heading += 0.02f * noise();
+        pos_ms[DIVE_ACT_PITCH] = down ? 8000 : 2000;
+        pos_ms[DIVE_ACT_PUMP] = down ? 3000 : 0;
+        pos_ms[DIVE_ACT_ROLL] = 5000 + 500 * (int)(fmodf(t, 60.0f) / 20.0f);
+
+        struct dive_sample s = {
+            .t_ms = (int64_t)(t * 1000.0f) + (int64_t)(3.0f * noise()),
+            .internal_pa = 101000 + (int32_t)(20.0f * noise()),
+            .depth_m = depth + 0.005f * noise(),
+            .temp_c = 18.0f - depth * 0.2f + 0.01f * noise(),
+            .heading_deg = heading + 0.5f * noise(),
+            .pitch_deg = (down ? -20.0f : 20.0f) + 0.3f * noise(),
+            .roll_deg = 0.5f * noise(),
+        };
+        log_rec_pack(&recs[i], &s, st, pos_ms);
+    }
+}
+
+/* [SENS] lines of a console log; returns the sample count */
+static int load_log(const char *path, struct log_rec *recs, int max)
+{
+    FILE *f = fopen(path, "r");
+    char line[512];
+    int n = 0;
+    int32_t pos_ms[DIVE_ACT__COUNT] = { 0, 0, 0 };
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while (n < max && fgets(line, sizeof(line), f)) {
+        const char *m = strstr(line, "[SENS] ");
+        const char *d = m ? strstr(m, "Depth=") : NULL;
+        struct dive_sample s = {0};
+        unsigned t;
+        int pa;
+
+        if (!d || sscanf(m, "[SENS] t=%u IntP=%d", &t, &pa) != 2 ||
+            sscanf(d, "Depth=%fm, H=%f,R=%f,P=%f", &s.depth_m, &s.heading_deg,
+                   &s.roll_deg, &s.pitch_deg) != 4) {
+            continue;
+        }
+        s.t_ms = t;
+        s.internal_pa = pa;
+        log_rec_pack(&recs[n++], &s, DIVE_ST_DESCEND, pos_ms);
+    }
+    fclose(f);
+    return n;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    int n = 10000;
+    float rate_hz = 1.0f;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rate_hz = strtof(argv[++i], NULL);
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: codec_bench [-n samples] [-r rate_hz] [console.log]\n");
+            return 2;
+        }
+    }
+    if (n <= 0 || rate_hz <= 0.0f) {
+        fprintf(stderr, "codec_bench: bad -n or -r\n");
+        return 2;
+    }
+
+    struct log_rec *recs = calloc((size_t)n, sizeof(*recs));
+    struct log_block *blocks = calloc((size_t)n, sizeof(*blocks));   /* worst case: 1 per sample */
+    if (!recs || !blocks) {
+        fprintf(stderr, "codec_bench: out of memory\n");
+        return 1;
+    }
+    if (path) {
+        n = load_log(path, recs, n);
+        if (n <= 0) {
+            fprintf(stderr, "codec_bench: no [SENS] samples\n");
+            return 1;
+        }
+    } else {
+        synth(recs, n, rate_hz);
+    }
+
+    /* Encode, as the flash writer does */
+    static struct log_enc enc;
+    int nblk = 0;
+    uint32_t payload = 0;
+    double t0 = now_s();
+    log_enc_begin(&enc, 0);
+    for (int i = 0; i < n; i++) {
+        if (!log_enc_add(&enc, &recs[i])) {
+            log_enc_seal(&enc, (uint32_t)nblk);
+            payload += enc.blk.h.len;
+            blocks[nblk++] = enc.blk;
+            log_enc_begin(&enc, (uint32_t)i);
+            (void)log_enc_add(&enc, &recs[i]);
+        }
+    }
+    log_enc_seal(&enc, (uint32_t)nblk);
+    payload += enc.blk.h.len;
+    blocks[nblk++] = enc.blk;
+    double t_enc = now_s() - t0;
+
+    /* Decode and compare */
+    int got = 0, bad = 0;
+    t0 = now_s();
+    for (int b = 0; b < nblk; b++) {
+        struct log_dec d;
+        struct log_rec r;
+        if (!log_block_valid(&blocks[b])) {
+            bad++;
+            continue;
+        }
+        log_dec_begin(&d, &blocks[b]);
+        while (log_dec_next(&d, &r)) {
+            struct log_rec want = recs[got];
+            log_rec_seal(&want, (uint32_t)got);
+            if (got >= n || memcmp(&r, &want, sizeof(r)) != 0) {
+                bad++;
+            }
+            got++;
+        }
+    }
+    double t_dec = now_s() - t0;
+
+    double raw = (double)n * LOG_REC_SIZE;
+    double flash = (double)nblk * LOG_BLOCK_SIZE;
+    printf("%d samples%s%.1f Hz, %d blocks\n", n, path ? " from log, " : " synthetic, ",
+           (double)rate_hz, nblk);
+    printf("raw       %8.0f bytes  %5.2f bytes/sample\n", raw, raw / n);
+    printf("payload   %8u bytes  %5.2f bytes/sample  %4.2fx\n", payload,
+           (double)payload / n, raw / payload);
+    printf("on flash  %8.0f bytes  %5.2f bytes/sample  %4.2fx (block headers, padding)\n",
+           flash, flash / n, raw / flash);
+    printf("encode %.0f ns/sample, decode %.0f ns/sample\n", t_enc * 1e9 / n, t_dec * 1e9 / n);
+    if (got != n || bad != 0) {
+        printf("ROUND TRIP FAILED: %d of %d samples decoded, %d mismatches\n", got, n, bad);
+        return 1;
+    }
+    printf("round trip OK\n");
+    free(recs);
+    free(blocks);
+    return 0;
+}
@@ -0,0 +1,226 @@
+/* heading_bench.c - closed-loop heading controller benchmark
+ *
+ * Simulates the roll actuator and a simple turn-rate model of the glider,
+ * then runs dive/climb cycles under two controllers:
+ *
+ *   bang-bang  the pre-PI update_roll_for_heading() (kept here as reference):
+ *              every 10 samples, +/-5 deg tolerance, roll to +/-max_roll_s
+ *              in whole seconds
+ *   PI         dive_ctrl_heading() with the current app_params
+ *
+ * and reports heading RMS error, roll-motor on-time, starts and reversals
+ * per cycle. Both see the same disturbance and compass noise sequence.
+ *
+ *   ./heading_bench [-n cycles] [-g turn_gain] [-s name=value]...
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_params.h"
+#include "dive_ctrl.h"
+#include "param_args.h"
+
+#define SIM_DT_MS        100    /* plant integration step */
+#define SAMPLE_MS        1000   /* control loop period (deploy samples at 1 Hz) */
+#define PHASE_MS         120000 /* descent and climb length per cycle */
+
+/* Legacy bang-bang constants */
+#define BB_CHECK_INTERVAL   10
+#define BB_TOLERANCE_DEG    5.0f
+
+struct plant {
+    float heading_deg;
+    float roll_pos_s;        /* actuator position, seconds from zero */
+    int roll_dir;            /* current motion, 0 when stopped */
+    int32_t roll_left_ms;    /* remaining run time */
+    int last_dir;            /* direction of the previous command */
+    float drift_deg_s;       /* current/asymmetry induced turn rate */
+    uint32_t rng;
+};
+
+struct result {
+    double err_sq_sum;
+    uint32_t err_n;
+    uint32_t on_ms;
+    uint32_t starts;
+    uint32_t reversals;
+};
+
+static float turn_gain = 2.0f;   /* deg/s of turn per second of roll travel */
+
+/* xorshift32: deterministic across runs and platforms */
+static float rng_uniform(uint32_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return (float)(*s & 0xFFFFFF) / (float)0x1000000;
+}
+
+static float rng_noise(uint32_t *s, float sigma)
+{
+    /* Sum of uniforms: close enough to Gaussian for a benchmark */
+    float acc = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        acc += rng_uniform(s) - 0.5f;
+    }
+    return acc * sigma * 1.732f;
+}
+
+static void plant_cmd(struct plant *pl, struct result *res, const struct dive_cmd *cmd)
+{
+    if (pl->last_dir != 0 && pl->last_dir != cmd->dir) {
+        res->reversals++;
+    }
+    pl->last_dir = cmd->dir;
+    pl->roll_dir = cmd->dir;
+    pl->roll_left_ms = (int32_t)cmd->duration_ms;
+    res->starts++;
+}
+
+static void plant_step(struct plant *pl, struct result *res, bool dive_phase,
+                       const struct app_params *p)
+{
+    if (pl->roll_left_ms > 0) {
+        int32_t step = (pl->roll_left_ms < SIM_DT_MS) ? pl->roll_left_ms : SIM_DT_MS;
+        pl->roll_pos_s += (float)(pl->roll_dir * step) / 1000.0f;
+        pl->roll_left_ms -= step;
+        res->on_ms += (uint32_t)step;
+        if (pl->roll_left_ms == 0) {
+            pl->roll_dir = 0;
+        }
+    }
+
+    /* Negative roll turns starboard while diving, positive while climbing */
+    float roll = pl->roll_pos_s - (float)p->start_roll_s;
+    float rate = turn_gain * (dive_phase ? -roll : roll) + pl->drift_deg_s;
+    pl->heading_deg += rate * (float)SIM_DT_MS / 1000.0f;
+    while (pl->heading_deg >= 360.0f) pl->heading_deg -= 360.0f;
+    while (pl->heading_deg < 0.0f) pl->heading_deg += 360.0f;
+}
+
+/* Pre-PI controller, verbatim behaviour */
+static bool bangbang(int *counter, bool dive_phase, float heading, float roll_pos_s,
+                     const struct app_params *p, struct dive_cmd *out)
+{
+    if (++*counter < BB_CHECK_INTERVAL) {
+        return false;
+    }
+    *counter = 0;
+
+    float err = dive_heading_delta(heading, (float)p->desired_heading_deg);
+    float target;
+    if (err > BB_TOLERANCE_DEG) {
+        target = dive_phase ? -(float)p->max_roll_s : (float)p->max_roll_s;
+    } else if (err < -BB_TOLERANCE_DEG) {
+        target = dive_phase ? (float)p->max_roll_s : -(float)p->max_roll_s;
+    } else {
+        target = (float)p->start_roll_s;
+    }
+    float delta = target - roll_pos_s;
+    if (fabsf(delta) <= 0.5f) {
+        return false;
+    }
+    out->act = DIVE_ACT_ROLL;
+    out->dir = (delta > 0) ? +1 : -1;
+    out->duration_ms = (uint32_t)(fabsf(delta) + 0.5f) * 1000U;
+    out->target_s = target;
+    return true;
+}
+
+static void run(bool use_pi, int cycles, const struct app_params *p, struct result *res)
+{
+    struct plant pl;
+    memset(&pl, 0, sizeof(pl));
+    memset(res, 0, sizeof(*res));
+    pl.rng = 0x5EED1234u;
+    pl.roll_pos_s = (float)p->start_roll_s;
+
+    int64_t t_ms = 0;
+    for (int c = 0; c < cycles; c++) {
+        /* Each cycle starts off-course with a new cross-current */
+        pl.heading_deg = (float)p->desired_heading_deg + 60.0f * (rng_uniform(&pl.rng) - 0.5f);
+        pl.drift_deg_s = 1.0f * (rng_uniform(&pl.rng) - 0.5f);
+
+        for (int phase = 0; phase < 2; phase++) {
+            bool dive_phase = (phase == 0);
+            struct dive_ctrl ctrl;
+            int bb_counter = 0;
+            dive_ctrl_begin_phase(&ctrl, dive_phase, t_ms);
+
+            for (int64_t pt = 0; pt < PHASE_MS; pt += SIM_DT_MS, t_ms += SIM_DT_MS) {
+                if (pt % SAMPLE_MS == 0) {
+                    struct dive_sample s = {
+                        .t_ms = t_ms,
+                        .heading_deg = pl.heading_deg + rng_noise(&pl.rng, 1.0f),
+                    };
+                    struct dive_cmd cmd;
+                    bool move = use_pi
+                        ? dive_ctrl_heading(&ctrl, &s, pl.roll_pos_s, p, &cmd)
+                        : bangbang(&bb_counter, dive_phase, s.heading_deg, pl.roll_pos_s, p, &cmd);
+                    if (move) {
+                        plant_cmd(&pl, res, &cmd);
+                    }
+
+                    float err = dive_heading_delta(pl.heading_deg, (float)p->desired_heading_deg);
+                    res->err_sq_sum += (double)err * err;
+                    res->err_n++;
+                }
+                plant_step(&pl, res, dive_phase, p);
+            }
+        }
+    }
+}
+
+static void report(const char *name, int cycles, const struct result *r)
+{
+    printf("%-10s  %8.2f  %10.2f  %8.1f  %9.1f\n", name,
+           sqrt(r->err_sq_sum / (r->err_n ? r->err_n : 1)),
+           r->on_ms / 1000.0 / cycles,
+           (double)r->starts / cycles,
+           (double)r->reversals / cycles);
+}
+
+int main(int argc, char **argv)
+{
+    struct app_params p;
+    int cycles = 50;
+
+    app_params_defaults(&p);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            cycles = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            turn_gain = strtof(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            if (param_set_arg(&p, argv[++i]) != 0) {
+                fprintf(stderr, "heading_bench: unknown parameter '%s'\n", argv[i]);
+                return 2;
+            }
+        } else {
+            fprintf(stderr, "usage: heading_bench [-n cycles] [-g turn_gain] [-s name=value]...\n");
+            return 2;
+        }
+    }
+    if (cycles <= 0) {
+        cycles = 1;
+    }
+
+    struct result bb, pi;
+    run(false, cycles, &p, &bb);
+    run(true, cycles, &p, &pi);
+
+    printf("%d cycles, %d s per phase, turn gain %.2f deg/s per roll-s\n",
+           cycles, PHASE_MS / 1000, turn_gain);
+    printf("PI: kp=%.3f ki=%.4f period=%us deadband=%ums max_roll=%us\n\n",
+           p.heading_kp, p.heading_ki, p.heading_period_s, p.roll_deadband_ms, p.max_roll_s);
+    printf("controller  RMS[deg]  roll on[s]  starts  reversals   (per cycle)\n");
+    report("bang-bang", cycles, &bb);
+    report("PI", cycles, &pi);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Download the glider's flash sample log over WiFi (log_server.c).
+
+Appends to OUT and keeps the next byte offset in OUT.next, so running it
+again after a dropped connection fetches only what is missing:
+
+    python3 tools/log_fetch.py dive.flog
+    tools/flog_decode dive.flog > dive.csv
+
+OUT holds the compressed 256-byte blocks as stored in flash
+(include/log_codec.h); tools/flog_decode turns them into CSV. Blocks that
+were overwritten on the glider before they were fetched show up as a gap
+in the sample numbers. If the glider's log has restarted (erased, or a
+new log since OUT.next was written), or OUT has no OUT.next, the old OUT
+is renamed to OUT.1 (OUT.2, ...) and a new one is started.
+"""
+
+import argparse
+import os
+import socket
+import sys
+import time
+
+BLOCK_SIZE = 256                       # struct log_block (include/log_codec.h)
+
+
+class Conn:
+    def __init__(self, host, port, timeout):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.buf = b""
+
+    def line(self):
+        while b"\n" not in self.buf:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("connection closed")
+            self.buf += chunk
+        line, self.buf = self.buf.split(b"\n", 1)
+        return line.decode().split()
+
+    def request(self, text):
+        self.sock.sendall(text.encode() + b"\n")
+        return self.line()
+
+    def read_into(self, f, length):
+        """Copy up to length payload bytes to f; returns the count"""
+        got = 0
+        if self.buf:
+            take = self.buf[:length]
+            f.write(take)
+            self.buf = self.buf[len(take):]
+            got = len(take)
+        while got < length:
+            try:
+                chunk = self.sock.recv(min(65536, length - got))
+            except OSError:
+                break
+            if not chunk:
+                break
+            f.write(chunk)
+            got += len(chunk)
+        return got
+
+
+def set_aside(path):
+    """Rename path to the first free path.N; returns the new name"""
+    n = 1
+    while os.path.exists(f"{path}.{n}"):
+        n += 1
+    os.rename(path, f"{path}.{n}")
+    return f"{path}.{n}"
+
+
+def fetch(args):
+    next_path = args.out + ".next"
+    offset = None
+    if os.path.exists(args.out):
+        if os.path.exists(next_path):
+            with open(next_path) as f:
+                offset = int(f.read().strip() or 0)
+        else:
+            print(f"log_fetch: no {next_path}, kept the old log as {set_aside(args.out)}",
+                  file=sys.stderr)
+
+    conn = Conn(args.host, args.port, args.timeout)
+    info = conn.request("INFO")
+    if info[0] != "FLOG":
+        sys.exit(f"log_fetch: unexpected reply {info}")
+    first, end, block_size = int(info[1]), int(info[2]), int(info[3])
+    if block_size != BLOCK_SIZE:
+        sys.exit(f"log_fetch: block size {block_size}, this tool knows {BLOCK_SIZE}")
+    if offset is None:
+        offset = first
+    if offset > end:
+        print(f"log_fetch: glider log restarted (end {end} < {offset}), kept the old log as "
+              f"{set_aside(args.out)}, fetching from {first}", file=sys.stderr)
+        os.remove(next_path)
+        offset = first
+    print(f"log_fetch: glider has {first}..{end}, fetching from {offset}", file=sys.stderr)
+
+    t0 = time.monotonic()
+    total = 0
+    with open(args.out, "ab") as f:
+        while offset < end:
+            hdr = conn.request(f"GET {offset} {end - offset}")
+            if hdr[0] != "DATA":
+                sys.exit(f"log_fetch: unexpected reply {hdr}")
+            start, length = int(hdr[1]), int(hdr[2])
+            if start > offset:
+                print(f"log_fetch: {start - offset} bytes were overwritten before download",
+                      file=sys.stderr)
+                # Drop a partial block left by an earlier short transfer
+                f.truncate(f.tell() - f.tell() % BLOCK_SIZE)
+            got = conn.read_into(f, length)
+            total += got
+            offset = start + got
+            f.flush()
+            with open(next_path, "w") as nf:
+                nf.write(f"{offset}\n")
+            if got < length:
+                print(f"log_fetch: short transfer, run again to resume at {offset}",
+                      file=sys.stderr)
+                break
+            if length == 0:
+                break
+    try:
+        conn.request("QUIT")
+    except (OSError, ConnectionError, IndexError):
+        pass
+
+    dt = time.monotonic() - t0
+    rate = total / dt / 1024 if dt > 0 else 0.0
+    print(f"log_fetch: {total} bytes in {dt:.2f}s ({rate:.1f} kB/s), next offset {offset}",
+          file=sys.stderr)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("out", help="log file to create or extend")
+    ap.add_argument("--host", default="192.168.4.1")
+    ap.add_argument("--port", type=int, default=2324)
+    ap.add_argument("--timeout", type=float, default=10.0)
+    fetch(ap.parse_args())
+
+
+if __name__ == "__main__":
+    main()
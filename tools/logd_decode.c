@@ -0,0 +1,73 @@
+/* logd_decode.c - expand raw log records in a console log
+ *
+ * With log_deferred=2 the glider writes its hot-path messages ([SENS],
+ * actuator runs, heading corrections) to UART0 as "~L..." record lines
+ * instead of text. This turns them back into the text the glider would
+ * have printed, using the same dictionary (src/logd.c), and passes every
+ * other line through:
+ *
+ *   ./logd_decode openlog.txt > dive.log
+ *   ./logd_decode openlog.txt | ./replay -
+ *
+ * The "[LOGD] dict" line the glider prints first is checked against this
+ * build's dictionary; decode with the tools from the firmware's commit if
+ * it differs.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logd.h"
+
+int main(int argc, char **argv)
+{
+    char line[1024];
+    char text[512];
+    uint8_t rec[LOGD_REC_MAX];
+    unsigned decoded = 0, bad = 0;
+    FILE *f = stdin;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: logd_decode <console.log|->\n");
+        return 2;
+    }
+    if (strcmp(argv[1], "-") != 0) {
+        f = fopen(argv[1], "r");
+        if (!f) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        const char *m = strstr(line, LOGD_LINE_TAG);
+        const char *d = strstr(line, "[LOGD] dict ");
+        unsigned count, crc;
+
+        if (d && sscanf(d, "[LOGD] dict %u %x", &count, &crc) == 2 &&
+            (count != LOGD__COUNT || crc != logd_dict_crc())) {
+            fprintf(stderr, "logd_decode: log dictionary %u %08x, this build %u %08x\n",
+                    count, crc, (unsigned)LOGD__COUNT, (unsigned)logd_dict_crc());
+        }
+        if (!m) {
+            fputs(line, stdout);
+            continue;
+        }
+        size_t n = logd_line_decode(m, rec, sizeof(rec));
+        int len = n ? logd_format(rec, n, text, sizeof(text)) : -1;
+        if (len < 0) {
+            bad++;
+            fputs(line, stdout);
+            continue;
+        }
+        /* Text the glider printed on the same line before the record */
+        fwrite(line, 1, (size_t)(m - line), stdout);
+        fputs(text, stdout);
+        decoded++;
+    }
+    if (f != stdin) {
+        fclose(f);
+    }
+    fprintf(stderr, "logd_decode: %u records, %u bad\n", decoded, bad);
+    return 0;
+}
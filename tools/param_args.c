@@ -0,0 +1,13 @@
+/* param_args.c - "-s name=value" parameter overrides for host tools */
+#include <string.h>
+
+#include "param_args.h"
+
+int param_set_arg(struct app_params *p, const char *arg)
+{
+    const char *eq = strchr(arg, '=');
+    if (!eq) {
+        return -1;
+    }
+    return (app_params_set_named(p, arg, (size_t)(eq - arg), eq + 1) == 0) ? 0 : -1;
+}
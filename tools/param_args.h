@@ -0,0 +1,10 @@
+/* param_args.h - "-s name=value" parameter overrides for host tools */
+#ifndef PARAM_ARGS_H
+#define PARAM_ARGS_H
+
+#include "app_params.h"
+
+/* Apply one "name=value" override; returns 0 or -1 for an unknown name */
+int param_set_arg(struct app_params *p, const char *arg);
+
+#endif /* PARAM_ARGS_H */
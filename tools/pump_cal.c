@@ -0,0 +1,116 @@
+/* pump_cal.c - fit the pump displacement model to calibration runs
+ *
+ * Reads a console log with [PUMPCAL] lines (HWTEST pump menu: run the pump,
+ * measure the volume moved, enter "ml <measured>"), fits flow against
+ * gauge pressure per direction by least squares and prints the parameter
+ * lines to paste into the parameters menu:
+ *
+ *   pump_out_ml_s=... pump_out_loss_ml_s_bar=...
+ *   pump_in_ml_s=...  pump_in_loss_ml_s_bar=...
+ *
+ * Runs at a single pressure give the flow only (loss 0). Each point is
+ * weighted by its run time, so long runs count for more than short ones.
+ *
+ *   ./pump_cal [log]              (stdin when no file is given)
+ */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "app_params.h"
+#include "pump_model.h"
+
+/* Running sums for a weighted straight-line fit of flow against bar */
+struct fit {
+    unsigned n;
+    double w, wx, wy, wxx, wxy, wyy;
+};
+
+static void fit_add(struct fit *f, double x, double y, double w)
+{
+    f->n++;
+    f->w += w;
+    f->wx += w * x;
+    f->wy += w * y;
+    f->wxx += w * x * x;
+    f->wxy += w * x * y;
+    f->wyy += w * y * y;
+}
+
+/* flow = q0 - k * bar; false without any points */
+static bool fit_solve(const struct fit *f, double *q0, double *k, double *rms)
+{
+    if (f->n == 0 || f->w <= 0.0) {
+        return false;
+    }
+    double mx = f->wx / f->w;
+    double my = f->wy / f->w;
+    double sxx = f->wxx / f->w - mx * mx;
+    double sxy = f->wxy / f->w - mx * my;
+    double slope = 0.0;
+
+    /* Below ~0.05 bar of spread the slope is noise */
+    if (f->n >= 2 && sxx > 0.05 * 0.05) {
+        slope = sxy / sxx;
+    }
+    *q0 = my - slope * mx;
+    *k = -slope;
+
+    /* Weighted residual: E[(y - q0 - slope x)^2] */
+    double syy = f->wyy / f->w - my * my;
+    double var = syy - slope * sxy;
+    *rms = (var > 0.0) ? sqrt(var) : 0.0;
+    return true;
+}
+
+static void report(const char *name, const struct fit *f)
+{
+    double q0, k, rms;
+    if (!fit_solve(f, &q0, &k, &rms)) {
+        fprintf(stderr, "pump_cal: no %s runs\n", name);
+        return;
+    }
+    fprintf(stderr, "pump_cal: %s %u runs, residual %.3f mL/s\n", name, f->n, rms);
+    printf("pump_%s_ml_s=%.3f\n", name, q0);
+    printf("pump_%s_loss_ml_s_bar=%.3f\n", name, k);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    struct fit fit_in = {0}, fit_out = {0};
+    char line[512];
+
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-' && argv[1][1] != '\0')) {
+        fprintf(stderr, "usage: pump_cal [log]\n");
+        return 2;
+    }
+    if (argc == 2 && strcmp(argv[1], "-") != 0) {
+        in = fopen(argv[1], "r");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    while (fgets(line, sizeof(line), in)) {
+        const char *m = strstr(line, "[PUMPCAL] ");
+        int dir;
+        unsigned ms;
+        float bar, ml;
+
+        if (!m || sscanf(m, "[PUMPCAL] dir=%d ms=%u bar=%f ml=%f", &dir, &ms, &bar, &ml) != 4 ||
+            ms == 0 || ml <= 0.0f) {
+            continue;
+        }
+        double flow = (double)ml * 1000.0 / (double)ms;
+        fit_add(dir > 0 ? &fit_out : &fit_in, bar, flow, (double)ms / 1000.0);
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    report("out", &fit_out);
+    report("in", &fit_in);
+    return (fit_in.n != 0 && fit_out.n != 0) ? 0 : 1;
+}
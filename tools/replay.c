@@ -0,0 +1,650 @@
+/* replay.c - re-run a recorded dive log through the firmware control logic
+ *
+ * Reads a deploy/simulate console log ([SENS] lines) or a binary sample file
+ * and feeds every sample, with its recorded timestamp, through the same
+ * dive_ctrl code the firmware runs. The resulting actuator command sequence
+ * is printed one command per line so it can be diffed against what the
+ * glider actually did:
+ *
+ *   ./replay -r -T dive.log > recorded.txt   # commands the glider issued
+ *   ./replay -T dive.log    > replayed.txt   # commands current code issues
+ *   diff recorded.txt replayed.txt
+ *
+ * With -m the cycles follow a mission table (one step per line in the
+ * console's "add" syntax) instead of the plain parameters. The per-cycle
+ * [STATS] summary the firmware prints at surfacing is recomputed and
+ * printed on stderr, and with -P the [PROFILE] depth bins as well.
+ *
+ * Build with `make` in this directory.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_params.h"
+#include "dive_ctrl.h"
+#include "dive_stats.h"
+#include "dive_profile.h"
+#include "act_energy.h"
+#include "trim_learn.h"
+#include "pump_model.h"
+#include "mission.h"
+#include "param_args.h"
+
+/* Binary sample file: header followed by fixed little-endian records */
+#define REPLAY_MAGIC   0x4C505254u /* 'TRPL' */
+#define REPLAY_VERSION 1
+
+#define REPLAY_FLAG_CYCLE_START 0x0001u
+
+struct replay_file_hdr {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t rec_size;
+};
+
+struct replay_rec {
+    uint32_t t_ms;
+    int32_t  internal_pa;
+    int32_t  depth_mm;
+    int16_t  heading_cdeg;
+    int16_t  pitch_cdeg;
+    int16_t  roll_cdeg;
+    uint16_t flags;
+};
+
+/* Subset of the deploy state machine that sees samples */
+enum replay_phase {
+    PH_IDLE = 0,
+    PH_DESCEND,
+    PH_INFLECT,
+    PH_ASCEND,
+    PH_SURFACE,
+};
+
+static const enum dive_state phase_state[] = {
+    [PH_IDLE]    = DIVE_ST_SURFACE_TRIM,
+    [PH_DESCEND] = DIVE_ST_DESCEND,
+    [PH_INFLECT] = DIVE_ST_INFLECT,
+    [PH_ASCEND]  = DIVE_ST_ASCEND,
+    [PH_SURFACE] = DIVE_ST_SURFACE,
+};
+
+struct replay {
+    struct app_params params;      /* current cycle */
+    struct app_params base;        /* as configured */
+    struct mission mission;
+    struct mission_cursor cursor;
+    struct dive_ctrl ctrl;
+    struct dive_vz vz;
+    struct dive_inflect inf;
+    struct dive_cycle_stats stats;
+    struct dive_profile profile;
+    struct act_energy energy;
+    struct trim_learn trim;        /* starts from zero, learns as deploy does */
+    uint32_t surfacings;
+    enum replay_phase phase;
+    float pos_s[DIVE_ACT__COUNT];
+    struct pump_volume pump_vol;   /* with the pump model on */
+    bool pump_vol_set;
+    float depth_m;                 /* latest sample, for the pump model */
+    int64_t last_t_ms;
+    int64_t phase_ms;              /* when the current phase started */
+    int64_t trim_done_ms;          /* when the climb trim moves finish */
+    bool descend_started;
+
+    /* options */
+    bool recorded;
+    bool no_time;
+    bool quiet;
+    bool profile_out;
+    FILE *bin_out;
+
+    /* totals */
+    uint32_t samples;
+    uint32_t cycles;
+    uint32_t cmds[DIVE_ACT__COUNT];
+    uint32_t on_ms[DIVE_ACT__COUNT];
+};
+
+/* ---- Output ---- */
+
+static void emit(struct replay *r, int64_t t_ms, enum dive_actuator act, int dir, uint32_t dur_ms)
+{
+    r->cmds[act]++;
+    r->on_ms[act] += dur_ms;
+    if (r->quiet) {
+        return;
+    }
+    if (r->no_time) {
+        printf("%-5s %+d %ums\n", dive_actuator_name(act), dir, dur_ms);
+    } else {
+        printf("%10lld %-5s %+d %ums\n", (long long)t_ms, dive_actuator_name(act), dir, dur_ms);
+    }
+}
+
+/* Execute a controller command against the dead-reckoned actuator model */
+/* The whole run is charged to the phase it starts in */
+static void issue(struct replay *r, int64_t t_ms, const struct dive_cmd *cmd)
+{
+    act_energy_start(&r->energy, phase_state[r->phase], cmd->act, cmd->dir);
+    act_energy_charge(&r->energy, phase_state[r->phase], cmd->act, cmd->duration_ms);
+    r->pos_s[cmd->act] += (float)(cmd->dir * (int32_t)cmd->duration_ms) / 1000.0f;
+    if (cmd->act == DIVE_ACT_PUMP && r->pump_vol_set) {
+        pump_volume_track(&r->pump_vol, &r->params, (int32_t)(r->pos_s[DIVE_ACT_PUMP] * 1000.0f),
+                          pump_model_gauge_bar(r->depth_m));
+    }
+    emit(r, t_ms, cmd->act, cmd->dir, cmd->duration_ms);
+}
+
+/* Returns the run time in ms, 0 if already there */
+static uint32_t move_to(struct replay *r, int64_t t_ms, enum dive_actuator act, float target_s)
+{
+    struct dive_cmd cmd;
+    bool move;
+
+    /* Pump set-points are volumes with the model on, as in deploy_pump_to() */
+    if (act == DIVE_ACT_PUMP && pump_model_enabled(&r->params)) {
+        if (!r->pump_vol_set) {
+            pump_volume_reset(&r->pump_vol, &r->params,
+                              (int32_t)(r->pos_s[DIVE_ACT_PUMP] * 1000.0f));
+            r->pump_vol_set = true;
+        }
+        move = pump_model_move_to(&r->params, &r->pump_vol, target_s,
+                                  pump_model_gauge_bar(r->depth_m), &cmd);
+    } else {
+        move = dive_ctrl_move_to(act, target_s, r->pos_s[act], &cmd);
+    }
+    if (move) {
+        issue(r, t_ms, &cmd);
+        return cmd.duration_ms;
+    }
+    return 0;
+}
+
+/* ---- Controller replay (mirrors the deploy state machine) ---- */
+
+/* Start a yo; from_surface adds the surface trim moves first (a log cycle
+ * marker), otherwise this is a yo-yo turn at depth */
+static void cycle_start(struct replay *r, int64_t t, bool from_surface)
+{
+    const struct app_params *p = &r->params;
+
+    /* Resolve the mission step for this cycle; the table repeats, so the
+     * log decides how many cycles there are */
+    if (r->cycles > 0) {
+        mission_advance(&r->mission, &r->cursor, &r->base);
+    }
+    if (!mission_cycle_params(&r->mission, &r->cursor, &r->base, &r->params)) {
+        r->params = r->base;
+    }
+
+    r->cycles++;
+    if (from_surface) {
+        dive_stats_begin(&r->stats, ++r->surfacings, t);
+        dive_profile_begin(&r->profile, r->surfacings, p->profile_bin_m);
+        act_energy_reset(&r->energy);
+        r->phase = PH_IDLE;
+        move_to(r, t, DIVE_ACT_PITCH, (float)p->start_pitch_s);
+        move_to(r, t, DIVE_ACT_PUMP, (float)p->start_pump_s);
+    }
+    struct dive_trim trim;
+    trim_learn_setpoints(&r->trim, p, &trim);
+    r->phase = PH_DESCEND;
+    move_to(r, t, DIVE_ACT_PITCH, trim.dive_pitch_s);
+    move_to(r, t, DIVE_ACT_PUMP, trim.dive_pump_s);
+    r->descend_started = false;
+    dive_vz_reset(&r->vz);
+}
+
+static void report_cycle(struct replay *r, int64_t t_ms)
+{
+    struct dive_summary sum;
+    char line[384];
+
+    dive_stats_summarize(&r->stats, t_ms, &sum);
+    act_energy_summarize(&r->energy, &r->params, &sum);
+    dive_summary_format(&sum, line, sizeof(line));
+    fprintf(stderr, "replay: %s\n", line);
+    if (r->profile_out && r->profile.bin_m > 0.0f) {
+        struct dive_profile_bin b;
+        dive_profile_format_head(&r->profile, line, sizeof(line));
+        fprintf(stderr, "replay: profile %s\n", line);
+        for (int d = 0; d < DIVE_PROF__COUNT; d++) {
+            for (unsigned int i = 0; i < DIVE_PROFILE_BINS; i++) {
+                if (dive_profile_get(&r->profile, (enum dive_profile_dir)d, i, &b)) {
+                    dive_profile_format_bin((enum dive_profile_dir)d, &b, line, sizeof(line));
+                    fprintf(stderr, "replay: profile %s\n", line);
+                }
+            }
+        }
+    }
+    if (trim_learn_update(&r->trim, &r->stats, &r->params)) {
+        fprintf(stderr, "replay: trim learned: dive pitch %+.2fs pump %+.2fs, "
+                "climb pitch %+.2fs pump %+.2fs\n",
+                r->trim.dive_pitch_s, r->trim.dive_pump_s,
+                r->trim.climb_pitch_s, r->trim.climb_pump_s);
+    }
+}
+
+static void on_sample(struct replay *r, const struct dive_sample *s, bool cycle_marker)
+{
+    const struct app_params *p = &r->params;
+    struct dive_cmd cmd;
+
+    r->samples++;
+    r->depth_m = s->depth_m;
+
+    if (cycle_marker || r->phase == PH_IDLE) {
+        cycle_start(r, r->last_t_ms, true);
+    }
+    enum replay_phase ph = r->phase;
+
+    switch (r->phase) {
+    case PH_DESCEND:
+        /* The log has no state stamps; start the dive clock at the first sample */
+        if (!r->descend_started) {
+            dive_ctrl_begin_phase(&r->ctrl, true, s->t_ms);
+            r->phase_ms = s->t_ms;
+            r->descend_started = true;
+        }
+        if (dive_ctrl_heading(&r->ctrl, s, r->pos_s[DIVE_ACT_ROLL], p, &cmd)) {
+            issue(r, s->t_ms, &cmd);
+        }
+        dive_vz_update(&r->vz, s);
+        float predicted_m;
+        if (dive_inflect_due(&r->inf, &r->vz, s, p, &predicted_m) ||
+            dive_state_timed_out(DIVE_ST_DESCEND, r->phase_ms, s->t_ms, p)) {
+            struct dive_trim trim;
+            trim_learn_setpoints(&r->trim, p, &trim);
+            r->phase = PH_INFLECT;
+            uint32_t pitch_ms = move_to(r, s->t_ms, DIVE_ACT_PITCH, trim.climb_pitch_s);
+            uint32_t pump_ms = move_to(r, s->t_ms, DIVE_ACT_PUMP, trim.climb_pump_s);
+            dive_inflect_begin(&r->inf, &r->vz, s);
+            r->trim_done_ms = s->t_ms + (int64_t)(pitch_ms > pump_ms ? pitch_ms : pump_ms);
+            r->phase_ms = s->t_ms;
+        }
+        break;
+
+    case PH_INFLECT:
+        /* No heading control while the climb trim moves */
+        dive_vz_update(&r->vz, s);
+        dive_inflect_track(&r->inf, s);
+        if (s->t_ms >= r->trim_done_ms ||
+            dive_state_timed_out(DIVE_ST_INFLECT, r->phase_ms, s->t_ms, p)) {
+            dive_ctrl_begin_phase(&r->ctrl, false, s->t_ms);
+            r->phase_ms = s->t_ms;
+            r->phase = PH_ASCEND;
+        }
+        break;
+
+    case PH_ASCEND:
+        dive_vz_update(&r->vz, s);
+        dive_inflect_track(&r->inf, s);
+        if (dive_ctrl_heading(&r->ctrl, s, r->pos_s[DIVE_ACT_ROLL], p, &cmd)) {
+            issue(r, s->t_ms, &cmd);
+        }
+        float turn_m;
+        if (p->yoyo_min_depth_m > 0.0f &&
+            dive_inflect_turn_due(&r->inf, &r->vz, s, p, &turn_m)) {
+            dive_inflect_learn(&r->inf);
+            cycle_start(r, s->t_ms, false);
+            break;
+        }
+        if (dive_ctrl_surface_reached(s) ||
+            dive_state_timed_out(DIVE_ST_ASCEND, r->phase_ms, s->t_ms, p)) {
+            dive_inflect_learn(&r->inf);
+            r->phase = PH_SURFACE;
+            move_to(r, s->t_ms, DIVE_ACT_PITCH, (float)p->start_pitch_s);
+            move_to(r, s->t_ms, DIVE_ACT_PUMP, (float)p->start_pump_s);
+            if (dive_ctrl_roll_neutral(r->pos_s[DIVE_ACT_ROLL], p, &cmd)) {
+                issue(r, s->t_ms, &cmd);
+            }
+        }
+        break;
+
+    case PH_SURFACE:
+    case PH_IDLE:
+    default:
+        break;
+    }
+
+    /* Charge the interval up to this sample to the phase it was taken in */
+    dive_stats_sample(&r->stats, phase_state[ph], s, &r->vz, p);
+    dive_profile_sample(&r->profile, phase_state[ph], s);
+    if (r->last_t_ms > 0 && s->t_ms > r->last_t_ms) {
+        dive_stats_state_time(&r->stats, phase_state[ph], (uint32_t)(s->t_ms - r->last_t_ms));
+    }
+    if (ph != PH_SURFACE && r->phase == PH_SURFACE) {
+        report_cycle(r, s->t_ms);
+    }
+}
+
+/* ---- Recorded command extraction ---- */
+
+/* "for 1500ms" (current firmware) or "for 2s" (older logs) */
+static bool parse_duration_ms(const char *m, uint32_t *out_ms)
+{
+    const char *f = strstr(m, " for ");
+    if (!f) {
+        return false;
+    }
+    char *end = NULL;
+    unsigned long v = strtoul(f + 5, &end, 10);
+    if (end == f + 5) {
+        return false;
+    }
+    *out_ms = (strncmp(end, "ms", 2) == 0) ? (uint32_t)v : (uint32_t)v * 1000U;
+    return true;
+}
+
+static bool parse_recorded_cmd(struct replay *r, const char *line)
+{
+    static const struct {
+        const char *tag;
+        enum dive_actuator act;
+        const char *pos_word;   /* direction word logged for dir > 0 */
+    } cmds[] = {
+        { "[ROLL] ROLL run ",   DIVE_ACT_ROLL,  "PORT" },
+        { "[PITCH] PITCH run ", DIVE_ACT_PITCH, "FWD" },
+        { "[PUMP] run ",        DIVE_ACT_PUMP,  "OUT" },
+    };
+
+    for (size_t i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++) {
+        const char *m = strstr(line, cmds[i].tag);
+        uint32_t dur_ms;
+        if (!m || !parse_duration_ms(m, &dur_ms)) {
+            continue;
+        }
+        const char *word = m + strlen(cmds[i].tag);
+        int dir = (strncmp(word, cmds[i].pos_word, strlen(cmds[i].pos_word)) == 0) ? +1 : -1;
+        emit(r, r->last_t_ms, cmds[i].act, dir, dur_ms);
+        return true;
+    }
+    return false;
+}
+
+/* ---- Input: text log ---- */
+
+static bool field_f(const char *line, const char *key, float *out)
+{
+    const char *m = strstr(line, key);
+    if (!m) {
+        return false;
+    }
+    *out = strtof(m + strlen(key), NULL);
+    return true;
+}
+
+static bool parse_sens(const char *line, int64_t prev_t_ms, struct dive_sample *s)
+{
+    const char *m = strstr(line, "[SENS] ");
+    if (!m) {
+        return false;
+    }
+    memset(s, 0, sizeof(*s));
+
+    /* Logs from before the t= field: assume the nominal 1 Hz loop */
+    const char *t = strstr(m, "t=");
+    s->t_ms = t ? strtoll(t + 2, NULL, 10) : prev_t_ms + 1000;
+
+    const char *ip = strstr(m, "IntP=");
+    if (ip) {
+        s->internal_pa = (int32_t)strtol(ip + 5, NULL, 10);
+    }
+    if (!field_f(m, "ExtDepth=", &s->depth_m) && !field_f(m, "SimDepth=", &s->depth_m)) {
+        return false;
+    }
+    field_f(m, "H=", &s->heading_deg);
+    field_f(m, "R=", &s->roll_deg);
+    field_f(m, ",P=", &s->pitch_deg);  /* plain "P=" would match IntP= */
+    return true;
+}
+
+static void write_bin(struct replay *r, const struct dive_sample *s, bool cycle_marker)
+{
+    struct replay_rec rec = {
+        .t_ms = (uint32_t)s->t_ms,
+        .internal_pa = s->internal_pa,
+        .depth_mm = (int32_t)(s->depth_m * 1000.0f),
+        .heading_cdeg = (int16_t)(s->heading_deg * 100.0f),
+        .pitch_cdeg = (int16_t)(s->pitch_deg * 100.0f),
+        .roll_cdeg = (int16_t)(s->roll_deg * 100.0f),
+        .flags = cycle_marker ? REPLAY_FLAG_CYCLE_START : 0,
+    };
+    fwrite(&rec, sizeof(rec), 1, r->bin_out);
+}
+
+static void run_text(struct replay *r, FILE *in)
+{
+    char line[512];
+    bool cycle_marker = false;
+
+    while (fgets(line, sizeof(line), in)) {
+        struct dive_sample s;
+        float pitch, roll, pump;
+        const char *m;
+
+        if (strstr(line, "moving to surface position:")) {
+            cycle_marker = true;
+            continue;
+        }
+        if ((m = strstr(line, "starting positions: ")) != NULL &&
+            sscanf(m, "starting positions: pitch=%fs, roll=%fs, pump=%fs",
+                   &pitch, &roll, &pump) == 3) {
+            r->pos_s[DIVE_ACT_PITCH] = pitch;
+            r->pos_s[DIVE_ACT_ROLL] = roll;
+            r->pos_s[DIVE_ACT_PUMP] = pump;
+            continue;
+        }
+        if (r->recorded && parse_recorded_cmd(r, line)) {
+            continue;
+        }
+        if (!parse_sens(line, r->last_t_ms, &s)) {
+            continue;
+        }
+
+        if (r->bin_out) {
+            write_bin(r, &s, cycle_marker);
+        }
+        if (r->recorded) {
+            r->samples++;
+            r->cycles += cycle_marker ? 1 : 0;
+        } else {
+            on_sample(r, &s, cycle_marker);
+        }
+        r->last_t_ms = s.t_ms;
+        cycle_marker = false;
+    }
+}
+
+/* ---- Input: binary sample file ---- */
+
+static int run_bin(struct replay *r, FILE *in)
+{
+    struct replay_file_hdr hdr;
+    struct replay_rec rec;
+
+    if (fread(&hdr, sizeof(hdr), 1, in) != 1 || hdr.magic != REPLAY_MAGIC) {
+        fprintf(stderr, "replay: not a binary sample file\n");
+        return -1;
+    }
+    if (hdr.version != REPLAY_VERSION || hdr.rec_size != sizeof(rec)) {
+        fprintf(stderr, "replay: unsupported file version %u (record size %u)\n",
+                hdr.version, hdr.rec_size);
+        return -1;
+    }
+    if (r->recorded) {
+        fprintf(stderr, "replay: binary files hold samples only; -r needs a text log\n");
+        return -1;
+    }
+
+    while (fread(&rec, sizeof(rec), 1, in) == 1) {
+        struct dive_sample s = {
+            .t_ms = rec.t_ms,
+            .internal_pa = rec.internal_pa,
+            .depth_m = (float)rec.depth_mm / 1000.0f,
+            .heading_deg = (float)rec.heading_cdeg / 100.0f,
+            .pitch_deg = (float)rec.pitch_cdeg / 100.0f,
+            .roll_deg = (float)rec.roll_cdeg / 100.0f,
+        };
+        on_sample(r, &s, (rec.flags & REPLAY_FLAG_CYCLE_START) != 0);
+        r->last_t_ms = s.t_ms;
+    }
+    return 0;
+}
+
+/* Mission file: one step per line, '#' comments */
+static int load_mission(struct mission *m, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[128];
+    int lineno = 0;
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    m->count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        line[strcspn(line, "\r\n#")] = '\0';
+        if (line[strspn(line, " \t")] == '\0') {
+            continue;
+        }
+        if (m->count >= MISSION_MAX_STEPS ||
+            mission_parse_step(line, &m->steps[m->count]) != 0) {
+            fprintf(stderr, "%s:%d: bad mission step\n", path, lineno);
+            fclose(f);
+            return -1;
+        }
+        m->count++;
+    }
+    fclose(f);
+    if (m->count == 0) {
+        fprintf(stderr, "%s: no mission steps\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: replay [-r] [-T] [-q] [-P] [-s name=value]... [-m mission.txt] [-w out.bin] <log|sample.bin|->\n"
+            "  -r   print the actuator commands recorded in the log (no replay)\n"
+            "  -T   omit timestamps so recorded and replayed output diff cleanly\n"
+            "  -q   print only the summary\n"
+            "  -P   print the depth-binned profile of each cycle\n"
+            "  -s   override a parameter (defaults match app_params_defaults())\n"
+            "  -m   run cycles from a mission table file\n"
+            "  -w   also convert a text log into a binary sample file\n");
+}
+
+int main(int argc, char **argv)
+{
+    struct replay r;
+    const char *path = NULL;
+    const char *bin_path = NULL;
+
+    memset(&r, 0, sizeof(r));
+    app_params_defaults(&r.params);
+    mission_defaults(&r.mission);
+    trim_learn_reset(&r.trim);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0) {
+            r.recorded = true;
+        } else if (strcmp(argv[i], "-T") == 0) {
+            r.no_time = true;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            r.quiet = true;
+        } else if (strcmp(argv[i], "-P") == 0) {
+            r.profile_out = true;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            if (param_set_arg(&r.params, argv[++i]) != 0) {
+                fprintf(stderr, "replay: unknown parameter '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            if (load_mission(&r.mission, argv[++i]) != 0) {
+                return 2;
+            }
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            bin_path = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage();
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        usage();
+        return 2;
+    }
+    r.base = r.params;
+    mission_begin(&r.cursor);
+    dive_inflect_init(&r.inf, &r.base);
+
+    FILE *in = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+
+    if (bin_path) {
+        struct replay_file_hdr hdr = {
+            .magic = REPLAY_MAGIC,
+            .version = REPLAY_VERSION,
+            .rec_size = sizeof(struct replay_rec),
+        };
+        r.bin_out = fopen(bin_path, "wb");
+        if (!r.bin_out) {
+            perror(bin_path);
+            return 1;
+        }
+        fwrite(&hdr, sizeof(hdr), 1, r.bin_out);
+    }
+
+    /* Sniff the magic to pick the input format */
+    uint32_t magic = 0;
+    int c0 = fgetc(in);
+    if (c0 != EOF) {
+        ungetc(c0, in);
+    }
+    if (c0 == (int)(REPLAY_MAGIC & 0xFF) && in != stdin) {
+        if (fread(&magic, sizeof(magic), 1, in) != 1) {
+            magic = 0;
+        }
+        rewind(in);
+    }
+
+    int rc = 0;
+    if (magic == REPLAY_MAGIC) {
+        rc = run_bin(&r, in);
+    } else {
+        run_text(&r, in);
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (r.bin_out) {
+        fclose(r.bin_out);
+    }
+
+    fprintf(stderr, "replay: %u samples, %u cycles; commands roll=%u (%.1fs) pitch=%u (%.1fs) pump=%u (%.1fs)\n",
+            r.samples, r.cycles,
+            r.cmds[DIVE_ACT_ROLL], r.on_ms[DIVE_ACT_ROLL] / 1000.0,
+            r.cmds[DIVE_ACT_PITCH], r.on_ms[DIVE_ACT_PITCH] / 1000.0,
+            r.cmds[DIVE_ACT_PUMP], r.on_ms[DIVE_ACT_PUMP] / 1000.0);
+    if (!r.recorded && r.inf.cycles_learned > 0) {
+        fprintf(stderr, "replay: inflection lead %.1fs after %u cycles\n",
+                r.inf.lead_s, r.inf.cycles_learned);
+    }
+    return rc ? 1 : 0;
+}